@@ -0,0 +1,146 @@
+// Contention benchmark for the atomic uint128
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+/***** cren_atomic_bench.c *****
+ * Measures 128-bit counters shared between threads, with 1 to BENCH_MAX_THREADS threads incrementing them:
+ * mutex - a single counter guarded by a mutex, which is what has to be done without an atomic type
+ * fetch_add - a single atomic counter, which every thread increments with atomic_uint128_fetch_add
+ * compare_exchange - the same, but with a compare-exchange loop, like updating a (pointer, tag) pair
+ * sharded - every thread increments its own atomic counter on a separate cache line, and the total is
+ * 			 the sum of the shards, which only gets read once at the end
+ * The time is reported in nanoseconds per increment of all threads together, so perfect scaling would divide it
+ * by the number of threads. The results are written to stdout as JSON, same as cren_bench.
+ *
+ * Usage: cren_atomic_bench [increments] - every thread increments the counter the given number of times
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <integers/uint128.h>
+#include <integers/uint128_atomic.h>
+
+#define BENCH_MAX_THREADS 16
+#define BENCH_DEFAULT_INCREMENTS 200000
+
+enum bench_counter_kind {
+	BENCH_MUTEX = 0,
+	BENCH_FETCH_ADD,
+	BENCH_COMPARE_EXCHANGE,
+	BENCH_SHARDED,
+	BENCH_COUNTER_KINDS
+};
+
+static const char * const BENCH_COUNTER_NAMES[BENCH_COUNTER_KINDS] = {
+	"mutex", "fetch_add", "compare_exchange", "sharded"
+};
+
+// Every shard is on its own cache line, so that the threads don't share them
+typedef struct bench_shard {
+	_Alignas(64) atomic_uint128_t counter;
+} bench_shard;
+
+static size_t bench_increments = BENCH_DEFAULT_INCREMENTS;
+static enum bench_counter_kind bench_kind;
+
+static pthread_mutex_t bench_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint128_t bench_locked_counter;
+static atomic_uint128_t bench_counter;
+static bench_shard bench_shards[BENCH_MAX_THREADS];
+
+static uint64_t bench_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/* Increments the counter of the current kind, shard is the index of the thread */
+static void * bench_thread(void *shard) {
+	// adding 2^64 + 1 changes both halves of the counter
+	const uint128_t increment = uint128_create(1, 1);
+	atomic_uint128_t * const own = &bench_shards[(size_t)shard].counter;
+	for (size_t i = 0; i < bench_increments; i++) {
+		switch (bench_kind) {
+		case BENCH_MUTEX:
+			pthread_mutex_lock(&bench_mutex);
+			bench_locked_counter = uint128_add(bench_locked_counter, increment);
+			pthread_mutex_unlock(&bench_mutex);
+			break;
+		case BENCH_FETCH_ADD:
+			atomic_uint128_fetch_add(&bench_counter, increment);
+			break;
+		case BENCH_COMPARE_EXCHANGE: {
+			uint128_t expected = atomic_uint128_load(&bench_counter);
+			while (!atomic_uint128_compare_exchange(&bench_counter, &expected, uint128_add(expected, increment)))
+				;
+			break;
+		}
+		default:
+			atomic_uint128_fetch_add(own, increment);
+			break;
+		}
+	}
+	return NULL;
+}
+
+/* Runs the given number of threads on the counter of the current kind, returns the final value of the counter */
+static uint128_t bench_run(const size_t threads, uint64_t * const time) {
+	bench_locked_counter = uint128_value(0);
+	atomic_uint128_init(&bench_counter, uint128_value(0));
+	for (size_t i = 0; i < BENCH_MAX_THREADS; i++)
+		atomic_uint128_init(&bench_shards[i].counter, uint128_value(0));
+
+	pthread_t thread_ids[BENCH_MAX_THREADS];
+	const uint64_t start = bench_now();
+	for (size_t i = 0; i < threads; i++)
+		pthread_create(&thread_ids[i], NULL, bench_thread, (void *)i);
+	for (size_t i = 0; i < threads; i++)
+		pthread_join(thread_ids[i], NULL);
+	*time = bench_now() - start;
+
+	switch (bench_kind) {
+	case BENCH_MUTEX:
+		return bench_locked_counter;
+	case BENCH_SHARDED: {
+		uint128_t total = uint128_value(0);
+		for (size_t i = 0; i < threads; i++)
+			total = uint128_add(total, atomic_uint128_load(&bench_shards[i].counter));
+		return total;
+	}
+	default:
+		return atomic_uint128_load(&bench_counter);
+	}
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1)
+		bench_increments = strtoull(argv[1], NULL, 10);
+	if (bench_increments == 0)
+		bench_increments = BENCH_DEFAULT_INCREMENTS;
+
+	printf("{\n\t\"backend\": \"%s\",\n\t\"lock_free\": %s,\n\t\"increments\": %zu,\n\t\"results\": [",
+		   COMPILER_INT128_AVAILABLE ? "int128" : "struct",
+		   atomic_uint128_is_lock_free(&bench_counter) ? "true" : "false", bench_increments);
+
+	int first = 1;
+	for (int kind = 0; kind < BENCH_COUNTER_KINDS; kind++) {
+		bench_kind = (enum bench_counter_kind)kind;
+		for (size_t threads = 1; threads <= BENCH_MAX_THREADS; threads *= 2) {
+			uint64_t time;
+			const uint128_t total = bench_run(threads, &time);
+			const uint64_t expected = threads * bench_increments;
+			if (uint128_get_higher(total) != expected || uint128_get_lower(total) != expected) {
+				fprintf(stderr, "The %s counter has lost increments with %zu threads\n", BENCH_COUNTER_NAMES[kind], threads);
+				return 1;
+			}
+			printf("%s\n\t\t{\"function\": \"%s\", \"threads\": %zu, \"ns_per_increment\": %.3f}", first ? "" : ",",
+				   BENCH_COUNTER_NAMES[kind], threads, (double)time / (double)expected);
+			first = 0;
+		}
+	}
+
+	printf("\n\t]\n}\n");
+	return 0;
+}
@@ -0,0 +1,752 @@
+// Microbenchmarks for the cren libraries
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+/***** cren_bench.c *****
+ * Measures every public function of uint128.h and bitfuncs.h in two ways:
+ * throughput - the function is called on independent inputs, so the calls can overlap in the pipeline
+ * latency - every call depends on the result of the previous one, so the calls form a dependency chain
+ * Both are reported in nanoseconds per call. The results are written to stdout as JSON, together with the
+ * uint128 backend this was compiled with, so that runs of different backends can be compared directly.
+ *
+ * Usage: cren_bench [rounds] - every benchmark runs the given number of rounds over BENCH_INPUTS inputs
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <integers/uint128.h>
+#include <integers/uint128_modular.h>
+#include <integers/uint_wide.h>
+#include <integers/natural.h>
+#include <integers/uint128_const_division.h>
+#include <integers/uint128_map.h>
+#include <integers/uint128_sort.h>
+#include <integers/uint128_array.h>
+#include <integers/uint128_convert.h>
+#include <integers/uint128_varint.h>
+#include <integers/uint128_packing.h>
+#include <integers/uint128_column.h>
+#include <bitfuncs/bitfuncs.h>
+
+#define BENCH_INPUTS 1024
+#define BENCH_DEFAULT_ROUNDS 200
+#define BENCH_STRING_SIZE 48
+
+// Struct defining one set of benchmark inputs, every benchmark uses the elements with the same index together
+typedef struct bench_inputs {
+	const char *name;
+	int divisor_64bit; // whether all of the divisors fit into 64 bits
+	uint128_t a[BENCH_INPUTS];
+	uint128_t b[BENCH_INPUTS];
+	uint64_t s[BENCH_INPUTS];
+	unsigned shift[BENCH_INPUTS];
+	uint128_divisor_t divisor[BENCH_INPUTS]; // precomputed divisors of b
+	char decimal[BENCH_INPUTS][BENCH_STRING_SIZE]; // a formatted in decimal
+	char hex[BENCH_INPUTS][BENCH_STRING_SIZE]; // a formatted in hex with the 0x prefix
+} bench_inputs;
+
+// The results of all benchmarks are summed here so that the compiler can't throw the calls away
+volatile uint64_t bench_sink;
+// Always 0, but the compiler doesn't know that, which is used to make the inputs depend on the previous result
+volatile uint64_t bench_zero;
+
+static size_t bench_rounds = BENCH_DEFAULT_ROUNDS;
+static int bench_first_result = 1;
+
+static uint64_t bench_random_state = 0x9e3779b97f4a7c15ull;
+
+/* xorshift64*, good enough for benchmark inputs and reproducible between runs */
+static uint64_t bench_random(void) {
+	bench_random_state ^= bench_random_state >> 12;
+	bench_random_state ^= bench_random_state << 25;
+	bench_random_state ^= bench_random_state >> 27;
+	return bench_random_state * 0x2545f4914f6cdd1dull;
+}
+
+/* Random value with a random number of significant bits (from 1 to bits) */
+static uint64_t bench_random_bits(const unsigned bits) {
+	const unsigned significant = 1 + (unsigned)(bench_random() % bits);
+	return (bench_random() >> (64 - significant)) | (1ull << (significant - 1));
+}
+
+static uint64_t bench_now(void) {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+/* Folds all of the bits of the values into 64 bits, used to consume the results */
+static inline uint64_t bits_uint128(const uint128_t value) {
+	return uint128_get_lower(value) ^ uint128_get_higher(value);
+}
+
+static inline uint64_t bits_divrem(const uint128_divrem_result value) {
+	return bits_uint128(value.quotient) ^ bits_uint128(value.remainder);
+}
+
+static inline uint64_t bits_divisor(const uint128_divisor_t value) {
+	return bits_uint128(value.divisor) ^ value.reciprocal ^ value.shift;
+}
+
+static void bench_report(const char *function, const char *inputs, const uint64_t throughput_time,
+						 const uint64_t latency_time) {
+	const double calls = (double)bench_rounds * BENCH_INPUTS;
+	printf("%s\n\t\t{\"function\": \"%s\", \"inputs\": \"%s\", \"throughput_ns\": %.3f, \"latency_ns\": %.3f}",
+		   bench_first_result ? "" : ",", function, inputs, (double)throughput_time / calls,
+		   (double)latency_time / calls);
+	bench_first_result = 0;
+}
+
+/* Benchmarks the expression, which can use the variables a, b (uint128_t), s (uint64_t), shift (unsigned)
+ * and index (size_t) of the current input from current_inputs, and must produce a value of result_type, which is then converted
+ * to 64 bits by result_bits (an expression of result). In the latency run all inputs are xored with
+ * (the previous result & 0), which makes them depend on the previous result without changing them.
+ */
+#define BENCHMARK(function, input_set, result_type, expression, result_bits) do { \
+	const bench_inputs * const current_inputs = (input_set); \
+	const uint64_t zero = bench_zero; \
+	uint64_t sink = 0; \
+	uint64_t start = bench_now(); \
+	for (size_t round = 0; round < bench_rounds; round++) { \
+		for (size_t index = 0; index < BENCH_INPUTS; index++) { \
+			const uint128_t a = current_inputs->a[index], b = current_inputs->b[index]; \
+			const uint64_t s = current_inputs->s[index]; \
+			const unsigned shift = current_inputs->shift[index]; \
+			(void)a; (void)b; (void)s; (void)shift; \
+			const result_type result = (expression); \
+			sink += (result_bits); \
+		} \
+	} \
+	const uint64_t throughput_time = bench_now() - start; \
+	uint64_t chain = 0; \
+	start = bench_now(); \
+	for (size_t round = 0; round < bench_rounds; round++) { \
+		for (size_t index_ = 0; index_ < BENCH_INPUTS; index_++) { \
+			const uint64_t dependency = chain & zero; \
+			const size_t index = index_ + (size_t)dependency; \
+			const uint128_t a = uint128_xor_uint64(current_inputs->a[index], dependency); \
+			const uint128_t b = uint128_xor_uint64(current_inputs->b[index], dependency); \
+			const uint64_t s = current_inputs->s[index] ^ dependency; \
+			const unsigned shift = current_inputs->shift[index] ^ (unsigned)dependency; \
+			(void)a; (void)b; (void)s; (void)shift; \
+			const result_type result = (expression); \
+			chain = (result_bits); \
+		} \
+	} \
+	const uint64_t latency_time = bench_now() - start; \
+	bench_sink += sink + chain; \
+	bench_report((function), current_inputs->name, throughput_time, latency_time); \
+} while (0)
+
+/* Fills the strings and precomputed divisors of the input set after a and b have been generated */
+static void bench_finish_inputs(bench_inputs * const inputs) {
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		inputs->s[i] = bench_random();
+		inputs->shift[i] = (unsigned)(bench_random() % 128);
+		inputs->divisor[i] = uint128_divisor_init(inputs->b[i]);
+		uint128_to_string(inputs->a[i], inputs->decimal[i], 10);
+		inputs->hex[i][0] = '0';
+		inputs->hex[i][1] = 'x';
+		uint128_to_string(inputs->a[i], inputs->hex[i] + 2, 16);
+	}
+}
+
+// The kinds of inputs, the division ones are chosen to go through the different branches of uint128_divrem
+enum bench_input_kind {
+	BENCH_RANDOM,				// random 128-bit values with random lengths
+	BENCH_BOTH_64BIT,			// both the dividend and the divisor fit into 64 bits
+	BENCH_DIVISOR_64BIT,		// 128-bit dividend, 64-bit divisor
+	BENCH_QUOTIENT_64BIT,		// 128-bit dividend, 64-bit divisor greater than the higher bits of the dividend
+	BENCH_DIVISOR_128BIT,		// both are 128-bit values, the divisor is smaller
+	BENCH_DIVISOR_GREATER,		// the higher bits of the divisor are greater than the ones of the dividend
+	BENCH_DIVISOR_TOP_BIT,		// the divisor has its highest bit set, so the quotient is 0 or 1
+	BENCH_DIVISOR_POWER_OF_2,	// the divisor is a power of 2
+	BENCH_INPUT_KINDS
+};
+
+static const char * const BENCH_INPUT_NAMES[BENCH_INPUT_KINDS] = {
+	"random", "both_64bit", "divisor_64bit", "quotient_64bit", "divisor_128bit", "divisor_greater", "divisor_top_bit",
+	"divisor_power_of_2"
+};
+
+static void bench_generate_inputs(bench_inputs * const inputs, const enum bench_input_kind kind) {
+	inputs->name = BENCH_INPUT_NAMES[kind];
+	inputs->divisor_64bit = 1;
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		uint128_t a, b;
+		switch (kind) {
+			case BENCH_BOTH_64BIT:
+				a = uint128_value(bench_random_bits(64));
+				b = uint128_value(bench_random_bits(64));
+				break;
+			case BENCH_DIVISOR_64BIT:
+				a = uint128_create(bench_random_bits(64), bench_random());
+				b = uint128_value(bench_random_bits(64));
+				break;
+			case BENCH_QUOTIENT_64BIT: {
+				const uint64_t divisor = bench_random_bits(64) | 3; // never a power of 2
+				a = uint128_create(bench_random() % divisor, bench_random());
+				b = uint128_value(divisor);
+				break;
+			}
+			case BENCH_DIVISOR_128BIT: {
+				const uint64_t divisor_higher = bench_random_bits(63);
+				a = uint128_create(divisor_higher + bench_random() % (~divisor_higher), bench_random());
+				b = uint128_create(divisor_higher, bench_random());
+				break;
+			}
+			case BENCH_DIVISOR_GREATER: {
+				const uint64_t dividend_higher = bench_random_bits(63);
+				a = uint128_create(dividend_higher, bench_random());
+				b = uint128_create(dividend_higher + 1 + bench_random() % (~dividend_higher), bench_random());
+				break;
+			}
+			case BENCH_DIVISOR_TOP_BIT:
+				a = uint128_create(bench_random() | (1ull << 63), bench_random());
+				b = uint128_create(bench_random() | (1ull << 63), bench_random());
+				break;
+			case BENCH_DIVISOR_POWER_OF_2:
+				a = uint128_create(bench_random(), bench_random());
+				b = uint128_shift_left(uint128_value(1), (unsigned)(bench_random() % 128));
+				break;
+			default:
+				a = uint128_create(bench_random_bits(64) >> (bench_random() % 64), bench_random());
+				b = uint128_create(bench_random_bits(64) >> (bench_random() % 64), bench_random() | 1);
+				break;
+		}
+		inputs->a[i] = a;
+		inputs->b[i] = b;
+		inputs->divisor_64bit &= uint128_get_higher(b) == 0;
+	}
+	bench_finish_inputs(inputs);
+}
+
+/* Benchmarks the functions whose performance doesn't depend much on the values */
+static void bench_value_independent(const bench_inputs * const random) {
+	BENCHMARK("uint128_create", random, uint128_t, uint128_create(s, uint128_get_lower(b)), bits_uint128(result));
+	BENCHMARK("uint128_value", random, uint128_t, uint128_value(s), bits_uint128(result));
+	BENCHMARK("uint128_get_lower", random, uint64_t, uint128_get_lower(a), result);
+	BENCHMARK("uint128_get_higher", random, uint64_t, uint128_get_higher(a), result);
+	BENCHMARK("uint128_shift_left", random, uint128_t, uint128_shift_left(a, shift), bits_uint128(result));
+	BENCHMARK("uint128_shift_right", random, uint128_t, uint128_shift_right(a, shift), bits_uint128(result));
+	BENCHMARK("uint128_or", random, uint128_t, uint128_or(a, b), bits_uint128(result));
+	BENCHMARK("uint128_or_uint64", random, uint128_t, uint128_or_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint128_xor", random, uint128_t, uint128_xor(a, b), bits_uint128(result));
+	BENCHMARK("uint128_xor_uint64", random, uint128_t, uint128_xor_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint128_and", random, uint128_t, uint128_and(a, b), bits_uint128(result));
+	BENCHMARK("uint128_and_uint64", random, uint128_t, uint128_and_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint128_equ", random, int, uint128_equ(a, b), (uint64_t)result);
+	BENCHMARK("uint128_lt", random, int, uint128_lt(a, b), (uint64_t)result);
+	BENCHMARK("uint128_lte", random, int, uint128_lte(a, b), (uint64_t)result);
+	BENCHMARK("uint128_gt", random, int, uint128_gt(a, b), (uint64_t)result);
+	BENCHMARK("uint128_gte", random, int, uint128_gte(a, b), (uint64_t)result);
+	BENCHMARK("uint128_add", random, uint128_t, uint128_add(a, b), bits_uint128(result));
+	BENCHMARK("uint128_add_uint64", random, uint128_t, uint128_add_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint128_subtract", random, uint128_t, uint128_subtract(a, b), bits_uint128(result));
+	BENCHMARK("uint128_subtract_uint64", random, uint128_t, uint128_subtract_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint64_multiply", random, uint128_t, uint64_multiply(uint128_get_lower(a), s), bits_uint128(result));
+	BENCHMARK("uint128_multiply", random, uint128_t, uint128_multiply(a, b), bits_uint128(result));
+	BENCHMARK("uint128_multiply_uint64", random, uint128_t, uint128_multiply_uint64(a, s), bits_uint128(result));
+	BENCHMARK("uint128_multiply_full", random, uint128_multiply_full_result, uint128_multiply_full(a, b),
+			  bits_uint128(result.hi) ^ bits_uint128(result.lo));
+	BENCHMARK("uint128_multiply_high", random, uint128_t, uint128_multiply_high(a, b), bits_uint128(result));
+	BENCHMARK("uint128_increment", random, uint128_t, uint128_increment(a), bits_uint128(result));
+	BENCHMARK("uint128_decrement", random, uint128_t, uint128_decrement(a), bits_uint128(result));
+
+	BENCHMARK("uint8_clz", random, unsigned, uint8_clz((uint8_t)(s >> shift % 64)), result);
+	BENCHMARK("uint16_clz", random, unsigned, uint16_clz((uint16_t)(s >> shift % 64)), result);
+	BENCHMARK("uint32_clz", random, unsigned, uint32_clz((uint32_t)(s >> shift % 64)), result);
+	BENCHMARK("uint64_clz", random, unsigned, uint64_clz(s >> shift % 64), result);
+	BENCHMARK("uint32_ctz", random, unsigned, uint32_ctz((uint32_t)(s << shift % 64)), result);
+	BENCHMARK("uint64_ctz", random, unsigned, uint64_ctz(s << shift % 64), result);
+}
+
+/* Benchmarks parsing and conversion to strings */
+static void bench_strings(const bench_inputs * const random) {
+	char buffer[UINT128_STRING_SIZE];
+	BENCHMARK("uint128_parse", random, uint128_t, uint128_parse(current_inputs->decimal[index]), bits_uint128(result));
+	BENCHMARK("uint128_parse_hex", random, uint128_t, uint128_parse(current_inputs->hex[index]), bits_uint128(result));
+	uint128_t parsed;
+	BENCHMARK("uint128_parse_n", random, uint64_t,
+			  (uint64_t)uint128_parse_n(current_inputs->decimal[index], current_inputs->decimal[index] + BENCH_STRING_SIZE, 10,
+										&parsed, NULL) ^ bits_uint128(parsed), result);
+	BENCHMARK("uint128_to_string", random, const char *, uint128_to_string(a, buffer, 10), (uint64_t)result[0]);
+	BENCHMARK("uint128_to_string_hex", random, const char *, uint128_to_string(a, buffer, 16), (uint64_t)result[0]);
+	BENCHMARK("uint128_format", random, size_t, uint128_format(a, buffer, 10), (uint64_t)result);
+	BENCHMARK("uint128_format_base_36", random, size_t, uint128_format(a, buffer, 36), (uint64_t)result);
+}
+
+/* Benchmarks all the division functions on the given inputs */
+static void bench_division(const bench_inputs * const inputs) {
+	BENCHMARK("uint128_divrem", inputs, uint128_divrem_result, uint128_divrem(a, b), bits_divrem(result));
+	uint128_t quotient, remainder;
+	BENCHMARK("uint128_divrem_to", inputs, uint64_t,
+			  (uint128_divrem_to(&quotient, &remainder, a, b), bits_uint128(quotient) ^ bits_uint128(remainder)), result);
+	BENCHMARK("uint128_divide", inputs, uint128_t, uint128_divide(a, b), bits_uint128(result));
+	BENCHMARK("uint128_mod", inputs, uint128_t, uint128_mod(a, b), bits_uint128(result));
+	BENCHMARK("uint128_divisor_init", inputs, uint128_divisor_t, uint128_divisor_init(b), bits_divisor(result));
+	BENCHMARK("uint128_divrem_by", inputs, uint128_divrem_result,
+			  uint128_divrem_by(a, &current_inputs->divisor[index]), bits_divrem(result));
+	BENCHMARK("uint128_div_by", inputs, uint128_t, uint128_div_by(a, &current_inputs->divisor[index]), bits_uint128(result));
+	BENCHMARK("uint128_mod_by", inputs, uint128_t, uint128_mod_by(a, &current_inputs->divisor[index]), bits_uint128(result));
+	if (inputs->divisor_64bit) {
+		BENCHMARK("uint128_divide_uint64", inputs, uint128_t, uint128_divide_uint64(a, uint128_get_lower(b)),
+				  bits_uint128(result));
+		BENCHMARK("uint128_mod_uint64", inputs, uint64_t, uint128_mod_uint64(a, uint128_get_lower(b)), result);
+	}
+}
+
+/* Benchmarks the division by constants against the same divisors passed at runtime */
+static void bench_const_division(const bench_inputs * const random) {
+	BENCHMARK("uint128_divide_uint64_10", random, uint128_t, uint128_divide_uint64(a, 10), bits_uint128(result));
+	BENCHMARK("UINT128_DIV_BY_CONST_10", random, uint128_t, UINT128_DIV_BY_CONST(a, 10), bits_uint128(result));
+	BENCHMARK("uint128_divide_uint64_10e19", random, uint128_t, uint128_divide_uint64(a, 10000000000000000000ull),
+			  bits_uint128(result));
+	BENCHMARK("UINT128_DIV_BY_CONST_10e19", random, uint128_t, UINT128_DIV_BY_CONST(a, 10000000000000000000ull),
+			  bits_uint128(result));
+	// nanoseconds in a day
+	BENCHMARK("uint128_mod_uint64_day_ns", random, uint64_t, uint128_mod_uint64(a, 86400000000000ull), result);
+	BENCHMARK("UINT128_MOD_BY_CONST_day_ns", random, uint64_t, UINT128_MOD_BY_CONST(a, 86400000000000ull), result);
+}
+
+/* Benchmarks the exact division and divisibility tests, the dividends are multiples of the divisors */
+static void bench_exact(const bench_inputs * const random) {
+	static bench_inputs multiples;
+	static uint128_exact_divisor_t exact[BENCH_INPUTS];
+	multiples = *random;
+	multiples.name = "exact_multiples";
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		// up to 48-bit divisors with up to 7 trailing zeroes
+		const uint64_t divisor = ((random->s[i] >> 16) | 1) << (random->shift[i] % 8);
+		multiples.a[i] = uint64_multiply(uint128_get_lower(random->a[i]), divisor);
+		multiples.b[i] = uint128_value(divisor);
+		exact[i] = uint128_exact_divisor_init(multiples.b[i]);
+	}
+	bench_finish_inputs(&multiples);
+
+	BENCHMARK("uint128_divide", &multiples, uint128_t, uint128_divide(a, b), bits_uint128(result));
+	BENCHMARK("uint128_divexact", &multiples, uint128_t, uint128_divexact(a, b), bits_uint128(result));
+	BENCHMARK("uint128_divexact_uint64", &multiples, uint128_t, uint128_divexact_uint64(a, uint128_get_lower(b)),
+			  bits_uint128(result));
+	BENCHMARK("uint128_exact_divisor_init", &multiples, uint128_exact_divisor_t, uint128_exact_divisor_init(b),
+			  bits_uint128(result.inverse));
+	BENCHMARK("uint128_divexact_by", &multiples, uint128_t, uint128_divexact_by(a, &exact[index]), bits_uint128(result));
+	// every other dividend isn't a multiple
+	BENCHMARK("uint128_is_divisible_by", &multiples, int,
+			  uint128_is_divisible_by(uint128_add_uint64(a, s & 1), &exact[index]), (uint64_t)result);
+	BENCHMARK("uint128_mod_by", &multiples, uint128_t, uint128_mod_by(a, &current_inputs->divisor[index]),
+			  bits_uint128(result));
+}
+
+/* Benchmarks the hash map with BENCH_MAP_KEYS random keys, which is much larger than the caches, along with the keys
+ * of the inputs. Building the map is only timed as a whole, so its throughput and latency are the same */
+#define BENCH_MAP_KEYS (1u << 20)
+static void bench_map(const bench_inputs * const random) {
+	static uint128_t keys[BENCH_MAP_KEYS];
+	static uint64_t values[BENCH_MAP_KEYS];
+	for (size_t i = 0; i < BENCH_MAP_KEYS; i++) {
+		keys[i] = uint128_create(bench_random(), bench_random());
+		values[i] = i;
+	}
+	const double scale = (double)bench_rounds * BENCH_INPUTS / BENCH_MAP_KEYS;
+
+	uint128_map_t map;
+	uint128_map_init(&map);
+	uint64_t start = bench_now();
+	for (size_t i = 0; i < BENCH_MAP_KEYS; i++)
+		uint128_map_insert(&map, keys[i], values[i]);
+	const uint64_t insert_time = (uint64_t)((double)(bench_now() - start) * scale);
+	bench_report("uint128_map_insert_growing", "map_1m_keys", insert_time, insert_time);
+	uint128_map_free(&map);
+
+	start = bench_now();
+	uint128_map_insert_many(&map, keys, values, BENCH_MAP_KEYS);
+	const uint64_t insert_many_time = (uint64_t)((double)(bench_now() - start) * scale);
+	bench_report("uint128_map_insert_many", "map_1m_keys", insert_many_time, insert_many_time);
+
+	for (size_t i = 0; i < BENCH_INPUTS; i++)
+		uint128_map_insert(&map, random->a[i], random->s[i]);
+	BENCHMARK("uint128_map_find", random, uint64_t *, uint128_map_find(&map, a), *result);
+	BENCHMARK("uint128_map_find_missing", random, uint64_t *, uint128_map_find(&map, b), (uint64_t)(result != NULL));
+	BENCHMARK("uint128_map_insert", random, uint128_map_status, uint128_map_insert(&map, a, s), (uint64_t)result);
+	uint128_map_free(&map);
+}
+
+/* Times the statement, which processes all of the inputs at once, for all of the rounds, the time is per element */
+#define BENCHMARK_ARRAY(function, input_set, statement) do { \
+	const uint64_t start = bench_now(); \
+	for (size_t round = 0; round < bench_rounds; round++) { \
+		statement; \
+	} \
+	const uint64_t time = bench_now() - start; \
+	bench_report((function), (input_set)->name, time, time); \
+} while (0)
+
+/* Benchmarks the array functions for both layouts, along with the loop calling uint128_add for every element */
+static void bench_array(const bench_inputs * const random) {
+	static uint128_t result[BENCH_INPUTS];
+	static uint64_t a_higher[BENCH_INPUTS], a_lower[BENCH_INPUTS], b_higher[BENCH_INPUTS], b_lower[BENCH_INPUTS];
+	static uint64_t result_higher[BENCH_INPUTS], result_lower[BENCH_INPUTS];
+	static int8_t comparisons[BENCH_INPUTS];
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		a_higher[i] = uint128_get_higher(random->a[i]);
+		a_lower[i] = uint128_get_lower(random->a[i]);
+		b_higher[i] = uint128_get_higher(random->b[i]);
+		b_lower[i] = uint128_get_lower(random->b[i]);
+	}
+	const uint128_soa_t a = {a_higher, a_lower}, b = {b_higher, b_lower}, soa_result = {result_higher, result_lower};
+	uint64_t sink = 0;
+
+	BENCHMARK_ARRAY("uint128_add_loop", random, {
+		for (size_t i = 0; i < BENCH_INPUTS; i++)
+			result[i] = uint128_add(random->a[i], random->b[i]);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	BENCHMARK_ARRAY("uint128_add_array", random, {
+		uint128_add_array(result, random->a, random->b, BENCH_INPUTS);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	BENCHMARK_ARRAY("uint128_sub_array", random, {
+		uint128_sub_array(result, random->a, random->b, BENCH_INPUTS);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	BENCHMARK_ARRAY("uint128_mul_uint64_array", random, {
+		uint128_mul_uint64_array(result, random->a, random->s, BENCH_INPUTS);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	BENCHMARK_ARRAY("uint128_cmp_array", random, {
+		uint128_cmp_array(comparisons, random->a, random->b, BENCH_INPUTS);
+		sink += (uint64_t)comparisons[round % BENCH_INPUTS];
+	});
+	BENCHMARK_ARRAY("uint128_sum", random, sink += uint128_get_lower(uint128_sum(random->a, BENCH_INPUTS)));
+	BENCHMARK_ARRAY("uint128_add_array_soa", random, {
+		uint128_add_array_soa(soa_result, a, b, BENCH_INPUTS);
+		sink += result_lower[round % BENCH_INPUTS];
+	});
+	BENCHMARK_ARRAY("uint128_sub_array_soa", random, {
+		uint128_sub_array_soa(soa_result, a, b, BENCH_INPUTS);
+		sink += result_lower[round % BENCH_INPUTS];
+	});
+	BENCHMARK_ARRAY("uint128_mul_uint64_array_soa", random, {
+		uint128_mul_uint64_array_soa(soa_result, a, random->s, BENCH_INPUTS);
+		sink += result_lower[round % BENCH_INPUTS];
+	});
+	BENCHMARK_ARRAY("uint128_cmp_array_soa", random, {
+		uint128_cmp_array_soa(comparisons, a, b, BENCH_INPUTS);
+		sink += (uint64_t)comparisons[round % BENCH_INPUTS];
+	});
+	BENCHMARK_ARRAY("uint128_sum_soa", random, sink += uint128_get_lower(uint128_sum_soa(a, BENCH_INPUTS)));
+
+	// decoding a column of big-endian values, one at a time and with the vectorized byte swap
+	static unsigned char big_endian[BENCH_INPUTS * 16];
+	uint128_store_be_array(big_endian, random->a, BENCH_INPUTS);
+	BENCHMARK_ARRAY("uint128_load_be_loop", random, {
+		for (size_t i = 0; i < BENCH_INPUTS; i++)
+			result[i] = uint128_load_be(big_endian + 16 * i);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	BENCHMARK_ARRAY("uint128_load_be_array", random, {
+		uint128_load_be_array(result, big_endian, BENCH_INPUTS);
+		sink += uint128_get_lower(result[round % BENCH_INPUTS]);
+	});
+	bench_sink += sink;
+}
+
+/* Benchmarks formatting all of the inputs into a single comma-separated string, against the loop formatting every
+ * one of them into a separate buffer and copying it into the string */
+static void bench_format_array(const bench_inputs * const random) {
+	static char string[BENCH_INPUTS * (UINT128_STRING_SIZE + 1)];
+	uint64_t sink = 0;
+	BENCHMARK_ARRAY("uint128_format_loop", random, {
+		char buffer[UINT128_STRING_SIZE];
+		char *position = string;
+		for (size_t i = 0; i < BENCH_INPUTS; i++) {
+			const size_t length = uint128_format(random->a[i], buffer, 10);
+			memcpy(position, buffer, length);
+			position += length;
+			*position++ = ',';
+		}
+		sink += (uint64_t)(position - string);
+	});
+	BENCHMARK_ARRAY("uint128_format_array", random,
+					sink += uint128_format_array(random->a, BENCH_INPUTS, 10, ",", string, sizeof(string)));
+	BENCHMARK_ARRAY("uint128_format_array_hex", random,
+					sink += uint128_format_array(random->a, BENCH_INPUTS, 16, ",", string, sizeof(string)));
+	BENCHMARK_ARRAY("uint128_format_array_size", random,
+					sink += uint128_format_array_size(random->a, BENCH_INPUTS, 10, ","));
+	bench_sink += sink;
+}
+
+/* Benchmarks encoding and decoding arrays of values in both varint encodings, the values are mostly small: the inputs
+ * shifted right by random amounts, so that they take from 1 to 16 bytes */
+static void bench_varint(const bench_inputs * const random) {
+	static uint128_t values[BENCH_INPUTS], decoded[BENCH_INPUTS];
+	static unsigned char leb128[BENCH_INPUTS * UINT128_LEB128_MAX_SIZE];
+	static unsigned char prefix[BENCH_INPUTS * UINT128_PREFIX_VARINT_MAX_SIZE];
+	for (size_t i = 0; i < BENCH_INPUTS; i++)
+		values[i] = uint128_shift_right(random->a[i], random->shift[i]);
+	const size_t leb128_size = uint128_leb128_encode_array(values, BENCH_INPUTS, leb128);
+	const size_t prefix_size = uint128_prefix_varint_encode_array(values, BENCH_INPUTS, prefix);
+	uint64_t sink = 0;
+	BENCHMARK_ARRAY("uint128_leb128_encode_array", random,
+					sink += uint128_leb128_encode_array(values, BENCH_INPUTS, leb128));
+	BENCHMARK_ARRAY("uint128_leb128_decode_array", random,
+					sink += uint128_leb128_decode_array(leb128, leb128_size, decoded, BENCH_INPUTS));
+	BENCHMARK_ARRAY("uint128_prefix_varint_encode_array", random,
+					sink += uint128_prefix_varint_encode_array(values, BENCH_INPUTS, prefix));
+	BENCHMARK_ARRAY("uint128_prefix_varint_decode_array", random,
+					sink += uint128_prefix_varint_decode_array(prefix, prefix_size, decoded, BENCH_INPUTS));
+	bench_sink += sink;
+}
+
+/* Benchmarks the bit packing of a sorted column, with random gaps of up to 20 bits between the values */
+static void bench_packing(const bench_inputs * const random) {
+	static uint128_t values[BENCH_INPUTS], unpacked[BENCH_INPUTS];
+	static unsigned char packed[BENCH_INPUTS / UINT128_PACKING_BLOCK_VALUES * UINT128_PACKING_MAX_BLOCK_SIZE];
+	uint128_t value = random->a[0];
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		value = uint128_add(value, uint128_value(uint128_get_lower(random->b[i]) >> 44));
+		values[i] = value;
+	}
+	const size_t size = uint128_pack_array(values, BENCH_INPUTS, packed);
+	uint64_t sink = 0;
+	BENCHMARK_ARRAY("uint128_pack_array", random, sink += uint128_pack_array(values, BENCH_INPUTS, packed));
+	BENCHMARK_ARRAY("uint128_unpack_array", random,
+					sink += uint128_unpack_array(packed, size, unpacked, BENCH_INPUTS));
+	bench_sink += sink;
+}
+
+static int bench_compare(const void *a, const void *b) {
+	const uint128_t x = *(const uint128_t *)a, y = *(const uint128_t *)b;
+	return uint128_lt(x, y) ? -1 : uint128_lt(y, x);
+}
+
+/* Benchmarks sorting BENCH_SORT_KEYS random keys, and the same number of keys below 2^80 (so that the LSD sort
+ * skips some of the digits), against qsort. The sorts are timed as a whole, like building the map */
+#define BENCH_SORT_KEYS (1u << 21)
+#define BENCH_SORT_THREADS 4
+static void bench_sort(void) {
+	static uint128_t keys[BENCH_SORT_KEYS], sorted[BENCH_SORT_KEYS];
+	const double scale = (double)bench_rounds * BENCH_INPUTS / BENCH_SORT_KEYS;
+	static const char * const inputs[2] = {"sort_2m_random", "sort_2m_80_bits"};
+	for (int sparse = 0; sparse < 2; sparse++) {
+		for (size_t i = 0; i < BENCH_SORT_KEYS; i++)
+			keys[i] = uint128_create(sparse ? bench_random() & 0xffff : bench_random(), bench_random());
+		for (int sort = 0; sort < 4; sort++) {
+			static const char * const functions[4] = {
+				"qsort", "uint128_sort", "uint128_sort_threads", "uint128_sort_in_place"
+			};
+			memcpy(sorted, keys, sizeof(keys));
+			const uint64_t start = bench_now();
+			if (sort == 0)
+				qsort(sorted, BENCH_SORT_KEYS, sizeof(uint128_t), bench_compare);
+			else if (sort == 3)
+				uint128_sort_in_place(sorted, BENCH_SORT_KEYS);
+			else
+				uint128_sort(sorted, BENCH_SORT_KEYS, sort == 1 ? 1 : BENCH_SORT_THREADS);
+			const uint64_t time = (uint64_t)((double)(bench_now() - start) * scale);
+			bench_report(functions[sort], inputs[sparse], time, time);
+		}
+	}
+}
+
+/* Benchmarks the conversion of a text with a decimal number per line into binary, against finding the lines using
+ * memchr and parsing every one of them using uint128_parse_n. Reported per line */
+#define BENCH_CONVERT_LINES (1u << 20)
+static void bench_convert(void) {
+	static char text[BENCH_CONVERT_LINES * (UINT128_STRING_SIZE / 3)];
+	static unsigned char output[BENCH_CONVERT_LINES * UINT128_CONVERT_VALUE_SIZE];
+	size_t length = 0;
+	for (size_t i = 0; i < BENCH_CONVERT_LINES; i++) {
+		length += uint128_format(uint128_create(bench_random(), bench_random()), text + length, 10);
+		text[length++] = '\n';
+	}
+	const double scale = (double)bench_rounds * BENCH_INPUTS / BENCH_CONVERT_LINES;
+	for (int convert = 0; convert < 3; convert++) {
+		static const char * const functions[3] = {"uint128_parse_n_lines", "uint128_convert", "uint128_convert_threads"};
+		const uint64_t start = bench_now();
+		if (convert == 0) {
+			uint128_t * const values = (uint128_t *)(void *)output;
+			size_t line = 0;
+			for (const char *begin = text, *end; begin < text + length; begin = end + 1, line++) {
+				end = memchr(begin, '\n', (size_t)(text + length - begin));
+				uint128_parse_n(begin, end, 10, &values[line], NULL);
+			}
+		} else {
+			uint128_convert(text, length, 10, output, convert == 1 ? 1 : BENCH_SORT_THREADS);
+		}
+		const uint64_t time = (uint64_t)((double)(bench_now() - start) * scale);
+		bench_report(functions[convert], "convert_1m_decimal", time, time);
+	}
+}
+
+/* Benchmarks a range query over a sorted column of BENCH_COLUMN_VALUES values with 1000 of them in the range,
+ * reading the whole file and scanning it against opening it as a column file and using its block statistics.
+ * The files are in the page cache, so this only shows the cost of copying and scanning the values */
+#define BENCH_COLUMN_VALUES (1u << 20)
+#define BENCH_COLUMN_PATH "cren_bench_column.bin"
+static void bench_column(void) {
+	static uint128_t values[BENCH_COLUMN_VALUES];
+	for (size_t i = 0; i < BENCH_COLUMN_VALUES; i++)
+		values[i] = uint128_create(i >> 16, i << 48 | (bench_random() >> 16));
+	const uint128_t lo = values[BENCH_COLUMN_VALUES / 3], hi = values[BENCH_COLUMN_VALUES / 3 + 1000];
+	if (uint128_column_write(BENCH_COLUMN_PATH, values, BENCH_COLUMN_VALUES, 0) != UINT128_COLUMN_OK)
+		return;
+	const double scale = (double)bench_rounds * BENCH_INPUTS / BENCH_COLUMN_VALUES;
+	for (int query = 0; query < 2; query++) {
+		static const char * const functions[2] = {"fread_scan", "uint128_column_range"};
+		size_t found = 0;
+		const uint64_t start = bench_now();
+		if (query == 0) {
+			// the header and the statistics of the blocks take 2 pages before the values
+			static unsigned char bytes[BENCH_COLUMN_VALUES * 16 + 2 * UINT128_COLUMN_DATA_ALIGNMENT];
+			FILE * const file = fopen(BENCH_COLUMN_PATH, "rb");
+			if (file == NULL)
+				break;
+			const size_t size = fread(bytes, 1, sizeof(bytes), file);
+			fclose(file);
+			for (size_t offset = size - BENCH_COLUMN_VALUES * 16; offset < size; offset += 16) {
+				const uint128_t value = uint128_load_le(bytes + offset);
+				found += !uint128_lt(value, lo) && uint128_lt(value, hi);
+			}
+		} else {
+			uint128_column_t column;
+			if (uint128_column_open(BENCH_COLUMN_PATH, &column) != UINT128_COLUMN_OK)
+				break;
+			found = uint128_column_range(&column, lo, hi, NULL, 0);
+			uint128_column_close(&column);
+		}
+		const uint64_t time = (uint64_t)((double)(bench_now() - start) * scale);
+		bench_sink += found;
+		bench_report(functions[query], "column_1m_sorted", time, time);
+	}
+	remove(BENCH_COLUMN_PATH);
+}
+
+/* Benchmarks the 256-bit and 512-bit integers, the divisors are about half as wide as the dividends */
+static void bench_wide(const bench_inputs * const random) {
+	static uint256_t a256[BENCH_INPUTS], b256[BENCH_INPUTS];
+	static uint512_t a512[BENCH_INPUTS], b512[BENCH_INPUTS];
+	static char decimal256[BENCH_INPUTS][UINT256_STRING_SIZE], decimal512[BENCH_INPUTS][UINT512_STRING_SIZE];
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		for (size_t limb = 0; limb < 8; limb++) {
+			if (limb < 4) {
+				a256[i].limbs[limb] = bench_random();
+				b256[i].limbs[limb] = limb < 2 ? bench_random() : 0;
+			}
+			a512[i].limbs[limb] = bench_random();
+			b512[i].limbs[limb] = limb < 4 ? bench_random() : 0;
+		}
+		uint256_to_string(a256[i], decimal256[i], 10);
+		uint512_to_string(a512[i], decimal512[i], 10);
+	}
+
+	char buffer[UINT512_STRING_SIZE];
+	BENCHMARK("uint256_add", random, uint256_t, uint256_add(a256[index], b256[index]), result.limbs[0]);
+	BENCHMARK("uint256_multiply", random, uint256_t, uint256_multiply(a256[index], b256[index]), result.limbs[3]);
+	BENCHMARK("uint256_divrem", random, uint256_divrem_result, uint256_divrem(a256[index], b256[index]),
+			  result.quotient.limbs[0] ^ result.remainder.limbs[0]);
+	BENCHMARK("uint256_parse", random, uint256_t, uint256_parse(decimal256[index]), result.limbs[0]);
+	BENCHMARK("uint256_format", random, size_t, uint256_format(a256[index], buffer, 10), (uint64_t)result);
+	BENCHMARK("uint512_add", random, uint512_t, uint512_add(a512[index], b512[index]), result.limbs[0]);
+	BENCHMARK("uint512_multiply", random, uint512_t, uint512_multiply(a512[index], b512[index]), result.limbs[7]);
+	BENCHMARK("uint512_divrem", random, uint512_divrem_result, uint512_divrem(a512[index], b512[index]),
+			  result.quotient.limbs[0] ^ result.remainder.limbs[0]);
+	BENCHMARK("uint512_parse", random, uint512_t, uint512_parse(decimal512[index]), result.limbs[0]);
+	BENCHMARK("uint512_format", random, size_t, uint512_format(a512[index], buffer, 10), (uint64_t)result);
+}
+
+/* Benchmarks the natural number functions, the operands of every input are windows of shared limb pools
+ * starting at its index */
+static void bench_natural(const bench_inputs * const random) {
+	enum { pool_size = BENCH_INPUTS + 64 };
+	static uint64_t pool[pool_size], other[pool_size], r[128], q[64], scratch[256];
+	static uint128_divisor_t limb_divisor[BENCH_INPUTS];
+	for (size_t i = 0; i < pool_size; i++) {
+		pool[i] = bench_random();
+		// every window of the other pool can be a divisor, since none of its limbs are 0
+		other[i] = bench_random() | 1;
+	}
+	for (size_t i = 0; i < BENCH_INPUTS; i++)
+		limb_divisor[i] = uint128_divisor_init(uint128_value(random->s[i] | 1));
+
+	BENCHMARK("natural_add_n_16", random, uint64_t, natural_add_n(r, pool + index, other + index, 16), result ^ r[15]);
+	BENCHMARK("natural_addmul_1_16", random, uint64_t, natural_addmul_1(r, pool + index, 16, s), result ^ r[15]);
+	BENCHMARK("natural_mul_basecase_16", random, uint64_t, natural_mul_basecase(r, pool + index, 16, other + index, 16),
+			  result);
+	BENCHMARK("natural_mul_basecase_64", random, uint64_t, natural_mul_basecase(r, pool + index, 64, other + index, 64),
+			  result);
+	BENCHMARK("natural_mul_64", random, uint64_t, natural_mul(r, pool + index, 64, other + index, 64, scratch), result);
+	BENCHMARK("natural_divrem_1_16", random, uint64_t, natural_divrem_1(q, pool + index, 16, &limb_divisor[index]),
+			  result ^ q[0]);
+	BENCHMARK("natural_divrem_32_16", random, uint64_t,
+			  natural_divrem(q, r, pool + index, 32, other + index, 16, scratch), result ^ q[0] ^ r[0]);
+}
+
+/* Benchmarks the modular arithmetic modulo m, on the random inputs reduced by it */
+static void bench_modular(const bench_inputs * const random, const char *name, const uint128_t m) {
+	static bench_inputs reduced;
+	const uint128_modulus_t modulus = uint128_modulus_init(m);
+	reduced = *random;
+	reduced.name = name;
+	for (size_t i = 0; i < BENCH_INPUTS; i++) {
+		reduced.a[i] = uint128_reduce(random->a[i], &modulus);
+		reduced.b[i] = uint128_reduce(random->b[i], &modulus);
+	}
+
+	BENCHMARK("uint128_reduce", random, uint128_t, uint128_reduce(a, &modulus), bits_uint128(result));
+	BENCHMARK("uint128_addmod", &reduced, uint128_t, uint128_addmod(a, b, &modulus), bits_uint128(result));
+	BENCHMARK("uint128_submod", &reduced, uint128_t, uint128_submod(a, b, &modulus), bits_uint128(result));
+	BENCHMARK("uint128_mulmod", &reduced, uint128_t, uint128_mulmod(a, b, &modulus), bits_uint128(result));
+	BENCHMARK("uint128_powmod", &reduced, uint128_t, uint128_powmod(a, uint128_value(s), &modulus), bits_uint128(result));
+	if (uint128_get_lower(m) & 1) {
+		BENCHMARK("uint128_montgomery_multiply", &reduced, uint128_t, uint128_montgomery_multiply(a, b, &modulus),
+				  bits_uint128(result));
+	}
+}
+
+int main(int argc, char **argv) {
+	if (argc > 1)
+		bench_rounds = strtoull(argv[1], NULL, 10);
+	if (bench_rounds == 0)
+		bench_rounds = BENCH_DEFAULT_ROUNDS;
+
+	static bench_inputs inputs[BENCH_INPUT_KINDS];
+	for (int kind = 0; kind < BENCH_INPUT_KINDS; kind++)
+		bench_generate_inputs(&inputs[kind], (enum bench_input_kind)kind);
+
+	printf("{\n\t\"backend\": \"%s\",\n\t\"inline\": %s,\n\t\"rounds\": %zu,\n\t\"inputs\": %d,\n\t\"results\": [",
+		   COMPILER_INT128_AVAILABLE ? "int128" : "struct",
+#ifdef CREN_INTEGERS_INLINE
+		   "true",
+#else
+		   "false",
+#endif
+		   bench_rounds, BENCH_INPUTS);
+
+	bench_value_independent(&inputs[BENCH_RANDOM]);
+	bench_strings(&inputs[BENCH_RANDOM]);
+	for (int kind = 0; kind < BENCH_INPUT_KINDS; kind++)
+		bench_division(&inputs[kind]);
+	bench_const_division(&inputs[BENCH_RANDOM]);
+	bench_exact(&inputs[BENCH_RANDOM]);
+	bench_modular(&inputs[BENCH_RANDOM], "modulus_prime_128bit", uint128_create(0xffffffffffffffffull, 0xffffffffffffff61ull));
+	bench_modular(&inputs[BENCH_RANDOM], "modulus_even_128bit", uint128_create(0xfedcba9876543210ull, 0x0123456789abcdeeull));
+	bench_modular(&inputs[BENCH_RANDOM], "modulus_prime_64bit", uint128_value(0xffffffffffffffc5ull));
+	BENCHMARK("uint128_is_prime", &inputs[BENCH_RANDOM], int, uint128_is_prime(uint128_or_uint64(a, 1)), (uint64_t)result);
+	bench_wide(&inputs[BENCH_RANDOM]);
+	bench_natural(&inputs[BENCH_RANDOM]);
+	bench_array(&inputs[BENCH_RANDOM]);
+	bench_format_array(&inputs[BENCH_RANDOM]);
+	bench_varint(&inputs[BENCH_RANDOM]);
+	bench_packing(&inputs[BENCH_RANDOM]);
+	bench_map(&inputs[BENCH_RANDOM]);
+	bench_sort();
+	bench_convert();
+	bench_column();
+
+	printf("\n\t]\n}\n");
+	return 0;
+}
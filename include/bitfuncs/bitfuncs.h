@@ -27,4 +27,14 @@ unsigned uint32_clz(uint32_t x);
  */
 unsigned uint64_clz(uint64_t x);
 
+/**
+ * Count trailing zeros in a 32-bit unsigned int
+ */
+unsigned uint32_ctz(uint32_t x);
+
+/**
+ * Count trailing zeros in a 64-bit unsigned int
+ */
+unsigned uint64_ctz(uint64_t x);
+
 #endif //CREN_BITFUNCS_H
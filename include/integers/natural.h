@@ -0,0 +1,88 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_NATURAL_H
+#define CREN_INTEGERS_NATURAL_H
+
+/***** natural.h *****
+ * This header defines the arbitrary-precision natural number layer, which works on arrays of 64-bit limbs stored
+ * starting from the least significant one (same as the limbs of uint256_t and uint512_t), in the style of GMP's mpn
+ * functions. Nothing here allocates memory: all of the results and the scratch space are buffers owned by the caller,
+ * so they can come from the stack, an arena or anywhere else. The functions which need scratch space have
+ * a matching *_scratch_size function, which returns the number of limbs needed.
+ * Division uses the same 2-by-1 and 3-by-2 reciprocal kernels as the 128-bit division, and the heavy functions are
+ * dispatched at runtime the same way too.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "integers/uint128.h"
+
+// Operands of at least this many limbs are multiplied using Karatsuba's algorithm instead of the schoolbook one
+#define NATURAL_KARATSUBA_THRESHOLD 32
+
+/// Addition and subtraction
+// The result may be the same buffer as one of the operands in all of these
+
+/* r = a + b, where all of them are of length n, returns the carry */
+uint64_t natural_add_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b, const size_t n);
+
+/* r = a - b, where all of them are of length n, returns the borrow */
+uint64_t natural_sub_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b, const size_t n);
+
+/* r = a + b, where r and a are of length n, returns the carry */
+uint64_t natural_add_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b);
+
+/* r = a - b, where r and a are of length n, returns the borrow */
+uint64_t natural_sub_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b);
+
+/// Multiplication
+
+/* r = a * b, where r and a are of length n, returns the highest limb of the product. r may be the same as a */
+uint64_t natural_mul_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b);
+
+/* r += a * b, where r and a are of length n, returns the carry limb */
+uint64_t natural_addmul_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b);
+
+/* r -= a * b, where r and a are of length n, returns the borrow limb */
+uint64_t natural_submul_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b);
+
+/* Schoolbook multiplication r = a * b, where an >= bn >= 1 and r is of length an + bn. r mustn't overlap with a or b.
+ * Returns the highest limb of the product */
+uint64_t natural_mul_basecase(uint64_t * const r, const uint64_t * const a, const size_t an,
+							  const uint64_t * const b, const size_t bn);
+
+/* Number of scratch limbs needed by natural_mul for operands of length an and bn */
+size_t natural_mul_scratch_size(const size_t an, const size_t bn);
+
+/* r = a * b, same as natural_mul_basecase, but uses Karatsuba's algorithm once b is at least
+ * NATURAL_KARATSUBA_THRESHOLD limbs long. scratch must fit natural_mul_scratch_size(an, bn) limbs */
+uint64_t natural_mul(uint64_t * const r, const uint64_t * const a, const size_t an, const uint64_t * const b,
+					 const size_t bn, uint64_t * const scratch);
+
+/// Division
+
+/* q = a / divisor, where q and a are of length n, returns the remainder. The divisor must have been precomputed
+ * by uint128_divisor_init from a value which fits into 64 bits, so that dividing a whole array by it takes
+ * a single multiplication by the reciprocal per limb. q may be the same as a */
+uint64_t natural_divrem_1(uint64_t * const q, const uint64_t * const a, const size_t n,
+						  const uint128_divisor_t * const divisor);
+
+/* Number of scratch limbs needed by natural_divrem for operands of length an and bn */
+size_t natural_divrem_scratch_size(const size_t an, const size_t bn);
+
+/* Schoolbook division of a by b, where an >= bn >= 1 and the highest limb of b isn't 0. The quotient of length
+ * an - bn + 1 is written to q, and the remainder of length bn to r, neither of which may overlap with anything else.
+ * scratch must fit natural_divrem_scratch_size(an, bn) limbs. Returns the highest limb of the quotient */
+uint64_t natural_divrem(uint64_t * const q, uint64_t * const r, const uint64_t * const a, const size_t an,
+						const uint64_t * const b, const size_t bn, uint64_t * const scratch);
+
+/// Comparison
+
+/* Compares a and b of length n, returns -1, 0 or 1 if a is less, equal or greater than b */
+int natural_cmp(const uint64_t * const a, const uint64_t * const b, const size_t n);
+
+/* Returns the length of a without its leading zero limbs */
+size_t natural_normalized_length(const uint64_t * const a, const size_t n);
+
+#endif //CREN_INTEGERS_NATURAL_H
@@ -11,12 +11,14 @@
  *			the function in question for "to do"s before using it
  **/
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Determine endianness in order to correctly make the struct with the same order as actual integers
 #define CREN_INTS_LITTLE_ENDIAN 0
 #define CREN_INTS_BIG_ENDIAN 1
 #if defined(__BYTE_ORDER) && __BYTE_ORDER == __BIG_ENDIAN || \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__ || \
     defined(__BIG_ENDIAN__) || \
     defined(__ARMEB__) || \
     defined(__THUMBEB__) || \
@@ -24,6 +26,7 @@
     defined(_MIBSEB) || defined(__MIBSEB) || defined(__MIBSEB__)
 #define ENDIANNESS CREN_INTS_BIG_ENDIAN
 #elif defined(__BYTE_ORDER) && __BYTE_ORDER == __LITTLE_ENDIAN || \
+    defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ || \
     defined(__LITTLE_ENDIAN__) || \
     defined(__ARMEL__) || \
     defined(__THUMBEL__) || \
@@ -35,15 +38,21 @@
 #endif
 
 
-#if !defined(__SIZEOF_INT128__)
+// Can be defined to 0 before including this header (or on the command line) to use the struct implementation
+// even if the compiler supports 128-bit integers
+#ifndef COMPILER_INT128_AVAILABLE
+#if defined(__SIZEOF_INT128__)
 #define COMPILER_INT128_AVAILABLE 1
 #else
 #define COMPILER_INT128_AVAILABLE 0
 #endif
+#endif
 
 #define SIZEOF_INT128 16
 // Maximum needed decimal characters to represent a 128-bit integer
 #define INT128_DECIMAL_SIZE 39
+// Buffer size which fits a string-representation of any uint128 in any base, including the terminating zero
+#define UINT128_STRING_SIZE (SIZEOF_INT128 * 8 + 1)
 
 /* Struct defining a 128-bit unsigned integer
  * Basically simply represents two 64-bit uints, the higher and lower parts */
@@ -67,13 +76,22 @@ typedef unsigned __int128 uint128_t;
 typedef i_uint128_t uint128_t;
 #endif
 
+// The trivial operations (creation, conversion, bitwise operations, comparison, addition, subtraction,
+// multiplication, increment and decrement) can be compiled as static inline functions defined in this header
+// by defining CREN_INTEGERS_INLINE, otherwise they are normal functions defined in uint128.c
+#ifdef CREN_INTEGERS_INLINE
+#define CREN_INTS_PRIMITIVE static inline
+#else
+#define CREN_INTS_PRIMITIVE
+#endif
+
 /// Creation and parsing functions
 
 /* Creates a 128-bit uint from two 64-bit uints */
-uint128_t uint128_create(const uint64_t hi, const uint64_t lo);
+CREN_INTS_PRIMITIVE uint128_t uint128_create(const uint64_t hi, const uint64_t lo);
 
 /* Creates a 128-bit uint from one 64-bit uint*/
-uint128_t uint128_value(const uint64_t a);
+CREN_INTS_PRIMITIVE uint128_t uint128_value(const uint64_t a);
 
 /* Parses a 128-bit uint from a string
  * Supports formats:
@@ -88,86 +106,148 @@ uint128_t uint128_value(const uint64_t a);
  */
 uint128_t uint128_parse(const char *string);
 
+// Status of parsing a 128-bit uint using uint128_parse_n
+typedef enum uint128_parse_status {
+	UINT128_PARSE_OK = 0,		// the value has been parsed
+	UINT128_PARSE_EMPTY,		// there were no characters to parse
+	UINT128_PARSE_INVALID_DIGIT, // the first character isn't a digit in the base
+	UINT128_PARSE_OVERFLOW,		// the value is greater than the maximum value of a 128-bit uint
+	UINT128_PARSE_INVALID_BASE	// the base is neither 0 nor one of 2 to 36
+} uint128_parse_status;
+
+/* Parses a 128-bit uint from the characters in [begin, end), which don't need to be zero-terminated
+ * base_or_auto - either a base from 2 to 36 (digits above 9 are letters in any case), or 0 to determine
+ * 				  the base from the prefix the same way uint128_parse does
+ * out - where to store the value, only modified if the status is UINT128_PARSE_OK
+ * stop - if not NULL, set to the first character which isn't a part of the number, or to begin if there's no number
+ * Parsing stops at the first character which isn't a digit, so the number can be followed by anything else
+ * (check stop to find out if the whole string has been parsed). This doesn't allocate or copy anything.
+ */
+uint128_parse_status uint128_parse_n(const char *begin, const char * const end, const int base_or_auto,
+									 uint128_t * const out, const char ** stop);
+
 /// Conversion functions
 
 /* Gets the lower 64 bits of the 128-bit integer */
-uint64_t uint128_get_lower(const uint128_t a);
+CREN_INTS_PRIMITIVE uint64_t uint128_get_lower(const uint128_t a);
 
 /* Gets the higher 64 bits of the 128-bit integer */
-uint64_t uint128_get_higher(const uint128_t a);
+CREN_INTS_PRIMITIVE uint64_t uint128_get_higher(const uint128_t a);
+
+/* Loads a 128-bit uint from 16 bytes in little-endian (the lowest byte first) or big-endian (the highest byte first)
+ * order, the bytes don't need to be aligned. The byte swaps compile to bswap, or to movbe if it is available */
+CREN_INTS_PRIMITIVE uint128_t uint128_load_le(const void * const bytes);
+CREN_INTS_PRIMITIVE uint128_t uint128_load_be(const void * const bytes);
+
+/* Stores a 128-bit uint into 16 bytes in little-endian or big-endian order, the bytes don't need to be aligned */
+CREN_INTS_PRIMITIVE void uint128_store_le(void * const bytes, const uint128_t a);
+CREN_INTS_PRIMITIVE void uint128_store_be(void * const bytes, const uint128_t a);
 
 /* Converts the 128-bit uint to a string, storing it in the string argument, base can be one of from 2 to 36
  * string - where to store the result, this should be enough to fit any string-representation of an uint128,
- * 				   so 128 chars (maximum 128 chars if binary)
+ * 				   so 129 chars (maximum 128 chars if binary plus the terminating zero, see UINT128_STRING_SIZE)
  * returns pointer to the resulting string, if something has gone wrong during conversion it returns NULL
+ * Digits above 9 are written as lowercase letters.
  */
 const char * uint128_to_string(const uint128_t a, char * const string, const unsigned int base);
 
+/* Same as uint128_to_string, but returns the length of the written string (without the terminating zero),
+ * or 0 if something has gone wrong during conversion
+ */
+size_t uint128_format(const uint128_t a, char * const string, const unsigned int base);
+
+/* Formats the n values in the base (same as uint128_to_string) back to back into a single string, with the separator
+ * (a zero-terminated string, NULL is the same as "") between them, and the terminating zero after the last one
+ * string - where to store the result, capacity is its size, which must be more than uint128_format_array_size
+ * returns the length of the written string (without the terminating zero), or 0 if the base is invalid or the string
+ * doesn't fit into capacity, in which case nothing is written
+ * Every value is written right into its place, without any allocations or copies.
+ */
+size_t uint128_format_array(const uint128_t * const values, const size_t n, const unsigned int base,
+							const char * const separator, char * const string, const size_t capacity);
+
+/* Returns the exact length of the string written by uint128_format_array (without the terminating zero),
+ * or 0 if the base is invalid. In base 10 and in the bases which are powers of 2 this doesn't divide anything
+ */
+size_t uint128_format_array_size(const uint128_t * const values, const size_t n, const unsigned int base,
+								 const char * const separator);
+
 /// Bitwise operations
 
 /* Shift a 128-bit uint to the left by shift bits */
-uint128_t uint128_shift_left(const uint128_t a, const unsigned int shift);
+CREN_INTS_PRIMITIVE uint128_t uint128_shift_left(const uint128_t a, const unsigned int shift);
 
 /* Shift a 128-bit uint to the right by shift bits */
-uint128_t uint128_shift_right(const uint128_t a, const unsigned int shift);
+CREN_INTS_PRIMITIVE uint128_t uint128_shift_right(const uint128_t a, const unsigned int shift);
 
 /* Bitwise or of two 128-bit uints */
-uint128_t uint128_or(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_or(const uint128_t a, const uint128_t b);
 
 /* Bitwise or of an 128-bit uint with a 64-bit uint */
-uint128_t uint128_or_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_or_uint64(const uint128_t a, const uint64_t b);
 
 /* Bitwise xor of two 128-bit uints */
-uint128_t uint128_xor(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_xor(const uint128_t a, const uint128_t b);
 
 /* Bitwise xor of an 128-bit uint with a 64-bit uint */
-uint128_t uint128_xor_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_xor_uint64(const uint128_t a, const uint64_t b);
 
 /* Bitwise xor of two 128-bit uints */
-uint128_t uint128_and(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_and(const uint128_t a, const uint128_t b);
 
 /* Bitwise xor of an 128-bit uint with a 64-bit uint */
-uint128_t uint128_and_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_and_uint64(const uint128_t a, const uint64_t b);
 
 /// Comparison
 
 /* Compares two 128-bit uints, returning 1 if the two are equal */
-int uint128_equ(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE int uint128_equ(const uint128_t a, const uint128_t b);
 
 /* Compares two 128-bit uints, returning 1 if a < b */
-int uint128_lt(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE int uint128_lt(const uint128_t a, const uint128_t b);
 
 /* Compares two 128-bit uints, returning 1 if a <= b */
-int uint128_lte(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE int uint128_lte(const uint128_t a, const uint128_t b);
 
 /* Compares two 128-bit uints, returning 1 if a > b */
-int uint128_gt(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE int uint128_gt(const uint128_t a, const uint128_t b);
 
 /* Compares two 128-bit uints, returning 1 if a >= b */
-int uint128_gte(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE int uint128_gte(const uint128_t a, const uint128_t b);
 
 /// Arithmetic
 
 /* Adds two 128-bit uints together */
-uint128_t uint128_add(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_add(const uint128_t a, const uint128_t b);
 
 /* Adds a 64-bit uint to a 128-bit uint */
-uint128_t uint128_add_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_add_uint64(const uint128_t a, const uint64_t b);
 
 /* Subs the second 128-bit uint from the first one */
-uint128_t uint128_subtract(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_subtract(const uint128_t a, const uint128_t b);
 
 /* Subtracts a 64-bit uint to a 128-bit uint */
-uint128_t uint128_subtract_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_subtract_uint64(const uint128_t a, const uint64_t b);
 
 /* Multiplies two uint64's and creates a 128-bit uint with the result */
-uint128_t uint64_multiply(const uint64_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint64_multiply(const uint64_t a, const uint64_t b);
 
 /* Multiplies the two 128-bit uints */
-uint128_t uint128_multiply(const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply(const uint128_t a, const uint128_t b);
 
 /* Multiplies a 128-bit uint by a 64-bit uint */
-uint128_t uint128_multiply_uint64(const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply_uint64(const uint128_t a, const uint64_t b);
+
+// Struct defining the full 256-bit product of two 128-bit uints, split into the higher and lower 128 bits
+typedef struct uint128_multiply_full_result {
+	uint128_t hi, lo;
+} uint128_multiply_full_result;
+
+/* Multiplies the two 128-bit uints without dropping anything, returns the higher and lower halves of the product */
+CREN_INTS_PRIMITIVE uint128_multiply_full_result uint128_multiply_full(const uint128_t a, const uint128_t b);
+
+/* Multiplies the two 128-bit uints, returning only the higher 128 bits of the 256-bit product */
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply_high(const uint128_t a, const uint128_t b);
 
 // Struct defining the return type of divrem function which divides a uint128 by uint128,
 // calculating the quotient and remainder in the process
@@ -190,10 +270,130 @@ uint128_t uint128_divide_uint64(const uint128_t a, const uint64_t b);
 /* Computes the remainder from dividing the first 128-bit uint by a 64-bit uint */
 uint64_t uint128_mod_uint64(const uint128_t a, const uint64_t b);
 
+// Struct defining a precomputed divisor, which can be used to divide many values by the same divisor
+// without recomputing the normalization and the reciprocal every time. Should only be created
+// using uint128_divisor_init and only be used with the *_by functions
+typedef struct uint128_divisor_t {
+	uint128_t divisor;	 // the divisor shifted left so that its highest bit is set
+	uint64_t reciprocal; // the reciprocal of the normalized divisor
+	unsigned shift;		 // how many bits the divisor has been shifted by
+} uint128_divisor_t;
+
+/* Precomputes everything needed to divide by the given 128-bit uint, which must not be 0 */
+uint128_divisor_t uint128_divisor_init(const uint128_t b);
+
+/* Divides a 128-bit uint by a precomputed divisor, returns the quotient and remainder in struct */
+uint128_divrem_result uint128_divrem_by(const uint128_t a, const uint128_divisor_t * const divisor);
+
+/* Divides a 128-bit uint by a precomputed divisor */
+uint128_t uint128_div_by(const uint128_t a, const uint128_divisor_t * const divisor);
+
+/* Computes the remainder from dividing a 128-bit uint by a precomputed divisor */
+uint128_t uint128_mod_by(const uint128_t a, const uint128_divisor_t * const divisor);
+
+// Struct defining a precomputed divisor for the exact division and divisibility tests, which only need
+// a multiplication by the inverse of the divisor modulo 2^128. Should only be created using
+// uint128_exact_divisor_init and only be used with uint128_divexact_by and uint128_is_divisible_by
+typedef struct uint128_exact_divisor_t {
+	uint128_t inverse; // the inverse of the odd part of the divisor modulo 2^128
+	uint128_t limit;   // the largest quotient of a 128-bit uint divided by the divisor
+	unsigned shift;	   // how many trailing zero bits the divisor has
+} uint128_exact_divisor_t;
+
+/* Precomputes everything needed for the exact division and divisibility tests by the given 128-bit uint,
+ * which must not be 0 */
+uint128_exact_divisor_t uint128_exact_divisor_init(const uint128_t b);
+
+/* Divides the first 128-bit uint by the second one, the first one must be a multiple of the second one (the result
+ * is meaningless otherwise). Instead of a division, this multiplies by the inverse of the odd part of the divisor
+ * (the divisor without its trailing zero bits), which uint128_exact_divisor_init computes modulo 2^128. Here it is
+ * only needed modulo 2^64: the quotient fits into 64 bits if the divisor doesn't, and otherwise it is found
+ * 64 bits at a time */
+uint128_t uint128_divexact(const uint128_t a, const uint128_t b);
+
+/* Divides a 128-bit uint by a 64-bit uint, the 128-bit uint must be a multiple of the 64-bit one */
+uint128_t uint128_divexact_uint64(const uint128_t a, const uint64_t b);
+
+/* Divides a 128-bit uint by a precomputed divisor, the 128-bit uint must be a multiple of the divisor */
+CREN_INTS_PRIMITIVE uint128_t uint128_divexact_by(const uint128_t a, const uint128_exact_divisor_t * const divisor);
+
+/* Checks whether a 128-bit uint is a multiple of a precomputed divisor, using a multiplication and a comparison */
+CREN_INTS_PRIMITIVE int uint128_is_divisible_by(const uint128_t a, const uint128_exact_divisor_t * const divisor);
+
 /* Increments the 128-bit integer */
-uint128_t uint128_increment(const uint128_t a);
+CREN_INTS_PRIMITIVE uint128_t uint128_increment(const uint128_t a);
 
 /* Decrements the 128-bit integer */
-uint128_t uint128_decrement(const uint128_t a);
+CREN_INTS_PRIMITIVE uint128_t uint128_decrement(const uint128_t a);
+
+/// Out-parameter variants
+// The same operations, storing the result through a pointer instead of returning it: *_to stores the result
+// of the operation into *dst, *_assign replaces the first operand in *acc with it. On ABIs which return 16-byte
+// structs through memory (and for the 32-byte results of uint128_divrem) this avoids copying the result,
+// and the inline primitives let the compiler keep *acc in registers across the iterations of a loop.
+// dst and acc may point to the same value as the other operands
+
+/* *dst = a + b, *acc = *acc + b */
+CREN_INTS_PRIMITIVE void uint128_add_to(uint128_t * const dst, const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE void uint128_add_assign(uint128_t * const acc, const uint128_t b);
+
+/* *dst = a + b, *acc = *acc + b */
+CREN_INTS_PRIMITIVE void uint128_add_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE void uint128_add_uint64_assign(uint128_t * const acc, const uint64_t b);
+
+/* *dst = a - b, *acc = *acc - b */
+CREN_INTS_PRIMITIVE void uint128_subtract_to(uint128_t * const dst, const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE void uint128_subtract_assign(uint128_t * const acc, const uint128_t b);
+
+/* *dst = a - b, *acc = *acc - b */
+CREN_INTS_PRIMITIVE void uint128_subtract_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE void uint128_subtract_uint64_assign(uint128_t * const acc, const uint64_t b);
+
+/* *dst = a * b, *acc = *acc * b */
+CREN_INTS_PRIMITIVE void uint128_multiply_to(uint128_t * const dst, const uint128_t a, const uint128_t b);
+CREN_INTS_PRIMITIVE void uint128_multiply_assign(uint128_t * const acc, const uint128_t b);
+
+/* *dst = a * b, *acc = *acc * b */
+CREN_INTS_PRIMITIVE void uint128_multiply_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b);
+CREN_INTS_PRIMITIVE void uint128_multiply_uint64_assign(uint128_t * const acc, const uint64_t b);
+
+/* *dst = a << shift, *acc = *acc << shift */
+CREN_INTS_PRIMITIVE void uint128_shift_left_to(uint128_t * const dst, const uint128_t a, const unsigned int shift);
+CREN_INTS_PRIMITIVE void uint128_shift_left_assign(uint128_t * const acc, const unsigned int shift);
+
+/* *dst = a >> shift, *acc = *acc >> shift */
+CREN_INTS_PRIMITIVE void uint128_shift_right_to(uint128_t * const dst, const uint128_t a, const unsigned int shift);
+CREN_INTS_PRIMITIVE void uint128_shift_right_assign(uint128_t * const acc, const unsigned int shift);
+
+/* *quotient = a / b, *remainder = a % b */
+void uint128_divrem_to(uint128_t * const quotient, uint128_t * const remainder, const uint128_t a, const uint128_t b);
+
+/* *dst = a / b, *acc = *acc / b */
+void uint128_divide_to(uint128_t * const dst, const uint128_t a, const uint128_t b);
+void uint128_divide_assign(uint128_t * const acc, const uint128_t b);
+
+/* *dst = a % b, *acc = *acc % b */
+void uint128_mod_to(uint128_t * const dst, const uint128_t a, const uint128_t b);
+void uint128_mod_assign(uint128_t * const acc, const uint128_t b);
+
+/* *dst = a / b, *acc = *acc / b */
+void uint128_divide_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b);
+void uint128_divide_uint64_assign(uint128_t * const acc, const uint64_t b);
+
+/* *quotient = a / divisor, *remainder = a % divisor */
+void uint128_divrem_by_to(uint128_t * const quotient, uint128_t * const remainder, const uint128_t a,
+						  const uint128_divisor_t * const divisor);
+
+/* *dst = a / divisor, *acc = *acc / divisor */
+void uint128_div_by_to(uint128_t * const dst, const uint128_t a, const uint128_divisor_t * const divisor);
+void uint128_div_by_assign(uint128_t * const acc, const uint128_divisor_t * const divisor);
+
+/* *dst = a % divisor, *acc = *acc % divisor */
+void uint128_mod_by_to(uint128_t * const dst, const uint128_t a, const uint128_divisor_t * const divisor);
+void uint128_mod_by_assign(uint128_t * const acc, const uint128_divisor_t * const divisor);
+
+#ifdef CREN_INTEGERS_INLINE
+#include "integers/uint128_primitives.h"
+#endif
 
 #endif //CREN_INTEGERS_UINT128_H
@@ -0,0 +1,86 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_ARRAY_H
+#define CREN_INTEGERS_UINT128_ARRAY_H
+
+/***** uint128_array.h *****
+ * This header defines the arithmetic over whole arrays of 128-bit uints, which processes several elements at once
+ * instead of calling the primitives for every element. The arrays can either be arrays of uint128_t, or split into
+ * two arrays of the higher and the lower halves (uint128_soa_t), which is the faster layout for vectors.
+ * On x86-64 the addition, subtraction, comparison and sum are vectorized with AVX2 (2 elements of uint128_t arrays
+ * or 4 elements of split arrays per vector) and AVX-512 (4 or 8 elements), with the carries between the halves
+ * computed by unsigned comparisons. The version is picked at startup the same way as the dispatched division.
+ * The multiplication stays scalar, since vectors don't have a 64-bit multiplication with the higher half
+ * of the product, and the scalar one already multiplies about one element per cycle.
+ * The result may be the same array as one of the operands in all of these, but they mustn't overlap otherwise.
+ * The byte order functions convert arrays of 16-byte values in little-endian or big-endian order, which don't need
+ * to be aligned. Reversing the bytes of the elements is vectorized with vpshufb, 2 elements per AVX2 vector (AVX-512
+ * uses the same version, since the conversion is bound by memory anyway), the machine's own order is just copied.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "integers/uint128.h"
+
+// Struct defining an array of 128-bit uints split into the arrays of their higher and lower halves,
+// the element i is uint128_create(higher[i], lower[i])
+typedef struct uint128_soa_t {
+	uint64_t *higher;
+	uint64_t *lower;
+} uint128_soa_t;
+
+/// Arrays of uint128_t
+
+/* result[i] = a[i] + b[i] for all i < n */
+void uint128_add_array(uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+					   const size_t n);
+
+/* result[i] = a[i] - b[i] for all i < n */
+void uint128_sub_array(uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+					   const size_t n);
+
+/* result[i] = a[i] * b[i] for all i < n */
+void uint128_mul_uint64_array(uint128_t * const result, const uint128_t * const a, const uint64_t * const b,
+							  const size_t n);
+
+/* result[i] = -1, 0 or 1 if a[i] is less than, equal to or greater than b[i] for all i < n */
+void uint128_cmp_array(int8_t * const result, const uint128_t * const a, const uint128_t * const b, const size_t n);
+
+/* Returns the sum of the n elements (modulo 2^128) */
+uint128_t uint128_sum(const uint128_t * const a, const size_t n);
+
+/// Split arrays
+// The same as the functions above, but for the split arrays
+
+void uint128_add_array_soa(const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b, const size_t n);
+
+void uint128_sub_array_soa(const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b, const size_t n);
+
+void uint128_mul_uint64_array_soa(const uint128_soa_t result, const uint128_soa_t a, const uint64_t * const b,
+								  const size_t n);
+
+void uint128_cmp_array_soa(int8_t * const result, const uint128_soa_t a, const uint128_soa_t b, const size_t n);
+
+uint128_t uint128_sum_soa(const uint128_soa_t a, const size_t n);
+
+/// Byte order
+// The bytes may be the same memory as the values, but they mustn't overlap otherwise
+
+/* values[i] = uint128_load_le(bytes + 16 * i) for all i < n */
+void uint128_load_le_array(uint128_t * const values, const void * const bytes, const size_t n);
+
+/* values[i] = uint128_load_be(bytes + 16 * i) for all i < n */
+void uint128_load_be_array(uint128_t * const values, const void * const bytes, const size_t n);
+
+/* uint128_store_le(bytes + 16 * i, values[i]) for all i < n */
+void uint128_store_le_array(void * const bytes, const uint128_t * const values, const size_t n);
+
+/* uint128_store_be(bytes + 16 * i, values[i]) for all i < n */
+void uint128_store_be_array(void * const bytes, const uint128_t * const values, const size_t n);
+
+/* Reverses the bytes of every one of the n 16-byte elements of from and stores them into to, which converts them
+ * between little-endian and big-endian */
+void uint128_byte_swap_array(void * const to, const void * const from, const size_t n);
+
+#endif //CREN_INTEGERS_UINT128_ARRAY_H
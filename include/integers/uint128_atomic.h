@@ -0,0 +1,50 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_ATOMIC_H
+#define CREN_INTEGERS_UINT128_ATOMIC_H
+
+/***** uint128_atomic.h *****
+ * This header defines the atomic 128-bit uint, which can be shared between threads without a mutex, for example
+ * as a 128-bit counter or a (pointer, tag) pair. All of the operations are sequentially consistent.
+ * On x86-64 they are built on the cmpxchg16b instruction (selected at runtime, unless the compiler already targets
+ * it with -mcx16), on AArch64 on the 128-bit exclusive load/store pairs or the LSE casp instruction, chosen by
+ * the compiler. Everywhere else, and on the rare x86-64 CPUs without cmpxchg16b, the operations take one of
+ * a fixed set of spin locks, picked by the address of the value, so unrelated values rarely share a lock.
+ **/
+
+#include "integers/uint128.h"
+
+// Struct defining an atomic 128-bit uint. Shouldn't be accessed directly, only through the functions here
+typedef struct atomic_uint128_t {
+	_Alignas(16) uint128_t value; // cmpxchg16b requires the value to be aligned to 16 bytes
+} atomic_uint128_t;
+
+/* Initializes the atomic value, this isn't atomic itself and must happen before the value is shared.
+ * A zeroed atomic_uint128_t (including one initialized with {0}) is already initialized to 0 */
+void atomic_uint128_init(atomic_uint128_t * const a, const uint128_t value);
+
+/* Returns 1 if the operations on the atomic value don't take locks on this CPU, which is the same for all values */
+int atomic_uint128_is_lock_free(const atomic_uint128_t * const a);
+
+/* Atomically loads the value. Note that without locks this is done using a compare-and-swap as well,
+ * so it needs write access to the value's cache line */
+uint128_t atomic_uint128_load(atomic_uint128_t * const a);
+
+/* Atomically stores the value */
+void atomic_uint128_store(atomic_uint128_t * const a, const uint128_t value);
+
+/* Atomically replaces the value, returning the previous one */
+uint128_t atomic_uint128_exchange(atomic_uint128_t * const a, const uint128_t value);
+
+/* Atomically replaces the value with desired if it is equal to *expected and returns 1, otherwise stores
+ * the current value into *expected and returns 0 */
+int atomic_uint128_compare_exchange(atomic_uint128_t * const a, uint128_t * const expected, const uint128_t desired);
+
+/* Atomically adds to the value (modulo 2^128), returning the previous value */
+uint128_t atomic_uint128_fetch_add(atomic_uint128_t * const a, const uint128_t value);
+
+/* Atomically ors the value with another one, returning the previous value */
+uint128_t atomic_uint128_fetch_or(atomic_uint128_t * const a, const uint128_t value);
+
+#endif //CREN_INTEGERS_UINT128_ATOMIC_H
@@ -0,0 +1,75 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_COLUMN_H
+#define CREN_INTEGERS_UINT128_COLUMN_H
+
+/***** uint128_column.h *****
+ * This header defines a file format for large arrays of 128-bit uints (columns), which is queried in place
+ * by mapping the file into memory instead of reading all of it first. The file consists of:
+ * - a header of UINT128_COLUMN_HEADER_SIZE bytes, with the format's magic, the number of values and the number
+ *   of values in every block (all 64-bit fields are in little-endian),
+ * - the smallest and the largest value of every block, 32 bytes per block,
+ * - the values in little-endian, starting at UINT128_COLUMN_DATA_ALIGNMENT bytes from the start of the file,
+ *   split into the blocks of the same number of values (except for the last one).
+ * Since the blocks are 4 KB-aligned, the range queries only touch the pages of the statistics and the blocks
+ * which have both values in the range and out of it: the ones completely out of the range are skipped,
+ * and all values of the ones completely in it are known to match without reading them. The mapping is advised
+ * to be read randomly, apart from the statistics and the blocks which are about to be scanned, so the memory which
+ * is read in from the file depends on how much of it is queried, rather than on its size. The values don't need
+ * to be sorted, but the blocks of sorted columns have the smallest overlaps, so most of them are skipped.
+ * The files can only be opened on the platforms with POSIX mmap (Linux, BSD and macOS), but written on all of them.
+ **/
+
+#include <stddef.h>
+#include "integers/uint128.h"
+
+#define UINT128_COLUMN_HEADER_SIZE 64
+#define UINT128_COLUMN_DATA_ALIGNMENT 4096
+// Blocks of 64 KB, the number of values in a block must be a multiple of 256, so that the blocks are 4 KB-aligned
+#define UINT128_COLUMN_BLOCK_VALUES 4096
+
+// Struct defining a column file mapped into memory, its fields must not be changed
+typedef struct uint128_column_t {
+	const unsigned char *mapping;
+	size_t mapping_size;
+	size_t values;		 // number of values in the column
+	size_t block_values; // number of values in every block except for the last one
+	size_t blocks;
+	const unsigned char *statistics; // the smallest and the largest value of every block
+	const unsigned char *data;		 // the values, 16 bytes each
+} uint128_column_t;
+
+// Status of writing or opening a column file
+typedef enum uint128_column_status {
+	UINT128_COLUMN_OK = 0,
+	UINT128_COLUMN_FILE_ERROR,	// the file couldn't be created, written, opened or mapped, errno tells why
+	UINT128_COLUMN_INVALID,		// the file isn't a valid column file, or the number of values in a block is invalid
+	UINT128_COLUMN_UNSUPPORTED	// the files can't be mapped into memory on this platform
+} uint128_column_status;
+
+/* Writes the n values into the file as a column, which is created or truncated, with block_values values
+ * in every block (0 is the same as UINT128_COLUMN_BLOCK_VALUES) */
+uint128_column_status uint128_column_write(const char * const path, const uint128_t * const values, const size_t n,
+										   const size_t block_values);
+
+/* Opens the column file by mapping it into memory, the column must be closed by uint128_column_close
+ * if the status is UINT128_COLUMN_OK */
+uint128_column_status uint128_column_open(const char * const path, uint128_column_t * const column);
+
+void uint128_column_close(uint128_column_t * const column);
+
+/* Returns the index-th value of the column, which must be less than the number of its values */
+uint128_t uint128_column_get(const uint128_column_t * const column, const size_t index);
+
+/* Returns the smallest and the largest value of the block from the statistics, without reading the block */
+uint128_t uint128_column_block_min(const uint128_column_t * const column, const size_t block);
+uint128_t uint128_column_block_max(const uint128_column_t * const column, const size_t block);
+
+/* Finds the values x of the column with lo <= x < hi, stores the indices of the first capacity of them
+ * into indices (in increasing order) and returns the number of all of them, indices may be NULL if the capacity
+ * is 0. Only the blocks with both values in the range and out of it are read */
+size_t uint128_column_range(const uint128_column_t * const column, const uint128_t lo, const uint128_t hi,
+							size_t * const indices, const size_t capacity);
+
+#endif //CREN_INTEGERS_UINT128_COLUMN_H
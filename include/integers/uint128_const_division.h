@@ -0,0 +1,165 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_CONST_DIVISION_H
+#define CREN_INTEGERS_UINT128_CONST_DIVISION_H
+
+/***** uint128_const_division.h *****
+ * This header defines division of 128-bit uints by 64-bit divisors which are known at compile time, such as 10,
+ * 1000, 10^19 or the number of nanoseconds in a day. The normalization shift and the reciprocal of the divisor
+ * (the same ones uint128_divisor_init would compute) are constant expressions, so the division compiles down to
+ * a multiplication by the reciprocal and a couple of additions, shifts and corrections, without calling anything.
+ * The higher half of the dividend is divided by the compiler itself, which does the same for 64-bit constants.
+ * Everything here is always inlined, whether CREN_INTEGERS_INLINE is defined or not.
+ **/
+
+#include <stdint.h>
+#include "integers/uint128.h"
+
+/* Number of leading zero bits of a 64-bit constant, 64 for 0, as a constant expression */
+#define UINT128_CONST_BITS_8_(d, from) \
+	(((d) >> (from)) != 0) + (((d) >> ((from) + 1)) != 0) + (((d) >> ((from) + 2)) != 0) + \
+	(((d) >> ((from) + 3)) != 0) + (((d) >> ((from) + 4)) != 0) + (((d) >> ((from) + 5)) != 0) + \
+	(((d) >> ((from) + 6)) != 0) + (((d) >> ((from) + 7)) != 0)
+#define UINT128_CONST_SHIFT(d) \
+	(64u - (unsigned)(UINT128_CONST_BITS_8_((uint64_t)(d), 0) + UINT128_CONST_BITS_8_((uint64_t)(d), 8) + \
+					  UINT128_CONST_BITS_8_((uint64_t)(d), 16) + UINT128_CONST_BITS_8_((uint64_t)(d), 24) + \
+					  UINT128_CONST_BITS_8_((uint64_t)(d), 32) + UINT128_CONST_BITS_8_((uint64_t)(d), 40) + \
+					  UINT128_CONST_BITS_8_((uint64_t)(d), 48) + UINT128_CONST_BITS_8_((uint64_t)(d), 56)))
+
+/* The divisor shifted left so that its highest bit is set */
+#define UINT128_CONST_NORMALIZED(d) ((uint64_t)(d) << UINT128_CONST_SHIFT(d))
+
+/* The reciprocal of the normalized divisor, floor((2^128 - 1) / normalized) - 2^64. If the compiler has a 128-bit
+ * integer type this is a constant expression (usable in static initializers), otherwise it is computed by an inline
+ * function, which is still folded into a constant by the optimizer */
+#if defined(__SIZEOF_INT128__)
+#define UINT128_CONST_RECIPROCAL(d) \
+	(__extension__ (uint64_t)(~(unsigned __int128)0 / UINT128_CONST_NORMALIZED(d)))
+#else
+#define UINT128_CONST_RECIPROCAL(d) i_uint128_const_reciprocal(UINT128_CONST_NORMALIZED(d))
+#endif
+
+/* Divides a 128-bit uint by a non-zero 64-bit constant, returning the quotient and remainder in uint128_divrem_result.
+ * d should be an integer constant expression, with a runtime divisor this still works, but is slower
+ * than uint128_divrem_by with a precomputed divisor */
+#define UINT128_DIVREM_BY_CONST(a, d) \
+	i_uint128_divrem_by_const((a), (uint64_t)(d), UINT128_CONST_NORMALIZED(d), UINT128_CONST_RECIPROCAL(d), \
+							  UINT128_CONST_SHIFT(d))
+
+/* Divides a 128-bit uint by a non-zero 64-bit constant, same as uint128_divide_uint64 */
+#define UINT128_DIV_BY_CONST(a, d) (UINT128_DIVREM_BY_CONST(a, d).quotient)
+
+/* Computes the remainder of a 128-bit uint divided by a non-zero 64-bit constant as a 64-bit uint,
+ * same as uint128_mod_uint64 */
+#define UINT128_MOD_BY_CONST(a, d) i_uint128_low_const(UINT128_DIVREM_BY_CONST(a, d).remainder)
+
+/// Implementation
+// The primitives aren't used here, since they are function calls unless CREN_INTEGERS_INLINE is defined
+
+static inline uint64_t i_uint128_high_const(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return (uint64_t)(a >> 64);
+#else
+	return a.hi;
+#endif
+}
+
+static inline uint64_t i_uint128_low_const(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return (uint64_t)a;
+#else
+	return a.lo;
+#endif
+}
+
+static inline uint128_t i_uint128_create_const(const uint64_t hi, const uint64_t lo) {
+#if COMPILER_INT128_AVAILABLE
+	return ((uint128_t)hi << 64) | lo;
+#else
+	return (uint128_t){.hi = hi, .lo = lo};
+#endif
+}
+
+/* Multiplies two 64-bit uints, returning the higher half of the product and storing the lower one */
+static inline uint64_t i_uint64_multiply_const(const uint64_t a, const uint64_t b, uint64_t * const lower) {
+#if defined(__SIZEOF_INT128__)
+	__extension__ const unsigned __int128 product = (unsigned __int128)a * b;
+	*lower = (uint64_t)product;
+	return (uint64_t)(product >> 64);
+#else
+	const uint64_t lo_lo = (a & 0xffffffffu) * (b & 0xffffffffu), hi_lo = (a >> 32) * (b & 0xffffffffu);
+	const uint64_t lo_hi = (a & 0xffffffffu) * (b >> 32), hi_hi = (a >> 32) * (b >> 32);
+	const uint64_t middle = (lo_lo >> 32) + (hi_lo & 0xffffffffu) + lo_hi;
+	*lower = (middle << 32) | (lo_lo & 0xffffffffu);
+	return hi_hi + (hi_lo >> 32) + (middle >> 32);
+#endif
+}
+
+#if !defined(__SIZEOF_INT128__)
+/* Computes floor((2^128 - 1) / normalized) - 2^64 as a division of (2^64 - 1 - normalized) * 2^64 + 2^64 - 1
+ * by the normalized divisor in 32-bit digits (Knuth's algorithm D). With a normalized divisor every quotient digit
+ * is at most 2 too large, so the corrections are straight-line code, which the compiler can fold */
+static inline uint64_t i_uint128_const_reciprocal(const uint64_t normalized) {
+	const uint64_t divisor_higher = normalized >> 32, divisor_lower = normalized & 0xffffffffu;
+	uint64_t remainder = ~normalized, quotient = 0;
+	for (int digit = 0; digit < 2; digit++) {
+		uint64_t digit_quotient = remainder / divisor_higher;
+		uint64_t digit_remainder = remainder - digit_quotient * divisor_higher;
+		for (int correction = 0; correction < 2; correction++) {
+			if (digit_remainder >> 32 == 0 &&
+				(digit_quotient >> 32 != 0 || digit_quotient * divisor_lower > ((digit_remainder << 32) | 0xffffffffu))) {
+				digit_quotient--;
+				digit_remainder += divisor_higher;
+			}
+		}
+		remainder = ((remainder << 32) | 0xffffffffu) - digit_quotient * normalized;
+		quotient = (quotient << 32) | digit_quotient;
+	}
+	return quotient;
+}
+#endif
+
+/* Divides a 128-bit uint by the divisor with its normalized value, reciprocal and shift. With a constant divisor
+ * all of the branches on it are resolved at compile time */
+static inline uint128_divrem_result i_uint128_divrem_by_const(const uint128_t a, const uint64_t divisor,
+															   const uint64_t normalized, const uint64_t reciprocal,
+															   const unsigned shift) {
+	const uint64_t higher = i_uint128_high_const(a), lower = i_uint128_low_const(a);
+	// powers of 2 are just a shift and a mask
+	if ((divisor & (divisor - 1)) == 0) {
+		const unsigned bits = 63 - shift;
+		return (uint128_divrem_result){
+			.quotient = bits == 0 ? a : i_uint128_create_const(higher >> bits,
+															   (lower >> bits) | (higher << ((64 - bits) & 63))),
+			.remainder = i_uint128_create_const(0, lower & (divisor - 1))};
+	}
+
+	// the compiler replaces this with a multiplication as well, and the remainder of it is less than the divisor,
+	// so the rest of the quotient fits into 64 bits
+	const uint64_t quotient_higher = higher / divisor;
+	const uint64_t remainder_higher = higher - quotient_higher * divisor;
+	const uint64_t dividend_higher = shift == 0 ? remainder_higher
+												: (remainder_higher << shift) | (lower >> ((64 - shift) & 63));
+	const uint64_t dividend_lower = lower << shift;
+
+	// the 2-by-1 division by the reciprocal from Möller and Granlund's "Improved division by invariant integers",
+	// same as divrem_uint128_by_uint64
+	uint64_t guess_lower;
+	uint64_t quotient = i_uint64_multiply_const(reciprocal, dividend_higher, &guess_lower);
+	guess_lower += dividend_lower;
+	quotient += dividend_higher + 1 + (guess_lower < dividend_lower);
+	uint64_t remainder = dividend_lower - quotient * normalized;
+	if (remainder > guess_lower) {
+		quotient--;
+		remainder += normalized;
+	}
+	if (remainder >= normalized) {
+		quotient++;
+		remainder -= normalized;
+	}
+	return (uint128_divrem_result){.quotient = i_uint128_create_const(quotient_higher, quotient),
+								   .remainder = i_uint128_create_const(0, remainder >> shift)};
+}
+
+#endif //CREN_INTEGERS_UINT128_CONST_DIVISION_H
@@ -0,0 +1,77 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_CONVERT_H
+#define CREN_INTEGERS_UINT128_CONVERT_H
+
+/***** uint128_convert.h *****
+ * This header defines the conversion of text with one 128-bit uint per line into a packed binary array of them,
+ * UINT128_CONVERT_VALUE_SIZE bytes per value, each one stored in little-endian (so the lower 64 bits go first).
+ * The text is split into chunks at line boundaries, which are converted by separate threads: every thread counts
+ * the lines of its chunk first, so that it knows where its values go in the output, and then parses them in place
+ * using uint128_parse_n. The line ends are found 64 bytes at a time using SSE2 where it is available.
+ * Lines end with "\n" or "\r\n", and the last one doesn't need to end with a newline. The lines which can't be
+ * parsed completely (including the empty ones) are stored as 0 and counted as errors, without stopping
+ * the conversion. Besides the errors of the whole text, the errors of every chunk can be reported separately.
+ **/
+
+#include <stddef.h>
+#include "integers/uint128.h"
+
+// Bytes taken by every value in the output
+#define UINT128_CONVERT_VALUE_SIZE 16
+
+// Maximum number of chunks the text is split into, one per thread
+#define UINT128_CONVERT_MAX_CHUNKS 64
+
+// Struct defining the result of a conversion
+typedef struct uint128_convert_result {
+	size_t values;							 // number of lines, which is the number of values in the output
+	size_t errors;							 // number of lines which couldn't be parsed
+	size_t first_error_line;				 // index of the first such line (from 0), if there are any
+	uint128_parse_status first_error_status; // why the first such line couldn't be parsed
+	unsigned chunks;						 // number of chunks the text has been split into
+} uint128_convert_result;
+
+// Struct defining the result of converting one of the chunks, the lines are counted from the start of the text
+typedef struct uint128_convert_chunk {
+	size_t first_line;						 // index of the chunk's first line
+	size_t lines;							 // number of the chunk's lines
+	size_t errors;							 // number of the chunk's lines which couldn't be parsed
+	size_t first_error_line;				 // index of the first such line, if there are any
+	uint128_parse_status first_error_status; // why the first such line couldn't be parsed
+} uint128_convert_chunk;
+
+// Status of converting a file using uint128_convert_file
+typedef enum uint128_convert_file_status {
+	UINT128_CONVERT_FILE_OK = 0,	   // the file has been converted, even if some of its lines couldn't be parsed
+	UINT128_CONVERT_FILE_INPUT_ERROR,  // the input file couldn't be opened or mapped, errno tells why
+	UINT128_CONVERT_FILE_OUTPUT_ERROR, // the output file couldn't be created or mapped, errno tells why
+	UINT128_CONVERT_FILE_UNSUPPORTED   // the files can't be mapped into memory on this platform
+} uint128_convert_file_status;
+
+/* Counts the lines of the text (of the given length, it doesn't need to be zero-terminated), which is the number
+ * of values it is converted into, using the given number of threads (0 is the same as 1) */
+size_t uint128_convert_count(const char * const text, const size_t length, const unsigned threads);
+
+/* Converts the text into output, which must have room for UINT128_CONVERT_VALUE_SIZE bytes for every line,
+ * using the given number of threads (0 is the same as 1, at most 64 are used, and only if every one of them gets
+ * at least 64 KB of text). base_or_auto is the same as for uint128_parse_n */
+uint128_convert_result uint128_convert(const char * const text, const size_t length, const int base_or_auto,
+									   unsigned char * const output, const unsigned threads);
+
+/* The same as uint128_convert, which also stores the results of the chunks into chunks (unless it is NULL),
+ * it must have room for the number of threads (at most UINT128_CONVERT_MAX_CHUNKS) of them */
+uint128_convert_result uint128_convert_chunks(const char * const text, const size_t length, const int base_or_auto,
+											  unsigned char * const output, const unsigned threads,
+											  uint128_convert_chunk * const chunks);
+
+/* Converts the input file into the output file, which is created or truncated, mapping both of them into memory.
+ * The result of the conversion is stored into result, and the results of the chunks into chunks (unless it is NULL,
+ * like for uint128_convert_chunks) if the status is UINT128_CONVERT_FILE_OK */
+uint128_convert_file_status uint128_convert_file(const char * const input_path, const char * const output_path,
+												 const int base_or_auto, const unsigned threads,
+												 uint128_convert_result * const result,
+												 uint128_convert_chunk * const chunks);
+
+#endif //CREN_INTEGERS_UINT128_CONVERT_H
@@ -0,0 +1,86 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_MAP_H
+#define CREN_INTEGERS_UINT128_MAP_H
+
+/***** uint128_map.h *****
+ * This header defines a hash map from 128-bit uint keys to 64-bit uint values (which can be indices, offsets or
+ * pointers cast to uintptr_t). It is an open-addressing table in the style of Abseil's SwissTable: the entries are
+ * stored in one flat array, and every slot has a control byte with 7 bits of the key's hash, which are compared
+ * for a whole group of 16 slots at once using SSE2 (or 8 slots using 64-bit SWAR without SSE2), so a lookup
+ * usually touches one group of control bytes and a single entry.
+ * Every slot takes UINT128_MAP_SLOT_SIZE bytes, the number of slots is a power of 2 and at most 7/8 of them are
+ * used before the map grows, uint128_map_memory_size gives the exact amount of memory for a number of entries.
+ * The map allocates its memory using malloc. The hash isn't randomized, so it isn't meant for keys chosen
+ * by an adversary.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "integers/uint128.h"
+
+// Bytes taken by every slot of the map: the key and value, and the control byte
+#define UINT128_MAP_SLOT_SIZE (3 * sizeof(uint64_t) + 1)
+
+// Struct defining an entry of the map, the key is stored as two halves, so that entries don't need any padding
+typedef struct uint128_map_entry {
+	uint64_t key_lower;
+	uint64_t key_higher;
+	uint64_t value;
+} uint128_map_entry;
+
+// Struct defining the hash map. Should only be created using uint128_map_init and only be accessed through
+// the functions here
+typedef struct uint128_map_t {
+	uint128_map_entry *entries;
+	uint8_t *control;	 // control byte of every slot, followed by the copies of the first group of them
+	size_t capacity;	 // number of slots, either 0 or a power of 2
+	size_t size;		 // number of entries
+	size_t growth_left;	 // number of entries which can be inserted into empty slots before the map has to grow
+} uint128_map_t;
+
+// Status of inserting into the map
+typedef enum uint128_map_status {
+	UINT128_MAP_INSERTED = 0, // the key has been inserted (for uint128_map_insert_many - all of the keys)
+	UINT128_MAP_UPDATED,	  // the key was already in the map, its value has been replaced
+	UINT128_MAP_NO_MEMORY	  // the map had to grow, but the memory couldn't be allocated, it hasn't been changed
+} uint128_map_status;
+
+/* Initializes an empty map, which doesn't allocate anything until the first insertion */
+void uint128_map_init(uint128_map_t * const map);
+
+/* Frees the memory of the map, after which it is empty again and can be reused */
+void uint128_map_free(uint128_map_t * const map);
+
+/* Number of bytes allocated by a map holding the given number of entries, if it has grown by insertions
+ * or been reserved for exactly that many. SIZE_MAX if that many entries can't fit into memory at all */
+size_t uint128_map_memory_size(const size_t entries);
+
+/* Makes sure that the given number of entries fit into the map without growing it, returns 0 if the memory
+ * couldn't be allocated (the map doesn't change then), otherwise 1 */
+int uint128_map_reserve(uint128_map_t * const map, const size_t entries);
+
+/* Inserts the key with the value, or replaces the value if the key is already in the map */
+uint128_map_status uint128_map_insert(uint128_map_t * const map, const uint128_t key, const uint64_t value);
+
+/* Inserts n keys with their values the same way as uint128_map_insert, but reserves the space for all of them once,
+ * and hashes the keys in batches, prefetching their slots before inserting. If the memory couldn't be allocated,
+ * nothing is inserted and UINT128_MAP_NO_MEMORY is returned, otherwise UINT128_MAP_INSERTED */
+uint128_map_status uint128_map_insert_many(uint128_map_t * const map, const uint128_t * const keys,
+										   const uint64_t * const values, const size_t n);
+
+/* Finds the key, returns the pointer to its value, which stays valid until the map is changed, or NULL
+ * if the key isn't in the map */
+uint64_t * uint128_map_find(const uint128_map_t * const map, const uint128_t key);
+
+/* Removes the key from the map, returns 1 if it was there, otherwise 0 */
+int uint128_map_erase(uint128_map_t * const map, const uint128_t key);
+
+/* Iterates over the entries of the map in an unspecified order: *position should be 0 at the start, and every call
+ * stores the next entry into key and value (unless they are NULL) and returns 1, or returns 0 after the last one.
+ * The map mustn't be changed during the iteration */
+int uint128_map_next(const uint128_map_t * const map, size_t * const position, uint128_t * const key,
+					 uint64_t * const value);
+
+#endif //CREN_INTEGERS_UINT128_MAP_H
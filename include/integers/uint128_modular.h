@@ -0,0 +1,70 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_MODULAR_H
+#define CREN_INTEGERS_UINT128_MODULAR_H
+
+/***** uint128_modular.h *****
+ * This header defines modular arithmetic with 128-bit moduli. Everything that depends only on the modulus is
+ * precomputed once in a modulus context, after which the products are reduced using division by the precomputed
+ * reciprocal (same as the *_by division functions), or using Montgomery multiplication if the modulus is odd.
+ * Products are always computed in full 256 bits, so nothing overflows, even for moduli close to 2^128.
+ **/
+
+#include "integers/uint128.h"
+
+// Struct defining a precomputed modulus. Should only be created using uint128_modulus_init
+typedef struct uint128_modulus_t {
+	uint128_t modulus;
+	// the normalized modulus with its reciprocal, which is computed even if the modulus has its highest bit set,
+	// so it can be used with the *_by division functions as well
+	uint128_divisor_t divisor;
+	// Montgomery parameters for R = 2^128, the inverse is only valid (non-zero) if the modulus is odd
+	uint128_t montgomery_inverse; // -modulus^-1 mod R
+	uint128_t montgomery_one;	  // R mod modulus, which is 1 in the Montgomery form
+	uint128_t montgomery_r2;	  // R^2 mod modulus, used to convert values to the Montgomery form
+} uint128_modulus_t;
+
+/* Precomputes everything needed to do arithmetic modulo the given 128-bit uint, which must not be 0 */
+uint128_modulus_t uint128_modulus_init(const uint128_t m);
+
+/* Reduces any 128-bit uint modulo the precomputed modulus */
+uint128_t uint128_reduce(const uint128_t a, const uint128_modulus_t * const modulus);
+
+/// Arithmetic on reduced values
+// All of these expect their arguments to already be less than the modulus
+
+/* Computes (a + b) mod modulus */
+uint128_t uint128_addmod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus);
+
+/* Computes (a - b) mod modulus */
+uint128_t uint128_submod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus);
+
+/* Computes (a * b) mod modulus using the full 256-bit product */
+uint128_t uint128_mulmod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus);
+
+/* Computes (base ^ exponent) mod modulus, the base doesn't have to be reduced. Uses the Montgomery form internally
+ * if the modulus is odd */
+uint128_t uint128_powmod(const uint128_t base, const uint128_t exponent, const uint128_modulus_t * const modulus);
+
+/// Montgomery form
+// Only usable with odd moduli. A value a is represented as a * 2^128 mod modulus, which makes the multiplication
+// cheaper than the reduction by reciprocal, but requires converting to and from the form
+
+/* Converts any 128-bit uint to the Montgomery form */
+uint128_t uint128_to_montgomery(const uint128_t a, const uint128_modulus_t * const modulus);
+
+/* Converts a value from the Montgomery form back to a normal reduced value */
+uint128_t uint128_from_montgomery(const uint128_t a, const uint128_modulus_t * const modulus);
+
+/* Multiplies two values in the Montgomery form, the result is in the Montgomery form as well */
+uint128_t uint128_montgomery_multiply(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus);
+
+/// Primality
+
+/* Returns 1 if the 128-bit uint is a prime, 0 otherwise. Uses the Miller-Rabin test with the first 13 primes as
+ * bases, which is proven to be exact for all values below 3.3 * 10^24. Larger values additionally have to pass
+ * the strong Lucas test (which together make up the Baillie-PSW test), for which no counterexample is known */
+int uint128_is_prime(const uint128_t n);
+
+#endif //CREN_INTEGERS_UINT128_MODULAR_H
@@ -0,0 +1,69 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_PACKING_H
+#define CREN_INTEGERS_UINT128_PACKING_H
+
+/***** uint128_packing.h *****
+ * This header defines a block codec for columns of 128-bit uints which are close to each other, like sorted keys:
+ * every block of up to UINT128_PACKING_BLOCK_VALUES values is stored as its smallest value (the base) and the
+ * differences of the values from the base, packed with as many bits as the largest difference takes (rounded up
+ * to an even number, which keeps the lanes described below whole words).
+ * A block is UINT128_PACKING_HEADER_SIZE bytes of header (the base in little-endian, the number of bits and the
+ * number of values) followed by 16 bytes for every bit of the differences, so its size only depends on the bits,
+ * and the blocks of an array can be found by reading just their headers, without unpacking the previous ones.
+ * The lower 64 bits of the differences are packed separately from the higher ones (which are only there if some
+ * difference doesn't fit into 64 bits), and both are packed into 4 interleaved lanes of 64-bit words: the value i
+ * is the (i / 4)-th value of the lane (i % 4), so the same shifts unpack 4 consecutive values from a single AVX2
+ * vector. On x86-64 the unpacking is vectorized with AVX2, picked at startup the same way as in uint128_array.h.
+ **/
+
+#include <stddef.h>
+#include "integers/uint128.h"
+
+#define UINT128_PACKING_BLOCK_VALUES 128
+#define UINT128_PACKING_HEADER_SIZE 18
+// Size of a block with the values differing in all 128 bits
+#define UINT128_PACKING_MAX_BLOCK_SIZE (UINT128_PACKING_HEADER_SIZE + 16 * 128)
+
+/// Blocks
+
+/* Returns the number of bits taken by every packed difference of the n values (at most a block of them),
+ * which is even */
+unsigned uint128_pack_width(const uint128_t * const values, const size_t n);
+
+/* Returns the number of bytes taken by a block packed with the number of bits, whatever the number of its values */
+size_t uint128_pack_block_size(const unsigned width);
+
+/* Packs from 1 to UINT128_PACKING_BLOCK_VALUES values into a block and returns the number of bytes it takes */
+size_t uint128_pack_block(const uint128_t * const values, const size_t n, unsigned char * const bytes);
+
+/* Unpacks the block from the first of length bytes into values (which must have room for all of them)
+ * and returns the number of values, or 0 if the bytes end in the middle of it or its header is invalid */
+size_t uint128_unpack_block(const unsigned char * const bytes, const size_t length, uint128_t * const values);
+
+/* Returns the index-th value of a valid block without unpacking the others, index must be less than the number
+ * of the block's values */
+uint128_t uint128_unpack_block_value(const unsigned char * const bytes, const size_t index);
+
+/// Arrays of blocks
+
+/* Returns the number of bytes taken by the n values packed into blocks */
+size_t uint128_pack_size(const uint128_t * const values, const size_t n);
+
+/* Packs the n values into blocks one after another and returns the number of bytes they take, all blocks except for
+ * the last one have UINT128_PACKING_BLOCK_VALUES values. The bytes must have room for uint128_pack_size bytes */
+size_t uint128_pack_array(const uint128_t * const values, const size_t n, unsigned char * const bytes);
+
+/* Stores the offsets of the first blocks from the start of length bytes into offsets by reading their headers,
+ * and returns the number of bytes they take, or 0 if the bytes end in the middle of one of them
+ * or any header is invalid. The block with the value i of the array is the block i / UINT128_PACKING_BLOCK_VALUES */
+size_t uint128_pack_index(const unsigned char * const bytes, const size_t length, size_t * const offsets,
+						  const size_t blocks);
+
+/* Unpacks n values from the blocks in length bytes into values and returns the number of bytes they took, or 0 if
+ * they can't be unpacked (then the values are unspecified) */
+size_t uint128_unpack_array(const unsigned char * const bytes, const size_t length, uint128_t * const values,
+							const size_t n);
+
+#endif //CREN_INTEGERS_UINT128_PACKING_H
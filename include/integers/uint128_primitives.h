@@ -0,0 +1,489 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_PRIMITIVES_H
+#define CREN_INTEGERS_UINT128_PRIMITIVES_H
+
+/***** uint128_primitives.h *****
+ * Definitions of the trivial uint128 operations, which are either compiled as normal functions in uint128.c,
+ * or, if CREN_INTEGERS_INLINE is defined, included into uint128.h as static inline functions, so that each
+ * of them compiles down to a couple of instructions at the call site instead of a call.
+ * Don't include this header directly, include uint128.h instead.
+ **/
+
+#include <string.h>
+#include "integers/uint128.h"
+
+/// Creation
+
+CREN_INTS_PRIMITIVE uint128_t uint128_create(const uint64_t hi, const uint64_t lo) {
+#if COMPILER_INT128_AVAILABLE
+	return ((uint128_t)(hi) << 64) + lo;
+#else
+	return (uint128_t){.hi = hi, .lo = lo};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_value(const uint64_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return (uint128_t)(a);
+#else
+	return (uint128_t){.hi = 0, .lo = a};
+#endif
+}
+
+/// Conversion functions
+
+CREN_INTS_PRIMITIVE uint64_t uint128_get_lower(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return (uint64_t)(a);
+#else
+	return a.lo;
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint64_t uint128_get_higher(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return (uint64_t)(a >> 64);
+#else
+	return a.hi;
+#endif
+}
+
+/// Byte order
+// The machine's own order is just a copy, the other one reverses the bytes of both halves and swaps them
+
+static inline uint64_t i_uint128_byte_swap_uint64(const uint64_t a) {
+#if defined(__GNUC__)
+	return __builtin_bswap64(a);
+#else
+	return (a >> 56) | (a >> 40 & 0xff00) | (a >> 24 & 0xff0000) | (a >> 8 & 0xff000000) |
+		   (a << 8 & 0xff00000000ull) | (a << 24 & 0xff0000000000ull) | (a << 40 & 0xff000000000000ull) | (a << 56);
+#endif
+}
+
+static inline uint128_t i_uint128_byte_swap(const uint128_t a) {
+	return uint128_create(i_uint128_byte_swap_uint64(uint128_get_lower(a)),
+						  i_uint128_byte_swap_uint64(uint128_get_higher(a)));
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_load_le(const void * const bytes) {
+	uint128_t a;
+	memcpy(&a, bytes, sizeof(a));
+#if ENDIANNESS == CREN_INTS_LITTLE_ENDIAN
+	return a;
+#else
+	return i_uint128_byte_swap(a);
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_load_be(const void * const bytes) {
+	uint128_t a;
+	memcpy(&a, bytes, sizeof(a));
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	return a;
+#else
+	return i_uint128_byte_swap(a);
+#endif
+}
+
+CREN_INTS_PRIMITIVE void uint128_store_le(void * const bytes, const uint128_t a) {
+#if ENDIANNESS == CREN_INTS_LITTLE_ENDIAN
+	memcpy(bytes, &a, sizeof(a));
+#else
+	const uint128_t swapped = i_uint128_byte_swap(a);
+	memcpy(bytes, &swapped, sizeof(swapped));
+#endif
+}
+
+CREN_INTS_PRIMITIVE void uint128_store_be(void * const bytes, const uint128_t a) {
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	memcpy(bytes, &a, sizeof(a));
+#else
+	const uint128_t swapped = i_uint128_byte_swap(a);
+	memcpy(bytes, &swapped, sizeof(swapped));
+#endif
+}
+
+/// Bitwise operations
+
+CREN_INTS_PRIMITIVE uint128_t uint128_shift_left(const uint128_t a, const unsigned int shift) {
+#if COMPILER_INT128_AVAILABLE
+	return (a << shift);
+#else
+	return (shift < 64) ?
+		   		// Set hi to the shift of hi and the value of the left part that has shifted
+		   		// If the shift is 0, 64-shift wouldn't do anything, which is why we split it into two shifts
+				(uint128_t){.hi = (a.hi << shift) | ((a.lo >> 1) >> (63 - shift)), .lo = a.lo << shift} :
+				// If we have shifted more than 64 bits to the left, then only the lower bits will be left,
+				// and if we shift 128+, then the number will just be a zero
+		   		(shift < 128) ? (uint128_t){.hi = a.lo << (shift - 64), .lo = 0} : (uint128_t){.hi = 0, .lo = 0};
+#endif
+}
+
+
+CREN_INTS_PRIMITIVE uint128_t uint128_shift_right(const uint128_t a, const unsigned int shift) {
+#if COMPILER_INT128_AVAILABLE
+	return (a >> shift);
+#else
+	// Like with left shift but reversed
+	return (shift < 64) ?
+		   (uint128_t){.hi = a.hi >> shift, .lo = (a.lo >> shift) | ((a.hi << 1) << (63 - shift))} :
+		   (shift < 128) ? (uint128_t){.hi = 0,  .lo = a.hi >> (shift - 64)} : (uint128_t){.hi = 0, .lo = 0};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_or(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a | b;
+#else
+	return (uint128_t){.hi = a.hi | b.hi, .lo = a.lo | b.lo};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_or_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a | b;
+#else
+	return (uint128_t){.hi = a.hi, .lo = a.lo | b};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_xor(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a ^ b;
+#else
+	return (uint128_t){.hi = a.hi ^ b.hi, .lo = a.lo ^ b.lo};
+#endif
+}
+
+/* Bitwise xor of an 128-bit uint with a 64-bit uint */
+CREN_INTS_PRIMITIVE uint128_t uint128_xor_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a ^ b;
+#else
+	return (uint128_t){.hi = a.hi, .lo = a.lo ^ b};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_and(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a & b;
+#else
+	return (uint128_t){.hi = a.hi & b.hi, .lo = a.lo & b.lo};
+#endif
+}
+
+/* Bitwise xor of an 128-bit uint with a 64-bit uint */
+CREN_INTS_PRIMITIVE uint128_t uint128_and_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a & b;
+#else
+	return (uint128_t){.hi = a.hi, .lo = a.lo & b};
+#endif
+}
+
+/// Comparison
+
+CREN_INTS_PRIMITIVE int uint128_equ(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a == b;
+#else
+	return a.hi == b.hi && a.lo == b.lo;
+#endif
+}
+
+CREN_INTS_PRIMITIVE int uint128_lt(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a < b;
+#else
+	return (a.hi < b.hi) || ((a.hi == b.hi) && (a.lo < b.lo));
+#endif
+}
+
+CREN_INTS_PRIMITIVE int uint128_lte(const uint128_t a, const uint128_t b) {
+	return !uint128_lt(b, a);
+}
+
+CREN_INTS_PRIMITIVE int uint128_gt(const uint128_t a, const uint128_t b) {
+	return uint128_lt(b, a);
+}
+
+CREN_INTS_PRIMITIVE int uint128_gte(const uint128_t a, const uint128_t b) {
+	return !uint128_lt(a, b);
+}
+
+/* Struct defining a result of an operation along with a carry "bit" which resulted from that operation */
+typedef struct uint64_with_carry {
+	const uint64_t value;
+	const int carry;
+} uint64_with_carry;
+
+/// Addition
+
+/* Adds two uint64's and adds the previous carry, as well as calculates the new carry */
+CREN_INTS_PRIMITIVE uint64_with_carry uint64_add_with_carry(const uint64_t a, const uint64_t b, const int carry) {
+	const uint64_t result_without_carry = a + b;
+	// Find out if the first addition resulted in a carry
+	const int new_carry1 = result_without_carry < a;
+	const uint64_t result = result_without_carry + carry;
+	// Find out if adding the previous carry has resulted in a carry
+	const int new_carry2 = result < result_without_carry;
+	return (uint64_with_carry){.value = result, .carry = new_carry1 | new_carry2};
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_add(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a + b;
+#else
+	uint64_with_carry lo = uint64_add_with_carry(a.lo, b.lo, 0);
+	uint64_with_carry hi = uint64_add_with_carry(a.hi, b.hi, lo.carry);
+	return (uint128_t){.hi = hi.value, .lo = lo.value};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_add_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a + b;
+#else
+	uint64_with_carry lo = uint64_add_with_carry(a.lo, b, 0);
+	// in order to not have to call the carry add function again, we can simply add the carry from the previous result,
+	// since b doesn't have bits higher than the 64'th
+	return (uint128_t){.hi = a.hi + lo.carry, .lo = lo.value};
+#endif
+}
+
+/// Subtraction
+
+/* Subtracts two uint64's and subs the previous carry, as well as calculates the new carry */
+CREN_INTS_PRIMITIVE uint64_with_carry uint64_sub_with_carry(const uint64_t a, const uint64_t b, const int carry) {
+	const uint64_t result_without_carry = a - b;
+	// Find out if the first subtraction resulted in a carry
+	const int new_carry1 = result_without_carry > a;
+	const uint64_t result = result_without_carry - carry;
+	// Find out if the second addition resulted in a carry
+	const int new_carry2 = result > result_without_carry;
+	return (uint64_with_carry){.value = result, .carry = new_carry1 | new_carry2};
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_subtract(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a - b;
+#else
+	uint64_with_carry lo = uint64_sub_with_carry(a.lo, b.lo, 0);
+	uint64_with_carry hi = uint64_sub_with_carry(a.hi, b.hi, lo.carry);
+	return (uint128_t){.hi = hi.value, .lo = lo.value};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_subtract_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a - b;
+#else
+	uint64_with_carry lo = uint64_sub_with_carry(a.lo, b, 0);
+	// in order to not have to call the carry sub function again, we can simply sub the carry from the previous result,
+	// since b doesn't have bits higher than the 64'th
+	return (uint128_t){.hi = a.hi - lo.carry, .lo = lo.value};
+#endif
+}
+
+/// Multiplication
+
+/* full multiplication of two 64-bit uints into a 128-bit uint */
+CREN_INTS_PRIMITIVE uint128_t uint64_multiply(const uint64_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return ((uint128_t)a) * b;
+#else
+	const uint64_t a_lo = a & 0xffffffff;
+	const uint64_t a_hi = a >> 32;
+	const uint64_t b_lo = b & 0xffffffff;
+	const uint64_t b_hi = b >> 32;
+
+	// Multiply the different parts of the 64 bit numbers in order to correctly identify carry's
+	const uint64_t part0 = a_lo * b_lo;
+	const uint64_t part1 = a_hi * b_lo;
+	const uint64_t part2 = a_lo * b_hi;
+	const uint64_t part3 = a_hi * b_hi;
+
+	// Identify what will carry over into the upper bits of the 128-bit integer
+	const uint64_t lower_parts_carry = part1 + (part0 >> 32);
+	// This will also tell us what has carried into the upper 32 bits of the lower 64 bits of the 128-bit integer
+	const uint64_t upper_parts_carry = part2 + (lower_parts_carry & 0xffffffff);
+
+	// combine all the results into lower and higher bits
+	const uint64_t result_lo = (upper_parts_carry << 32) | (part0 & 0xffffffff);
+	const uint64_t result_hi = part3 + (upper_parts_carry >> 32) + (lower_parts_carry >> 32);
+
+	return (uint128_t){.hi = result_hi, .lo = result_lo};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply(const uint128_t a, const uint128_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a * b;
+#else
+	// Multiply the lower bits properly, and then simply multiply the parts that can be in our higher bits
+	uint128_t lo_multiplication_result = uint64_multiply(a.lo, b.lo);
+	uint128_t result = {.hi = lo_multiplication_result.hi + (a.lo * b.hi) + (a.hi * b.lo),
+					   	  .lo = lo_multiplication_result.lo};
+	return result;
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply_uint64(const uint128_t a, const uint64_t b) {
+#if COMPILER_INT128_AVAILABLE
+	return a * (uint128_t)(b);
+#else
+	// Multiply the lower bits properly, and then simply multiply the parts that can be in our higher bits
+	uint128_t lo_multiplication_result = uint64_multiply(a.lo, b);
+	uint128_t result = {.hi = lo_multiplication_result.hi + (a.hi * b),
+		.lo = lo_multiplication_result.lo};
+	return result;
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_multiply_full_result uint128_multiply_full(const uint128_t a, const uint128_t b) {
+	// Schoolbook multiplication of the 64-bit halves, which takes exactly 4 hardware multiplications
+#if COMPILER_INT128_AVAILABLE
+	const uint64_t a_lo = (uint64_t)a, a_hi = (uint64_t)(a >> 64);
+	const uint64_t b_lo = (uint64_t)b, b_hi = (uint64_t)(b >> 64);
+	const uint128_t lo_lo = (uint128_t)a_lo * b_lo;
+	const uint128_t lo_hi = (uint128_t)a_lo * b_hi;
+	const uint128_t hi_lo = (uint128_t)a_hi * b_lo;
+	const uint128_t hi_hi = (uint128_t)a_hi * b_hi;
+
+	// the sum of the middle 64-bit parts can't overflow, since it is at most 3 * (2^64 - 1)
+	const uint128_t middle = (lo_lo >> 64) + (uint64_t)lo_hi + (uint64_t)hi_lo;
+	return (uint128_multiply_full_result){
+		.hi = hi_hi + (lo_hi >> 64) + (hi_lo >> 64) + (middle >> 64),
+		.lo = (middle << 64) | (uint64_t)lo_lo
+	};
+#else
+	const uint128_t lo_lo = uint64_multiply(a.lo, b.lo);
+	const uint128_t lo_hi = uint64_multiply(a.lo, b.hi);
+	const uint128_t hi_lo = uint64_multiply(a.hi, b.lo);
+	const uint128_t hi_hi = uint64_multiply(a.hi, b.hi);
+
+	// bits 64-127 of the product and their carries into the higher half
+	const uint64_with_carry middle1 = uint64_add_with_carry(lo_lo.hi, lo_hi.lo, 0);
+	const uint64_with_carry middle2 = uint64_add_with_carry(middle1.value, hi_lo.lo, 0);
+
+	// bits 128-191, with the carries from all the additions going into bits 192-255
+	const uint64_with_carry higher1 = uint64_add_with_carry(hi_hi.lo, lo_hi.hi, middle1.carry);
+	const uint64_with_carry higher2 = uint64_add_with_carry(higher1.value, hi_lo.hi, middle2.carry);
+	return (uint128_multiply_full_result){
+		.hi = {.hi = hi_hi.hi + higher1.carry + higher2.carry, .lo = higher2.value},
+		.lo = {.hi = middle2.value, .lo = lo_lo.lo}
+	};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_multiply_high(const uint128_t a, const uint128_t b) {
+	return uint128_multiply_full(a, b).hi;
+}
+
+/// Increment, decrement
+
+CREN_INTS_PRIMITIVE uint128_t uint128_increment(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return a + 1;
+#else
+	const uint64_t new_lo = a.lo + 1;
+	const unsigned int carry = new_lo < a.lo;
+	return (uint128_t){.hi = a.hi + carry, .lo = new_lo};
+#endif
+}
+
+CREN_INTS_PRIMITIVE uint128_t uint128_decrement(const uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return a - 1;
+#else
+	const uint64_t new_lo = a.lo - 1;
+	const unsigned int carry = new_lo > a.lo;
+	return (uint128_t){.hi = a.hi - carry, .lo = new_lo};
+#endif
+}
+
+/// Exact division
+
+CREN_INTS_PRIMITIVE uint128_t uint128_divexact_by(const uint128_t a, const uint128_exact_divisor_t * const divisor) {
+	// the even part of the divisor only shifts out zeroes, and the odd part is undone by multiplying by its inverse
+	return uint128_multiply(uint128_shift_right(a, divisor->shift), divisor->inverse);
+}
+
+CREN_INTS_PRIMITIVE int uint128_is_divisible_by(const uint128_t a, const uint128_exact_divisor_t * const divisor) {
+	// Multiplying by the inverse maps the multiples of the odd part exactly onto 0..limit (Granlund-Montgomery).
+	// The lower bits which must be 0 for the even part get rotated to the top, where they make the value too large
+	const uint128_t product = uint128_multiply(a, divisor->inverse);
+	const uint128_t rotated = uint128_or(uint128_shift_right(product, divisor->shift),
+										 uint128_shift_left(product, (128 - divisor->shift) & 127));
+	return uint128_lte(rotated, divisor->limit);
+}
+
+/// Out-parameter variants
+
+CREN_INTS_PRIMITIVE void uint128_add_to(uint128_t * const dst, const uint128_t a, const uint128_t b) {
+	*dst = uint128_add(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_add_assign(uint128_t * const acc, const uint128_t b) {
+	*acc = uint128_add(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_add_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b) {
+	*dst = uint128_add_uint64(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_add_uint64_assign(uint128_t * const acc, const uint64_t b) {
+	*acc = uint128_add_uint64(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_subtract_to(uint128_t * const dst, const uint128_t a, const uint128_t b) {
+	*dst = uint128_subtract(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_subtract_assign(uint128_t * const acc, const uint128_t b) {
+	*acc = uint128_subtract(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_subtract_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b) {
+	*dst = uint128_subtract_uint64(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_subtract_uint64_assign(uint128_t * const acc, const uint64_t b) {
+	*acc = uint128_subtract_uint64(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_multiply_to(uint128_t * const dst, const uint128_t a, const uint128_t b) {
+	*dst = uint128_multiply(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_multiply_assign(uint128_t * const acc, const uint128_t b) {
+	*acc = uint128_multiply(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_multiply_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b) {
+	*dst = uint128_multiply_uint64(a, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_multiply_uint64_assign(uint128_t * const acc, const uint64_t b) {
+	*acc = uint128_multiply_uint64(*acc, b);
+}
+
+CREN_INTS_PRIMITIVE void uint128_shift_left_to(uint128_t * const dst, const uint128_t a, const unsigned int shift) {
+	*dst = uint128_shift_left(a, shift);
+}
+
+CREN_INTS_PRIMITIVE void uint128_shift_left_assign(uint128_t * const acc, const unsigned int shift) {
+	*acc = uint128_shift_left(*acc, shift);
+}
+
+CREN_INTS_PRIMITIVE void uint128_shift_right_to(uint128_t * const dst, const uint128_t a, const unsigned int shift) {
+	*dst = uint128_shift_right(a, shift);
+}
+
+CREN_INTS_PRIMITIVE void uint128_shift_right_assign(uint128_t * const acc, const unsigned int shift) {
+	*acc = uint128_shift_right(*acc, shift);
+}
+
+#endif //CREN_INTEGERS_UINT128_PRIMITIVES_H
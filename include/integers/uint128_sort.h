@@ -0,0 +1,31 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_SORT_H
+#define CREN_INTEGERS_UINT128_SORT_H
+
+/***** uint128_sort.h *****
+ * This header defines radix sorts of uint128 arrays in ascending order, which are much faster than qsort
+ * with a comparator for large arrays.
+ * uint128_sort is an LSD radix sort with 11-bit digits: a single pre-pass counts the digits of all keys, then
+ * every digit is scattered into a buffer of n keys and back, skipping the digits which are the same for all keys
+ * (for example, the higher bits of small IDs). It is stable, can split the work between threads, and allocates
+ * the buffer using malloc. uint128_sort_in_place is an MSD radix sort with 8-bit digits (American flag sort), which
+ * permutes the keys in place, so it doesn't need any memory. It stops splitting the keys as soon as the buckets
+ * become small, so it is often faster than a single-threaded uint128_sort for random keys, but slower for keys
+ * which share many of their higher bits.
+ * Both of them sort small arrays (and buckets) using insertion sort.
+ **/
+
+#include <stddef.h>
+#include "integers/uint128.h"
+
+/* Sorts the n keys using the LSD radix sort with the given number of threads (0 is the same as 1, at most 64
+ * are used). There are fewer threads unless every one of them gets at least 65536 keys. If the buffer can't be
+ * allocated, the keys are sorted using uint128_sort_in_place instead */
+void uint128_sort(uint128_t * const keys, const size_t n, const unsigned threads);
+
+/* Sorts the n keys in place using the MSD radix sort */
+void uint128_sort_in_place(uint128_t * const keys, const size_t n);
+
+#endif //CREN_INTEGERS_UINT128_SORT_H
@@ -0,0 +1,79 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT128_VARINT_H
+#define CREN_INTEGERS_UINT128_VARINT_H
+
+/***** uint128_varint.h *****
+ * This header defines two variable-length encodings of 128-bit uints, which take fewer bytes for smaller values.
+ * LEB128 - 7 bits per byte starting from the lowest ones, the highest bit of every byte except for the last one is
+ * 			set, so a value takes from 1 to UINT128_LEB128_MAX_SIZE bytes. Both encoding and decoding are branchless
+ * 			for all lengths: the end of the value is found using SSE2 (or SWAR) on the highest bits of 16 bytes
+ * 			at once, and the 7-bit groups of every 8 bytes are packed together (or spread apart) in 3 steps
+ * 			of shifts and masks.
+ * Prefix varint - a byte with the number of bytes of the value (from 0 to 16, since the leading zero bytes are
+ * 				   dropped), followed by these bytes in little-endian, so a value takes from 1
+ * 				   to UINT128_PREFIX_VARINT_MAX_SIZE bytes. It is decoded by loading 16 bytes and masking
+ * 				   the ones which aren't a part of the value, so it is faster than LEB128, but a byte longer for
+ * 				   most values.
+ * The arrays of prefix varints are stored like in Stream VByte: the length bytes of all values go first, and then
+ * the bytes of all values, so the position of every value is known without waiting for the previous ones.
+ * The decoding functions may read bytes past the value (but never past the given length): LEB128 always reads
+ * 24 bytes starting at the value, so up to 23 bytes past it, and the prefix varint always reads the 16 bytes after
+ * the length byte, so up to 16 bytes past it. They are the fastest when there is that much data after the last value.
+ **/
+
+#include <stddef.h>
+#include "integers/uint128.h"
+
+// Maximum number of bytes taken by a single value in both encodings, 19 * 7 = 133 bits
+#define UINT128_LEB128_MAX_SIZE 19
+#define UINT128_PREFIX_VARINT_MAX_SIZE 17
+
+/// LEB128
+
+/* Returns the number of bytes taken by the value in LEB128 */
+size_t uint128_leb128_size(const uint128_t a);
+
+/* Encodes the value into bytes in LEB128 and returns the number of bytes it takes. The bytes must have room for
+ * UINT128_LEB128_MAX_SIZE bytes, since the ones after the value may be overwritten */
+size_t uint128_leb128_encode(const uint128_t a, unsigned char * const bytes);
+
+/* Decodes a value from the first of length bytes in LEB128 into out and returns the number of bytes it took,
+ * or 0 if the bytes end in the middle of the value, or it is longer than UINT128_LEB128_MAX_SIZE bytes or doesn't
+ * fit into 128 bits (then out isn't modified) */
+size_t uint128_leb128_decode(const unsigned char * const bytes, const size_t length, uint128_t * const out);
+
+/* Encodes the n values one after another in LEB128 and returns the number of bytes they take. The bytes must have
+ * room for UINT128_LEB128_MAX_SIZE * n bytes */
+size_t uint128_leb128_encode_array(const uint128_t * const values, const size_t n, unsigned char * const bytes);
+
+/* Decodes n values from length bytes in LEB128 into values and returns the number of bytes they took, or 0 if
+ * any of them can't be decoded (then the values are unspecified) */
+size_t uint128_leb128_decode_array(const unsigned char * const bytes, const size_t length,
+								   uint128_t * const values, const size_t n);
+
+/// Prefix varint
+
+/* Returns the number of bytes taken by the value as a prefix varint */
+size_t uint128_prefix_varint_size(const uint128_t a);
+
+/* Encodes the value into bytes as a prefix varint and returns the number of bytes it takes. The bytes must have room
+ * for UINT128_PREFIX_VARINT_MAX_SIZE bytes, since the ones after the value may be overwritten */
+size_t uint128_prefix_varint_encode(const uint128_t a, unsigned char * const bytes);
+
+/* Decodes a prefix varint from the first of length bytes into out and returns the number of bytes it took, or 0
+ * if the bytes end in the middle of the value, or its length is more than 16 (then out isn't modified) */
+size_t uint128_prefix_varint_decode(const unsigned char * const bytes, const size_t length, uint128_t * const out);
+
+/* Encodes the n values as an array of prefix varints (n length bytes followed by the bytes of the values)
+ * and returns the number of bytes it takes. The bytes must have room for UINT128_PREFIX_VARINT_MAX_SIZE * n bytes */
+size_t uint128_prefix_varint_encode_array(const uint128_t * const values, const size_t n,
+										  unsigned char * const bytes);
+
+/* Decodes an array of n prefix varints from length bytes into values and returns the number of bytes it took,
+ * or 0 if it can't be decoded (then the values are unspecified) */
+size_t uint128_prefix_varint_decode_array(const unsigned char * const bytes, const size_t length,
+										  uint128_t * const values, const size_t n);
+
+#endif //CREN_INTEGERS_UINT128_VARINT_H
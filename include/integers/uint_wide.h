@@ -0,0 +1,65 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+#ifndef CREN_INTEGERS_UINT_WIDE_H
+#define CREN_INTEGERS_UINT_WIDE_H
+
+/***** uint_wide.h *****
+ * This header defines the fixed-width unsigned 256-bit and 512-bit integers. They are stored as arrays of 64-bit limbs
+ * starting from the least significant one, and all of the widths are generated from the same definitions, so they
+ * share the carry chains and the normalized schoolbook division built on the uint128 division kernels.
+ **/
+
+#include <stddef.h>
+#include <stdint.h>
+#include "integers/uint128.h"
+
+// Buffer sizes which fit a string-representation of any value in any base, including the terminating zero
+#define UINT256_STRING_SIZE (256 + 1)
+#define UINT512_STRING_SIZE (512 + 1)
+
+/* Declares the unsigned integer type uint<bits>_t (bits must be a multiple of 64) along with its operations:
+ * uintN_value, uintN_from_uint128 - create an integer from a 64-bit or 128-bit uint
+ * uintN_to_uint128 - gets the lower 128 bits of the integer
+ * uintN_shift_left, uintN_shift_right - shift by any amount of bits, shifting by bits or more gives 0
+ * uintN_cmp - compares two integers, returning -1, 0 or 1 if the first one is less, equal or greater
+ * uintN_equ, uintN_lt, uintN_lte, uintN_gt, uintN_gte - same as the uint128 comparisons
+ * uintN_add, uintN_subtract, uintN_multiply - arithmetic modulo 2^bits
+ * uintN_divrem, uintN_divide, uintN_mod - division, the divisor must not be 0
+ * uintN_parse_n, uintN_parse - same as uint128_parse_n and uint128_parse, returning the same statuses
+ * uintN_format, uintN_to_string - same as uint128_format and uint128_to_string, the string has to fit
+ * 								   UINTN_STRING_SIZE characters */
+#define CREN_UINT_WIDE_DECLARE(bits) \
+	typedef struct uint##bits##_t { \
+		uint64_t limbs[(bits) / 64]; \
+	} uint##bits##_t; \
+	typedef struct uint##bits##_divrem_result { \
+		uint##bits##_t quotient, remainder; \
+	} uint##bits##_divrem_result; \
+	uint##bits##_t uint##bits##_value(const uint64_t a); \
+	uint##bits##_t uint##bits##_from_uint128(const uint128_t a); \
+	uint128_t uint##bits##_to_uint128(const uint##bits##_t a); \
+	uint##bits##_t uint##bits##_shift_left(const uint##bits##_t a, const unsigned int shift); \
+	uint##bits##_t uint##bits##_shift_right(const uint##bits##_t a, const unsigned int shift); \
+	int uint##bits##_cmp(const uint##bits##_t a, const uint##bits##_t b); \
+	int uint##bits##_equ(const uint##bits##_t a, const uint##bits##_t b); \
+	int uint##bits##_lt(const uint##bits##_t a, const uint##bits##_t b); \
+	int uint##bits##_lte(const uint##bits##_t a, const uint##bits##_t b); \
+	int uint##bits##_gt(const uint##bits##_t a, const uint##bits##_t b); \
+	int uint##bits##_gte(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_t uint##bits##_add(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_t uint##bits##_subtract(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_t uint##bits##_multiply(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_divrem_result uint##bits##_divrem(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_t uint##bits##_divide(const uint##bits##_t a, const uint##bits##_t b); \
+	uint##bits##_t uint##bits##_mod(const uint##bits##_t a, const uint##bits##_t b); \
+	uint128_parse_status uint##bits##_parse_n(const char *begin, const char * const end, const int base_or_auto, \
+											  uint##bits##_t * const out, const char ** stop); \
+	uint##bits##_t uint##bits##_parse(const char *string); \
+	size_t uint##bits##_format(const uint##bits##_t a, char * const string, const unsigned int base); \
+	const char * uint##bits##_to_string(const uint##bits##_t a, char * const string, const unsigned int base);
+
+CREN_UINT_WIDE_DECLARE(256)
+CREN_UINT_WIDE_DECLARE(512)
+
+#endif //CREN_INTEGERS_UINT_WIDE_H
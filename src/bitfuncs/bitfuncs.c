@@ -3,12 +3,17 @@
 // Licensed under the Apache License, Version 2.0.
 
 #include "bitfuncs/bitfuncs.h"
+#include "../cren_compiler.h"
 
-#define test_gcc(major, minor, patch) __GNUC__ > (major) || \
-              (__GNUC__ == (major) && (__GNUC_MINOR__ > (minor) || \
-                                 (__GNUC_MINOR__ == (minor) && \
-                                  __GNUC_PATCHLEVEL__ >= (patch))))
-
+// On x86-64 the 32 and 64-bit clz are dispatched at runtime using a GNU ifunc resolver, so that CPUs with LZCNT
+// use it instead of bsr and the zero check. Define CREN_BITFUNCS_NO_DISPATCH to disable this.
+// The resolvers run before AddressSanitizer and ThreadSanitizer are initialized, so they mustn't be instrumented
+// by either of them.
+#if CREN_IFUNC_AVAILABLE && !defined(__LZCNT__) && !defined(CREN_BITFUNCS_NO_DISPATCH)
+#define CREN_BITFUNCS_DISPATCH 1
+#else
+#define CREN_BITFUNCS_DISPATCH 0
+#endif
 
 #define clz_code(bits, power_of_two) \
 	uint##bits##_t n = (bits);		 \
@@ -22,6 +27,20 @@
 	} \
 	return n - x;
 
+#define ctz_code(bits, power_of_two) \
+	if (x == 0) \
+		return (bits); \
+	unsigned n = 0; \
+	for (int i = (power_of_two) - 1; i >= 0; i--) { \
+		unsigned cur = 1u << i; \
+		uint##bits##_t lower = x << cur; \
+		if (lower != 0) { \
+			n += cur; \
+			x = lower; \
+		} \
+	} \
+	return (bits) - 1 - n;
+
 unsigned uint8_clz(uint8_t x) {
 	clz_code(8, 3)
 }
@@ -30,6 +49,25 @@ unsigned uint16_clz(uint16_t x) {
 	clz_code(16, 4)
 }
 
+#if CREN_BITFUNCS_DISPATCH
+// lzcnt is defined for 0, so the zero check isn't needed
+#define dispatched_clz(bits, lzcnt_builtin, clz_builtin) \
+	__attribute__((target("lzcnt"))) static unsigned uint##bits##_clz_lzcnt(uint##bits##_t x) { \
+		return (unsigned)lzcnt_builtin(x); \
+	} \
+	static unsigned uint##bits##_clz_baseline(uint##bits##_t x) { \
+		return x != 0 ? (unsigned)clz_builtin(x) : (bits); \
+	} \
+	__attribute__((no_sanitize_address, no_sanitize_thread)) static unsigned (*uint##bits##_clz_resolve(void))(uint##bits##_t) { \
+		__builtin_cpu_init(); \
+		return __builtin_cpu_supports("lzcnt") ? uint##bits##_clz_lzcnt : uint##bits##_clz_baseline; \
+	} \
+	unsigned uint##bits##_clz(uint##bits##_t x) __attribute__((ifunc("uint" #bits "_clz_resolve")));
+#endif
+
+#if CREN_BITFUNCS_DISPATCH
+dispatched_clz(32, __builtin_ia32_lzcnt_u32, __builtin_clz)
+#else
 unsigned uint32_clz(uint32_t x) {
 #if test_gcc(3, 4, 0) || __clang_major__ > 5
 	return x != 0 ? __builtin_clz(x) : 32;
@@ -37,7 +75,11 @@ unsigned uint32_clz(uint32_t x) {
 	clz_code(32, 5)
 #endif
 }
+#endif
 
+#if CREN_BITFUNCS_DISPATCH
+dispatched_clz(64, __builtin_ia32_lzcnt_u64, __builtin_clzll)
+#else
 unsigned uint64_clz(uint64_t x) {
 #if test_gcc(3, 4, 0) || __clang_major__ > 5
 	return x != 0 ? __builtin_clzll(x) : 64;
@@ -45,3 +87,20 @@ unsigned uint64_clz(uint64_t x) {
 	clz_code(64, 6)
 #endif
 }
+#endif
+
+unsigned uint32_ctz(uint32_t x) {
+#if test_gcc(3, 4, 0) || __clang_major__ > 5
+	return x != 0 ? __builtin_ctz(x) : 32;
+#else
+	ctz_code(32, 5)
+#endif
+}
+
+unsigned uint64_ctz(uint64_t x) {
+#if test_gcc(3, 4, 0) || __clang_major__ > 5
+	return x != 0 ? __builtin_ctzll(x) : 64;
+#else
+	ctz_code(64, 6)
+#endif
+}
@@ -0,0 +1,24 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the compiler checks shared by the bitfuncs and the integers libraries.
+// It isn't part of the public interface of either of them.
+
+#ifndef CREN_COMPILER_H
+#define CREN_COMPILER_H
+
+#define test_gcc(major, minor, patch) __GNUC__ > (major) || \
+              (__GNUC__ == (major) && (__GNUC_MINOR__ > (minor) || \
+                                 (__GNUC_MINOR__ == (minor) && \
+                                  __GNUC_PATCHLEVEL__ >= (patch))))
+
+// GNU ifunc resolvers (and the target attributes of the versions they pick) are supported on x86-64 ELF targets
+// by GCC 6+ and Clang 7+, each library decides on its own whether to use them
+#if defined(__x86_64__) && defined(__ELF__) && (test_gcc(6, 0, 0) || __clang_major__ > 6)
+#define CREN_IFUNC_AVAILABLE 1
+#else
+#define CREN_IFUNC_AVAILABLE 0
+#endif
+
+#endif //CREN_COMPILER_H
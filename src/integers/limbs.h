@@ -0,0 +1,276 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the kernels working on arrays of 64-bit limbs, which are stored starting from the least
+// significant one. The fixed-width types call these with constant lengths, so they get unrolled for every width.
+// Like uint128_division.h, it's only included by the translation units compiled with CREN_INTEGERS_INLINE.
+
+#ifndef CREN_INTEGERS_LIMBS_H
+#define CREN_INTEGERS_LIMBS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "bitfuncs/bitfuncs.h"
+#include "uint128_division.h"
+
+/// Addition and subtraction
+// The result may be the same array as one of the operands in all of these
+
+/* r = a + b, all of length n, returns the carry */
+static inline uint64_t limbs_add_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b,
+								   const size_t n) {
+	int carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint64_with_carry sum = uint64_add_with_carry(a[i], b[i], carry);
+		r[i] = sum.value;
+		carry = sum.carry;
+	}
+	return (uint64_t)carry;
+}
+
+/* r = a - b, all of length n, returns the borrow */
+static inline uint64_t limbs_sub_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b,
+								   const size_t n) {
+	int borrow = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint64_with_carry difference = uint64_sub_with_carry(a[i], b[i], borrow);
+		r[i] = difference.value;
+		borrow = difference.carry;
+	}
+	return (uint64_t)borrow;
+}
+
+/* r = a + b, where a is of length n, returns the carry */
+static inline uint64_t limbs_add_1(uint64_t * const r, const uint64_t * const a, const size_t n, uint64_t b) {
+	for (size_t i = 0; i < n; i++) {
+		r[i] = a[i] + b;
+		b = r[i] < b;
+	}
+	return b;
+}
+
+/* r = a - b, where a is of length n, returns the borrow */
+static inline uint64_t limbs_sub_1(uint64_t * const r, const uint64_t * const a, const size_t n, uint64_t b) {
+	for (size_t i = 0; i < n; i++) {
+		const uint64_t limb = a[i];
+		r[i] = limb - b;
+		b = limb < b;
+	}
+	return b;
+}
+
+/// Multiplication by a single limb
+
+/* r = a * b, where a is of length n, returns the highest limb of the product */
+static inline uint64_t limbs_mul_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint128_t product = uint128_add_uint64(uint64_multiply(a[i], b), carry);
+		r[i] = uint128_get_lower(product);
+		carry = uint128_get_higher(product);
+	}
+	return carry;
+}
+
+/* r += a * b, where r and a are of length n, returns the carry limb */
+static inline uint64_t limbs_addmul_1(uint64_t * const r, const uint64_t * const a, const size_t n,
+									  const uint64_t b) {
+	uint64_t carry = 0;
+	for (size_t i = 0; i < n; i++) {
+		// (2^64 - 1)^2 + 2 * (2^64 - 1) fits into 128 bits
+		const uint128_t product = uint128_add_uint64(uint128_add_uint64(uint64_multiply(a[i], b), carry), r[i]);
+		r[i] = uint128_get_lower(product);
+		carry = uint128_get_higher(product);
+	}
+	return carry;
+}
+
+/* r -= a * b, where r and a are of length n, returns the borrow limb */
+static inline uint64_t limbs_submul_1(uint64_t * const r, const uint64_t * const a, const size_t n,
+									  const uint64_t b) {
+	uint64_t borrow = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint128_t product = uint128_add_uint64(uint64_multiply(a[i], b), borrow);
+		const uint64_t lower = uint128_get_lower(product);
+		borrow = uint128_get_higher(product) + (r[i] < lower);
+		r[i] -= lower;
+	}
+	return borrow;
+}
+
+/// Shifts and comparison
+
+/* r = a << shift, where a is of length n and 0 < shift < 64, returns the bits shifted out. r may be the same as a */
+static inline uint64_t limbs_lshift(uint64_t * const r, const uint64_t * const a, const size_t n,
+									const unsigned shift) {
+	const uint64_t out = a[n - 1] >> (64 - shift);
+	for (size_t i = n - 1; i > 0; i--)
+		r[i] = (a[i] << shift) | (a[i - 1] >> (64 - shift));
+	r[0] = a[0] << shift;
+	return out;
+}
+
+/* r = a >> shift, where a is of length n and 0 < shift < 64, returns the bits shifted out (in the highest bits).
+ * r may be the same as a */
+static inline uint64_t limbs_rshift(uint64_t * const r, const uint64_t * const a, const size_t n,
+									const unsigned shift) {
+	const uint64_t out = a[0] << (64 - shift);
+	for (size_t i = 0; i < n - 1; i++)
+		r[i] = (a[i] >> shift) | (a[i + 1] << (64 - shift));
+	r[n - 1] = a[n - 1] >> shift;
+	return out;
+}
+
+/* Compares a and b of length n, returns -1, 0 or 1 if a is less, equal or greater than b */
+static inline int limbs_cmp(const uint64_t * const a, const uint64_t * const b, const size_t n) {
+	for (size_t i = n; i-- > 0;) {
+		if (a[i] != b[i])
+			return a[i] > b[i] ? 1 : -1;
+	}
+	return 0;
+}
+
+/* Number of limbs in a without the leading zero limbs */
+static inline size_t limbs_normalized_length(const uint64_t * const a, size_t n) {
+	while (n > 0 && a[n - 1] == 0)
+		n--;
+	return n;
+}
+
+/// Division
+
+/* q = a / divisor, where a is of length n, returns the remainder. The divisor has to be normalized (its highest bit
+ * set) with the reciprocal computed by reciprocal_128_by_64, and a must be shifted left by the same amount as the
+ * divisor already, with the bits shifted out passed as the initial remainder, which must be less than the divisor.
+ * q may be the same as a */
+static inline uint64_t limbs_divrem_1_normalized(uint64_t * const q, const uint64_t * const a, const size_t n,
+												 uint64_t remainder, const uint64_t divisor,
+												 const uint64_t reciprocal) {
+	for (size_t i = n; i-- > 0;) {
+		const uint128_div_uint64_result result = divrem_uint128_by_uint64(uint128_create(remainder, a[i]),
+																		  divisor, reciprocal);
+		q[i] = result.quotient;
+		remainder = result.remainder;
+	}
+	return remainder;
+}
+
+/* Schoolbook division of np of length nn by dp of length dn (2 <= dn <= nn), which has to be normalized (the highest
+ * bit of its highest limb set), with the reciprocal of its two highest limbs computed by reciprocal_196_by_128.
+ * The quotient of length nn - dn is written to qp and its highest limb (0 or 1) is returned separately,
+ * the remainder overwrites the lower dn limbs of np. This is mpn_sbpi1_div_qr from GMP, where every quotient limb
+ * is computed using the div_3by2 kernel */
+static inline uint64_t limbs_div_qr_normalized(uint64_t *qp, uint64_t *np, const size_t nn,
+											   const uint64_t * const dp, size_t dn, const uint64_t reciprocal) {
+	np += nn;
+	const uint64_t quotient_highest = limbs_cmp(np - dn, dp, dn) >= 0;
+	if (quotient_highest)
+		limbs_sub_n(np - dn, np - dn, dp, dn);
+
+	qp += nn - dn;
+	// the two highest divisor limbs are handled by the div_3by2 kernel, so the rest of the loops are 2 limbs shorter
+	dn -= 2;
+	const uint128_t divisor = uint128_create(dp[dn + 1], dp[dn]);
+	np -= 2;
+	uint64_t n1 = np[1];
+	for (size_t i = nn - (dn + 2); i > 0; i--) {
+		np--;
+		uint64_t quotient;
+		if (n1 == dp[dn + 1] && np[1] == dp[dn]) {
+			// the quotient limb would overflow, so it can only be 2^64 - 1
+			quotient = UINT64_MAX;
+			limbs_submul_1(np - dn, dp, dn + 2, quotient);
+			n1 = np[1];
+		} else {
+			const uint196_div_uint128_result result = divrem_uint196_by_uint128(n1, np[1], np[0], divisor,
+																				  reciprocal);
+			quotient = result.quotient;
+			n1 = uint128_get_higher(result.remainder);
+			uint64_t n0 = uint128_get_lower(result.remainder);
+
+			uint64_t borrow = limbs_submul_1(np - dn, dp, dn, quotient);
+			const uint64_t borrow0 = n0 < borrow;
+			n0 -= borrow;
+			borrow = n1 < borrow0;
+			n1 -= borrow0;
+			np[0] = n0;
+			// the quotient limb was one too large
+			if (borrow != 0) {
+				n1 += dp[dn + 1] + limbs_add_n(np - dn, np - dn, dp, dn + 1);
+				quotient--;
+			}
+		}
+		*--qp = quotient;
+	}
+	np[1] = n1;
+	return quotient_highest;
+}
+
+/* Same as limbs_divrem_1_normalized, but for any divisor, which is normalized by shift bits (the divisor and the
+ * reciprocal are the ones from uint128_divisor_t), the dividend is shifted on the fly. q may be the same as a */
+static inline uint64_t limbs_divrem_1_shifted(uint64_t * const q, const uint64_t * const a, const size_t n,
+											  const uint64_t divisor, const uint64_t reciprocal, const unsigned shift) {
+	if (shift == 0)
+		return limbs_divrem_1_normalized(q, a, n, 0, divisor, reciprocal);
+
+	uint64_t remainder = a[n - 1] >> (64 - shift);
+	for (size_t i = n - 1; i > 0; i--) {
+		const uint128_div_uint64_result result = divrem_uint128_by_uint64(
+				uint128_create(remainder, (a[i] << shift) | (a[i - 1] >> (64 - shift))), divisor, reciprocal
+			);
+		q[i] = result.quotient;
+		remainder = result.remainder;
+	}
+	const uint128_div_uint64_result result = divrem_uint128_by_uint64(uint128_create(remainder, a[0] << shift),
+																	  divisor, reciprocal);
+	q[0] = result.quotient;
+	return result.remainder >> shift;
+}
+
+/* Divides a of length an by b of length bn, where an >= bn >= 1 and the highest limb of b isn't 0. The quotient
+ * of length an - bn + 1 is written to q and the remainder of length bn to r, neither of which may overlap with
+ * anything else. numerator and divisor are scratch space of an + 1 and bn limbs */
+static inline void limbs_divrem(uint64_t * const q, uint64_t * const r, const uint64_t * const a, const size_t an,
+								const uint64_t * const b, const size_t bn, uint64_t * const numerator,
+								uint64_t * const divisor) {
+	const unsigned shift = uint64_clz(b[bn - 1]);
+	if (bn == 1) {
+		const uint64_t normalized = b[0] << shift;
+		r[0] = limbs_divrem_1_shifted(q, a, an, normalized, reciprocal_128_by_64(normalized), shift);
+		return;
+	}
+
+	// the dividend gets one more limb for the bits shifted out during normalization
+	if (shift != 0) {
+		numerator[an] = limbs_lshift(numerator, a, an, shift);
+		limbs_lshift(divisor, b, bn, shift);
+	} else {
+		numerator[an] = 0;
+		memcpy(numerator, a, an * sizeof(uint64_t));
+		memcpy(divisor, b, bn * sizeof(uint64_t));
+	}
+
+	// the highest limb of the numerator is less than the highest limb of the divisor, so the highest quotient limb
+	// returned separately is always 0
+	const uint64_t reciprocal = reciprocal_196_by_128(uint128_create(divisor[bn - 1], divisor[bn - 2]));
+	limbs_div_qr_normalized(q, numerator, an + 1, divisor, bn, reciprocal);
+	if (shift != 0)
+		limbs_rshift(r, numerator, bn, shift);
+	else
+		memcpy(r, numerator, bn * sizeof(uint64_t));
+}
+
+/// Multiplication
+
+/* Schoolbook multiplication, r = a * b where r is of length an + bn and mustn't overlap with a or b */
+static inline void limbs_mul_basecase(uint64_t * const r, const uint64_t * const a, const size_t an,
+									  const uint64_t * const b, const size_t bn) {
+	r[an] = limbs_mul_1(r, a, an, b[0]);
+	for (size_t i = 1; i < bn; i++)
+		r[an + i] = limbs_addmul_1(r + i, a, an, b[i]);
+}
+
+#endif // CREN_INTEGERS_LIMBS_H
@@ -0,0 +1,191 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <string.h>
+#include <assert.h>
+#include "integers/uint128.h"
+#include "integers/natural.h"
+#include "uint128_division.h"
+#include "limbs.h"
+
+/// Addition and subtraction
+
+uint64_t natural_add_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b, const size_t n) {
+	return limbs_add_n(r, a, b, n);
+}
+
+uint64_t natural_sub_n(uint64_t * const r, const uint64_t * const a, const uint64_t * const b, const size_t n) {
+	return limbs_sub_n(r, a, b, n);
+}
+
+uint64_t natural_add_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b) {
+	return limbs_add_1(r, a, n, b);
+}
+
+uint64_t natural_sub_1(uint64_t * const r, const uint64_t * const a, const size_t n, const uint64_t b) {
+	return limbs_sub_1(r, a, n, b);
+}
+
+/// Multiplication
+
+CREN_INTS_DISPATCHED(uint64_t, natural_mul_1, (uint64_t * const r, const uint64_t * const a, const size_t n,
+					 const uint64_t b), (r, a, n, b)) {
+	return limbs_mul_1(r, a, n, b);
+}
+
+CREN_INTS_DISPATCHED(uint64_t, natural_addmul_1, (uint64_t * const r, const uint64_t * const a, const size_t n,
+					 const uint64_t b), (r, a, n, b)) {
+	return limbs_addmul_1(r, a, n, b);
+}
+
+CREN_INTS_DISPATCHED(uint64_t, natural_submul_1, (uint64_t * const r, const uint64_t * const a, const size_t n,
+					 const uint64_t b), (r, a, n, b)) {
+	return limbs_submul_1(r, a, n, b);
+}
+
+CREN_INTS_DISPATCHED(uint64_t, natural_mul_basecase, (uint64_t * const r, const uint64_t * const a, const size_t an,
+					 const uint64_t * const b, const size_t bn), (r, a, an, b, bn)) {
+	assert(an >= bn && bn >= 1);
+	limbs_mul_basecase(r, a, an, b, bn);
+	return r[an + bn - 1];
+}
+
+/* r = |a - b|, where a is of length n and b of length n or n - 1, returns 1 if a < b */
+static inline int absolute_difference(uint64_t * const r, const uint64_t * const a, const size_t n,
+									  const uint64_t * const b, const size_t bn) {
+	if (bn < n) {
+		if (a[n - 1] != 0) {
+			r[n - 1] = a[n - 1] - limbs_sub_n(r, a, b, bn);
+			return 0;
+		}
+		r[n - 1] = 0;
+	}
+	if (limbs_cmp(a, b, bn) >= 0) {
+		limbs_sub_n(r, a, b, bn);
+		return 0;
+	}
+	limbs_sub_n(r, b, a, bn);
+	return 1;
+}
+
+/* Number of scratch limbs used by mul_karatsuba for operands of length n */
+static size_t karatsuba_scratch_size(size_t n) {
+	size_t size = 0;
+	while (n >= NATURAL_KARATSUBA_THRESHOLD) {
+		n = (n + 1) / 2;
+		size += 2 * n;
+	}
+	return size;
+}
+
+/* r = a * b, where a and b are of length n and r of length 2n, using Karatsuba's algorithm. With a = a1 * B + a0 and
+ * b = b1 * B + b0, where B = 2^(64 * low), the middle part of the product a0 * b1 + a1 * b0 is computed
+ * as a0 * b0 + a1 * b1 - (a0 - a1) * (b0 - b1), so only three half-sized multiplications are needed */
+static void mul_karatsuba(uint64_t * const r, const uint64_t * const a, const uint64_t * const b, const size_t n,
+						  uint64_t * const scratch) {
+	if (n < NATURAL_KARATSUBA_THRESHOLD) {
+		natural_mul_basecase(r, a, n, b, n);
+		return;
+	}
+
+	const size_t low = (n + 1) / 2, high = n - low;
+	uint64_t * const middle = scratch;
+
+	// the differences are stored in the result for now, their product goes to the scratch space
+	const int negative = absolute_difference(r, a, low, a + low, high) ^
+						 absolute_difference(r + low, b, low, b + low, high);
+	mul_karatsuba(middle, r, r + low, low, scratch + 2 * low);
+
+	mul_karatsuba(r, a, b, low, scratch + 2 * low);
+	mul_karatsuba(r + 2 * low, a + low, b + low, high, scratch + 2 * low);
+
+	// middle = a0 * b0 + a1 * b1 -+ |a0 - a1| * |b0 - b1|, which is never negative and has one more limb in top
+	uint64_t top;
+	if (negative)
+		top = limbs_add_n(middle, middle, r, 2 * low);
+	else
+		top = -limbs_sub_n(middle, r, middle, 2 * low);
+	const uint64_t carry = limbs_add_n(middle, middle, r + 2 * low, 2 * high);
+	top += low != high ? limbs_add_1(middle + 2 * high, middle + 2 * high, 2, carry) : carry;
+
+	top += limbs_add_n(r + low, r + low, middle, 2 * low);
+	limbs_add_1(r + 3 * low, r + 3 * low, 2 * n - 3 * low, top);
+}
+
+size_t natural_mul_scratch_size(const size_t an, const size_t bn) {
+	if (bn < NATURAL_KARATSUBA_THRESHOLD)
+		return 0;
+	size_t size = karatsuba_scratch_size(bn);
+	if (an == bn)
+		return size;
+	// unbalanced products are computed by chunks of bn limbs, the last chunk may be shorter than that
+	const size_t last = an % bn;
+	if (last != 0) {
+		const size_t last_size = natural_mul_scratch_size(bn, last);
+		if (last_size > size)
+			size = last_size;
+	}
+	return 2 * bn + size;
+}
+
+uint64_t natural_mul(uint64_t * const r, const uint64_t * const a, const size_t an, const uint64_t * const b,
+					 const size_t bn, uint64_t * const scratch) {
+	assert(an >= bn && bn >= 1);
+	if (bn < NATURAL_KARATSUBA_THRESHOLD)
+		return natural_mul_basecase(r, a, an, b, bn);
+
+	if (an == bn) {
+		mul_karatsuba(r, a, b, bn, scratch);
+		return r[2 * bn - 1];
+	}
+
+	// a is split into chunks of bn limbs, and the product of every chunk with b is added to the result
+	uint64_t * const product = scratch;
+	mul_karatsuba(r, a, b, bn, scratch + 2 * bn);
+	for (size_t offset = bn; offset < an; offset += bn) {
+		const size_t length = an - offset < bn ? an - offset : bn;
+		if (length == bn)
+			mul_karatsuba(product, a + offset, b, bn, scratch + 2 * bn);
+		else
+			natural_mul(product, b, bn, a + offset, length, scratch + 2 * bn);
+
+		// the upper bn limbs of the previous product overlap with the lower bn limbs of this one
+		const uint64_t carry = limbs_add_n(r + offset, r + offset, product, bn);
+		memcpy(r + offset + bn, product + bn, length * sizeof(uint64_t));
+		limbs_add_1(r + offset + bn, r + offset + bn, length, carry);
+	}
+	return r[an + bn - 1];
+}
+
+/// Division
+
+CREN_INTS_DISPATCHED(uint64_t, natural_divrem_1, (uint64_t * const q, const uint64_t * const a, const size_t n,
+					 const uint128_divisor_t * const divisor), (q, a, n, divisor)) {
+	assert(gethi(divisor->divisor) == 0);	// the divisor has to fit into a single limb
+	return limbs_divrem_1_shifted(q, a, n, getlo(divisor->divisor), divisor->reciprocal, divisor->shift);
+}
+
+size_t natural_divrem_scratch_size(const size_t an, const size_t bn) {
+	// the normalized dividend with one more limb and the normalized divisor
+	return (an + 1) + bn;
+}
+
+CREN_INTS_DISPATCHED(uint64_t, natural_divrem, (uint64_t * const q, uint64_t * const r, const uint64_t * const a,
+					 const size_t an, const uint64_t * const b, const size_t bn, uint64_t * const scratch),
+					 (q, r, a, an, b, bn, scratch)) {
+	assert(an >= bn && bn >= 1);
+	assert(b[bn - 1] != 0);	// the divisor has to be normalized, which also rules out dividing by 0
+	limbs_divrem(q, r, a, an, b, bn, scratch, scratch + an + 1);
+	return q[an - bn];
+}
+
+/// Comparison
+
+int natural_cmp(const uint64_t * const a, const uint64_t * const b, const size_t n) {
+	return limbs_cmp(a, b, n);
+}
+
+size_t natural_normalized_length(const uint64_t * const a, const size_t n) {
+	return limbs_normalized_length(a, n);
+}
@@ -8,6 +8,19 @@
 #include "integers/uint128.h"
 #include "bitfuncs/bitfuncs.h"
 
+// In the inline mode these are already defined in the header
+#ifndef CREN_INTEGERS_INLINE
+#include "integers/uint128_primitives.h"
+#endif
+
+#include "integers/uint128_const_division.h"
+#include "uint128_division.h"
+#include "uint128_digits.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 #if COMPILER_INT128_AVAILABLE
 static uint128_t UINT128_ZERO = 0;
 static uint128_t UINT128_MAX = ((uint128_t)(0xffffffffffffffffull) << 64) | 0xffffffffffffffffull;
@@ -16,685 +29,807 @@ static uint128_t UINT128_ZERO = {.hi = 0, .lo = 0};
 static uint128_t UINT128_MAX = {.hi = 0xffffffffffffffffull, .lo = 0xffffffffffffffffull};
 #endif
 
-/// Creation, parsing
-
-uint128_t uint128_create(const uint64_t hi, const uint64_t lo) {
-#if COMPILER_INT128_AVAILABLE
-	return ((uint128_t)(hi) << 64) + lo;
-#else
-	return (uint128_t){.hi = hi, .lo = lo};
+/// Parsing
+
+// Largest powers of all bases from 2 to 36 which fit into 64 bits, indexed by base - 2
+const uint64_base_power LARGEST_BASE_POWERS[] = {
+	{63, 9223372036854775808ull}, {40, 12157665459056928801ull}, {31, 4611686018427387904ull},
+	{27, 7450580596923828125ull}, {24, 4738381338321616896ull}, {22, 3909821048582988049ull}, {21, 9223372036854775808ull},
+	{20, 12157665459056928801ull}, {19, 10000000000000000000ull}, {18, 5559917313492231481ull}, {17, 2218611106740436992ull},
+	{17, 8650415919381337933ull}, {16, 2177953337809371136ull}, {16, 6568408355712890625ull}, {15, 1152921504606846976ull},
+	{15, 2862423051509815793ull}, {15, 6746640616477458432ull}, {15, 15181127029874798299ull}, {14, 1638400000000000000ull},
+	{14, 3243919932521508681ull}, {14, 6221821273427820544ull}, {14, 11592836324538749809ull}, {13, 876488338465357824ull},
+	{13, 1490116119384765625ull}, {13, 2481152873203736576ull}, {13, 4052555153018976267ull}, {13, 6502111422497947648ull},
+	{13, 10260628712958602189ull}, {13, 15943230000000000000ull}, {12, 787662783788549761ull}, {12, 1152921504606846976ull},
+	{12, 1667889514952984961ull}, {12, 2386420683693101056ull}, {12, 3379220508056640625ull}, {12, 4738381338321616896ull}
+};
+
+// Values of all characters as digits (0-9, then a-z case-insensitively), 0xff for characters which aren't digits
+const uint8_t DIGIT_VALUES[256] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+	25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/// Decimal digit kernels
+// The decimal digits are parsed in chunks of 8 (SWAR on a 64-bit word), 16 (SSE4.1) or 32 (AVX2) digits at once,
+// and then the chunks are combined using one multiplication by 10^8/10^16 per chunk.
+
+#define SWAR_ONES 0x0101010101010101ull
+#define SWAR_HIGH_BITS 0x8080808080808080ull
+
+// The maximum value of a 128-bit uint written in decimal, used to check for overflow when there are exactly
+// INT128_DECIMAL_SIZE digits, since then comparing the strings is the same as comparing their values
+static const char UINT128_MAX_DECIMAL[] = "340282366920938463463374607431768211455";
+
+/* Loads 8 chars into a 64-bit word so that the first char is in the lowest byte */
+static uint64_t load_8_chars(const char *chars) {
+	uint64_t word;
+	memcpy(&word, chars, sizeof(word));
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	word = __builtin_bswap64(word);
 #endif
-}
-
-uint128_t uint128_value(const uint64_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return (uint128_t)(a);
+	return word;
+}
+
+/* Returns a word with the highest bit set in every byte which isn't a decimal digit */
+static uint64_t swar_non_decimal_bytes(const uint64_t word) {
+	const uint64_t low_bits = word & ~SWAR_HIGH_BITS;
+	// the high bit of low_bits + (0x80 - '0') is clear only for bytes lower than '0',
+	// and the high bit of low_bits + (0x80 - '9' - 1) is set only for bytes greater than '9'
+	return (~(low_bits + SWAR_ONES * 0x50) | (low_bits + SWAR_ONES * 0x46) | word) & SWAR_HIGH_BITS;
+}
+
+/* Counts how many decimal digits there are at the start of the string, not looking past the given length */
+static size_t decimal_digits_span(const char * const digits, const size_t length) {
+	size_t span = 0;
+#if defined(__SSE2__)
+	for (; span + 16 <= length; span += 16) {
+		const __m128i chunk = _mm_loadu_si128((const __m128i *)(digits + span));
+		const unsigned non_decimal = (unsigned)_mm_movemask_epi8(_mm_or_si128(
+				_mm_cmplt_epi8(chunk, _mm_set1_epi8('0')), _mm_cmpgt_epi8(chunk, _mm_set1_epi8('9'))));
+		if (non_decimal != 0)
+			return span + lowest_bit(non_decimal);
+	}
+#endif
+	for (; span + 8 <= length; span += 8) {
+		const uint64_t non_decimal = swar_non_decimal_bytes(load_8_chars(digits + span));
+		if (non_decimal != 0)
+			return span + lowest_bit(non_decimal) / 8;
+	}
+	while (span < length && digits[span] >= '0' && digits[span] <= '9')
+		span++;
+	return span;
+}
+
+/* Converts 8 decimal digits into their value using SWAR, the digits must already be validated */
+static uint64_t convert_8_decimal_digits(const char * const digits) {
+	uint64_t word = load_8_chars(digits) - SWAR_ONES * '0';
+	// combine neighbouring digits into 2-digit numbers, then 4-digit ones, and then the whole 8-digit number
+	word = (word * 10) + (word >> 8);
+	word = (((word & 0x000000ff000000ffull) * (100 + (1000000ull << 32))) +
+			(((word >> 16) & 0x000000ff000000ffull) * (1 + (10000ull << 32)))) >> 32;
+	return word;
+}
+
+/* Converts 16 decimal digits into their value, the digits must already be validated */
+static uint64_t convert_16_decimal_digits(const char * const digits) {
+#if defined(__SSE4_1__)
+	__m128i chunk = _mm_sub_epi8(_mm_loadu_si128((const __m128i *)digits), _mm_set1_epi8('0'));
+	// the same as in the SWAR version, but with multiply-add instructions
+	chunk = _mm_maddubs_epi16(chunk, _mm_set1_epi16(0x010a));
+	chunk = _mm_madd_epi16(chunk, _mm_set1_epi32(0x00010064));
+	chunk = _mm_packus_epi32(chunk, chunk);
+	chunk = _mm_madd_epi16(chunk, _mm_set1_epi32(0x00012710));
+	return (uint64_t)(uint32_t)_mm_cvtsi128_si32(chunk) * 100000000ull +
+		   (uint32_t)_mm_extract_epi32(chunk, 1);
 #else
-	return (uint128_t){.hi = 0, .lo = a};
+	return convert_8_decimal_digits(digits) * 100000000ull + convert_8_decimal_digits(digits + 8);
 #endif
 }
 
-/* Parse one character into a decimal number and return -1 if we fail */
-int64_t parse_decimal_digit(const char c) {
-	if (c >= '0' && c <= '9')
-		return c - '0';
-	return -1;
+#if defined(__AVX2__)
+/* Converts 32 decimal digits into two 16-digit values, the digits must already be validated */
+static void convert_32_decimal_digits(const char * const digits, uint64_t * const higher, uint64_t * const lower) {
+	__m256i chunk = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i *)digits), _mm256_set1_epi8('0'));
+	chunk = _mm256_maddubs_epi16(chunk, _mm256_set1_epi16(0x010a));
+	chunk = _mm256_madd_epi16(chunk, _mm256_set1_epi32(0x00010064));
+	chunk = _mm256_packus_epi32(chunk, chunk);
+	chunk = _mm256_madd_epi16(chunk, _mm256_set1_epi32(0x00012710));
+	// every 128-bit lane now contains its two 8-digit values in the lowest two 32-bit elements
+	*higher = (uint64_t)(uint32_t)_mm256_extract_epi32(chunk, 0) * 100000000ull +
+			  (uint32_t)_mm256_extract_epi32(chunk, 1);
+	*lower = (uint64_t)(uint32_t)_mm256_extract_epi32(chunk, 4) * 100000000ull +
+			 (uint32_t)_mm256_extract_epi32(chunk, 5);
 }
+#endif
 
-/* Iteratively parses a string of dcimal characters into a 128-bit uint
- * If the parsed value is too big returns the maximum-value-uint128
- * If the string can't be parsed as decimal returns a 0
- * !The string passed into this function must not start with zeroes, skip them first using find_first_non_zero
+/* Converts a string of decimal digits into a 128-bit uint
+ * The digits must already be validated, there must be at most INT128_DECIMAL_SIZE of them,
+ * and their value must fit into 128 bits
  */
-uint128_t parse_from_decimal(const char *string) {
-	if (string == NULL)
-		return UINT128_ZERO;
-
-	uint128_t value = UINT128_ZERO;
-	for (size_t num_digits = 0; *string; string++, num_digits++) {
-		// find out how many digits we can have at maximum, divide with round-up
-		if (num_digits + 1 > INT128_DECIMAL_SIZE)
-			return UINT128_MAX;
-
-		int64_t current_digit = parse_decimal_digit(*string);
-		if (current_digit < 0)
-			return UINT128_ZERO;
-
-		value = uint128_add_uint64(uint128_multiply_uint64(value, 10), (uint64_t)current_digit);
+static uint128_t convert_decimal_digits(const char *digits, size_t length) {
+	// up to 19 digits fit into 64 bits, so such strings are converted without 128-bit arithmetic
+	const int fits_uint64 = length <= 19;
+
+	uint64_t lower = 0;
+	// the leading digits which don't make up a whole chunk are converted one by one
+	for (const char * const head_end = digits + length % 8; digits < head_end; digits++)
+		lower = lower * 10 + (uint64_t)(*digits - '0');
+	length -= length % 8;
+
+	if (fits_uint64) {
+		for (; length >= 8; length -= 8, digits += 8)
+			lower = lower * 100000000ull + convert_8_decimal_digits(digits);
+		return uint128_value(lower);
+	}
 
-		// if the first decimal digit isn't equal to the current, then we must've overflown
-		if (((uint128_get_lower(value) % 10 +
-				 ((uint128_get_higher(value) % 10) * 6)) % 10) != (uint64_t)current_digit)
-			return UINT128_MAX;
+	uint128_t value = uint128_value(lower);
+#if defined(__AVX2__)
+	if (length == 32) {
+		uint64_t higher_chunk, lower_chunk;
+		convert_32_decimal_digits(digits, &higher_chunk, &lower_chunk);
+		value = uint128_add_uint64(uint128_multiply_uint64(value, 10000000000000000ull), higher_chunk);
+		return uint128_add_uint64(uint128_multiply_uint64(value, 10000000000000000ull), lower_chunk);
 	}
+#endif
+	for (; length >= 16; length -= 16, digits += 16)
+		value = uint128_add_uint64(uint128_multiply_uint64(value, 10000000000000000ull),
+								   convert_16_decimal_digits(digits));
+	if (length == 8)
+		value = uint128_add_uint64(uint128_multiply_uint64(value, 100000000ull), convert_8_decimal_digits(digits));
 	return value;
 }
 
-// typedef for all functions that parse one digit in some base
-typedef int64_t(*parse_digit)(const char);
+// All of the following parsing kernels parse the digits from begin until the first character which isn't a digit
+// in their base (or until end), store the position of that character in stop and return the parse status.
+// The value is only stored on success.
 
-/* Function which can parse all strings which are in a base which is a power of 2 (ex: binary, octal, hex)
- * The difference between this and all other bases is that it doesn't need to check for an overflow after
- * modifying the current iteration's integer, it only needs to check length (since all bases like these
- * will fit perfectly).
- *
- * If the parsed value is too big returns the maximum-value-uint128
- * If the string can't be parsed as hex returns a 0
- * !The string passed into this function must not start with zeroes, skip them first using find_first_non_zero
- */
-uint128_t parse_from_power_of_2(parse_digit digit_parser, uint64_t digit_bits, const char *string) {
-	if (string == NULL)
-		return UINT128_ZERO;
+/* Parses decimal digits into a 128-bit uint using the chunked decimal kernels */
+static uint128_parse_status parse_from_decimal(const char * const begin, const char * const end,
+											   uint128_t * const value, const char ** const stop) {
+	const char * const digits = skip_zeroes(begin, end);
+	const size_t length = decimal_digits_span(digits, (size_t)(end - digits));
+	*stop = digits + length;
 
-	uint128_t value = UINT128_ZERO;
-	for (size_t num_digits = 0; *string; string++, num_digits++) {
-		// find out how many digits we can have at maximum, divide with round-up
-		if (num_digits + 1 > (SIZEOF_INT128 * 8 + digit_bits - 1) / digit_bits)
-			return UINT128_MAX;
+	if (digits == begin && length == 0)
+		return UINT128_PARSE_INVALID_DIGIT;
+	if (length > INT128_DECIMAL_SIZE ||
+		(length == INT128_DECIMAL_SIZE && memcmp(digits, UINT128_MAX_DECIMAL, INT128_DECIMAL_SIZE) > 0))
+		return UINT128_PARSE_OVERFLOW;
 
-		int64_t current_digit = digit_parser(*string);
-		if (current_digit < 0)
-			return UINT128_ZERO;
+	*value = convert_decimal_digits(digits, length);
+	return UINT128_PARSE_OK;
+}
 
-		value = uint128_or_uint64(uint128_shift_left(value, digit_bits), (uint64_t)current_digit);
+/* Parses digits in a base which is a power of 2 (ex: binary, octal, hex) into a 128-bit uint
+ * The difference between this and all other bases is that it doesn't need to check for an overflow after
+ * modifying the current iteration's integer, it only needs to count the significant bits (since all bases like these
+ * will fit perfectly).
+ */
+static uint128_parse_status parse_from_power_of_2(const unsigned digit_bits, const char * const begin,
+												  const char * const end, uint128_t * const value,
+												  const char ** const stop) {
+	const unsigned base = 1u << digit_bits;
+	const char * const digits = skip_zeroes(begin, end);
+
+	uint128_t result = UINT128_ZERO;
+	unsigned significant_bits = 0;
+	const char *current = digits;
+	for (; current < end; current++) {
+		const uint8_t digit = DIGIT_VALUES[(unsigned char)*current];
+		if (digit >= base)
+			break;
+		// the first digit isn't a zero, so only its actual bits are significant
+		significant_bits += significant_bits == 0 ? 64 - uint64_clz(digit) : digit_bits;
+		// keep going after an overflow, so that stop still points to the end of the digits
+		if (significant_bits <= SIZEOF_INT128 * 8)
+			result = uint128_or_uint64(uint128_shift_left(result, digit_bits), digit);
 	}
+	*stop = current;
 
-	return value;
-}
+	if (current == begin)
+		return UINT128_PARSE_INVALID_DIGIT;
+	if (significant_bits > SIZEOF_INT128 * 8)
+		return UINT128_PARSE_OVERFLOW;
 
-/* Parse one character into a hex number and return -1 if we fail */
-int64_t parse_hex_digit(const char c) {
-	if (c >= 'a' && c <= 'f')
-		return (c - 'a') + 10;
-	if (c >= 'A' && c <= 'F')
-		return (c - 'A') + 10;
-	return parse_decimal_digit(c);
+	*value = result;
+	return UINT128_PARSE_OK;
 }
 
-uint128_t parse_from_hex(const char *string) {
-	return parse_from_power_of_2(parse_hex_digit, 4, string);
+/* Computes value * multiplier + addend, returns 1 without modifying value if the result doesn't fit into 128 bits */
+static int multiply_add_uint64_overflows(uint128_t * const value, const uint64_t multiplier, const uint64_t addend) {
+	const uint128_t higher_product = uint64_multiply(uint128_get_higher(*value), multiplier);
+	// this can't overflow, since (2^64 - 1)^2 + 2^64 - 1 < 2^128
+	const uint128_t lower_product = uint128_add_uint64(uint64_multiply(uint128_get_lower(*value), multiplier), addend);
+	const uint64_t higher = uint128_get_higher(lower_product) + uint128_get_lower(higher_product);
+	if (uint128_get_higher(higher_product) != 0 || higher < uint128_get_lower(higher_product))
+		return 1;
+	*value = uint128_create(higher, uint128_get_lower(lower_product));
+	return 0;
 }
 
-/* Parse one character into an octal number and return -1 if we fail */
-int64_t parse_octal_digit(const char c) {
-	if (c >= '0' && c <= '7')
-		return c - '0';
-	return -1;
-}
+/* Parses digits in any other base into a 128-bit uint, by converting chunks of digits which fit into 64 bits and
+ * combining them with one multiplication per chunk
+ */
+static uint128_parse_status parse_from_any_base(const unsigned base, const char * const begin,
+												const char * const end, uint128_t * const value,
+												const char ** const stop) {
+	const uint64_base_power largest_power = LARGEST_BASE_POWERS[base - 2];
+	const char *current = skip_zeroes(begin, end);
+
+	uint128_t result = UINT128_ZERO;
+	int overflow = 0;
+	for (;;) {
+		uint64_t chunk = 0, multiplier = 1;
+		unsigned chunk_digits = 0;
+		for (; chunk_digits < largest_power.digits && current < end; chunk_digits++, current++) {
+			const uint8_t digit = DIGIT_VALUES[(unsigned char)*current];
+			if (digit >= base)
+				break;
+			chunk = chunk * base + digit;
+			multiplier *= base;
+		}
+		if (chunk_digits == 0)
+			break;
+		// keep going after an overflow, so that stop still points to the end of the digits
+		if (!overflow)
+			overflow = multiply_add_uint64_overflows(&result, multiplier, chunk);
+		if (chunk_digits < largest_power.digits)
+			break;
+	}
+	*stop = current;
 
-uint128_t parse_from_octal(const char *string) {
-	return parse_from_power_of_2(parse_octal_digit, 3, string);
-}
+	if (current == begin)
+		return UINT128_PARSE_INVALID_DIGIT;
+	if (overflow)
+		return UINT128_PARSE_OVERFLOW;
 
-/* Parse one character into an binary number and return -1 if we fail */
-int64_t parse_binary_digit(const char c) {
-	if (c == '0' || c == '1')
-		return c - '0';
-	return -1;
+	*value = result;
+	return UINT128_PARSE_OK;
 }
 
-uint128_t parse_from_binary(const char *string) {
-	return parse_from_power_of_2(parse_binary_digit, 1, string);
-}
+uint128_parse_status uint128_parse_n(const char *begin, const char * const end, const int base_or_auto,
+									 uint128_t * const out, const char ** stop) {
+	const char *unused_stop;
+	unsigned base;
+	uint128_parse_status status = parse_start(&begin, end, base_or_auto, &base, &stop, &unused_stop);
+	if (status != UINT128_PARSE_OK)
+		return status;
 
-/* Function that skips characters of the supposedly number string until it finds a supposedly non-zero value */
-const char * find_first_non_zero(const char *string) {
-	if (string == NULL)
-		return NULL;
-	while(*string == '0')
-		string++;
-	return string;
+	uint128_t value;
+	if (base == 10)
+		status = parse_from_decimal(begin, end, &value, stop);
+	else if ((base & (base - 1)) == 0)
+		status = parse_from_power_of_2(uint64_clz(1) - uint64_clz(base), begin, end, &value, stop);
+	else
+		status = parse_from_any_base(base, begin, end, &value, stop);
+
+	if (status == UINT128_PARSE_OK && out != NULL)
+		*out = value;
+	return status;
 }
 
 uint128_t uint128_parse(const char *string) {
-	if (string == NULL) {
-		return_zero:
+	if (string == NULL)
 		return UINT128_ZERO;
-	}
-	const size_t string_length = strlen(string);
-	if (string_length == 0) {
-		goto return_zero;
-	}
-
-	// Determine the type of string we will be parsing
-	// hex
-	if (string_length > 2 && string[0] == '0') {
-		switch(string[1]) {
-			case 'x':
-			case 'X':
-				return parse_from_hex(find_first_non_zero(string + 2));
-			case 'o':
-			case 'O':
-				return parse_from_octal(find_first_non_zero(string + 2));
-			case 'b':
-			case 'B':
-				return parse_from_binary(find_first_non_zero(string + 2));
 
-		}
+	const char * const end = string + strlen(string);
+	const char *stop;
+	uint128_t value;
+	switch (uint128_parse_n(string, end, 0, &value, &stop)) {
+		case UINT128_PARSE_OK:
+			// the whole string has to be a number
+			return stop == end ? value : UINT128_ZERO;
+		case UINT128_PARSE_OVERFLOW:
+			return UINT128_MAX;
+		default:
+			return UINT128_ZERO;
 	}
-	// decimal
-	return parse_from_decimal(find_first_non_zero(string));
 }
 
-/// Conversion functions
+/// Division
+// The kernels themselves live in uint128_division.h, since the modular arithmetic uses them as well
 
-uint64_t uint128_get_lower(const uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return (uint64_t)(a);
-#else
-	return a.lo;
-#endif
-}
+#define small_reciprocal_for_table(divisor_top_9_bits) \
+	(uint16_t)(0x7fd00 / (0x100 | (uint8_t)(divisor_top_9_bits)))
+#define TWO_RECIPROCALS(x) \
+	small_reciprocal_for_table((x)), small_reciprocal_for_table((x) + 1)
+#define FOUR_RECIPROCALS(x) \
+	TWO_RECIPROCALS((x)), TWO_RECIPROCALS((x) + 2)
+#define EIGHT_RECIPROCALS(x) \
+	FOUR_RECIPROCALS((x)), FOUR_RECIPROCALS((x) + 4)
+#define SIXTEEN_RECIPROCALS(x) \
+	EIGHT_RECIPROCALS((x)), EIGHT_RECIPROCALS((x) + 8)
+#define THIRTYTWO_RECIPROCALS(x) \
+	SIXTEEN_RECIPROCALS((x)), SIXTEEN_RECIPROCALS((x) + 16)
+#define SIXTYFOUR_RECIPROCALS(x) \
+	THIRTYTWO_RECIPROCALS((x)), THIRTYTWO_RECIPROCALS((x) + 32)
+#define ALL_RECIPROCALS() \
+	SIXTYFOUR_RECIPROCALS(0 * 64), SIXTYFOUR_RECIPROCALS(1 * 64), SIXTYFOUR_RECIPROCALS(2 * 64), SIXTYFOUR_RECIPROCALS(3 * 64)
 
-uint64_t uint128_get_higher(const uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return (uint64_t)(a >> 64);
-#else
-	return a.hi;
-#endif
-}
+const uint16_t small_reciprocal_table[] = {ALL_RECIPROCALS()};
 
-//const char * uint128_to_string(const uint128_t a, char * const string, const unsigned int base) {
-//	if (base < 2 || base > 36)
-//		return NULL;
-//
-//	if (uint128_equ(a, UINT128_ZERO)) {
-//		string[0] = '0';
-//	} else {
-//		while (!uint128_equ(a, UINT128_ZERO)) {
-//
-//		}
-//	}
-//}
+// Use the previous funtions/algorithms for school-like division, with everything that depends only
+// on the divisor already computed
+static inline uint128_divrem_result divrem_by(const uint128_t a, const uint128_divisor_t * const divisor) {
+	const unsigned left_shift = divisor->shift;
+	// the shifts by 64 - left_shift are split in two so that they are defined even when left_shift is 0
+	const uint64_t dividend_lower = getlo(a) << left_shift;
+	const uint64_t dividend_higher = (gethi(a) << left_shift) | ((getlo(a) >> 1) >> (63 - left_shift));
+	const uint64_t dividend_extra = (gethi(a) >> 1) >> (63 - left_shift);
 
-/// Bitwise operations
+	if (gethi(divisor->divisor) == 0) {
+		const uint64_t divisor_lower = getlo(divisor->divisor);
+		const uint128_div_uint64_result result_higher = divrem_uint128_by_uint64(
+				uint128_create(dividend_extra, dividend_higher), divisor_lower, divisor->reciprocal
+			);
+		const uint128_div_uint64_result result_lower = divrem_uint128_by_uint64(
+				uint128_create(result_higher.remainder, dividend_lower), divisor_lower, divisor->reciprocal
+			);
+		return (uint128_divrem_result){.quotient = uint128_create(result_higher.quotient, result_lower.quotient),
+								 .remainder = uint128_create(0, result_lower.remainder >> left_shift)};
+	}
 
-uint128_t uint128_shift_left(const uint128_t a, const unsigned int shift) {
-#if COMPILER_INT128_AVAILABLE
-	return (a << shift);
-#else
-	return (shift < 64) ?
-		   		// Set hi to the shift of hi and the value of the left part that has shifted
-		   		// If the shift is 0, 64-shift wouldn't do anything, which is why we split it into two shifts
-				(uint128_t){.hi = (a.hi << shift) | ((a.lo >> 1) >> (63 - shift)), .lo = a.lo << shift} :
-				// If we have shifted more than 64 bits to the left, then only the lower bits will be left,
-				// and if we shift 128+, then the number will just be a zero
-		   		(shift < 128) ? (uint128_t){.hi = a.lo << (shift - 64), .lo = 0} : UINT128_ZERO;
-#endif
+	if (left_shift == 0) {
+		const unsigned quotient = uint128_gte(a, divisor->divisor);
+		return (uint128_divrem_result){.quotient = uint128_create(0, quotient),
+								 .remainder = uint128_subtract(a, quotient ? divisor->divisor : UINT128_ZERO)};
+	}
+
+	const uint196_div_uint128_result result = divrem_uint196_by_uint128(dividend_extra, dividend_higher, dividend_lower,
+			divisor->divisor, divisor->reciprocal
+		);
+
+	return (uint128_divrem_result){.quotient = uint128_create(0, result.quotient),
+								.remainder = uint128_shift_right(result.remainder, left_shift)};
 }
 
+CREN_INTS_DISPATCHED(uint128_divisor_t, uint128_divisor_init, (const uint128_t b), (b)) {
+	return divisor_init(b, 0);
+}
 
-uint128_t uint128_shift_right(const uint128_t a, const unsigned int shift) {
-#if COMPILER_INT128_AVAILABLE
-	return (a >> shift);
-#else
-	// Like with left shift but reversed
-	return (shift < 64) ?
-		   (uint128_t){.hi = a.hi >> shift, .lo = (a.lo >> shift) | ((a.hi << 1) << (63 - shift))} :
-		   (shift < 128) ? (uint128_t){.hi = 0,  .lo = a.hi >> (shift - 64)} : UINT128_ZERO;
-#endif
+CREN_INTS_DISPATCHED(uint128_divrem_result, uint128_divrem_by,
+					 (const uint128_t a, const uint128_divisor_t * const divisor), (a, divisor)) {
+	return divrem_by(a, divisor);
 }
 
-uint128_t uint128_or(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a | b;
-#else
-	return (uint128_t){.hi = a.hi | b.hi, .lo = a.lo | b.lo};
-#endif
+uint128_t uint128_div_by(const uint128_t a, const uint128_divisor_t * const divisor) {
+	return uint128_divrem_by(a, divisor).quotient;
 }
 
-uint128_t uint128_or_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a | b;
-#else
-	return (uint128_t){.hi = a.hi, .lo = a.lo | b};
-#endif
+uint128_t uint128_mod_by(const uint128_t a, const uint128_divisor_t * const divisor) {
+	return uint128_divrem_by(a, divisor).remainder;
 }
 
-uint128_t uint128_xor(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a ^ b;
-#else
-	return (uint128_t){.hi = a.hi ^ b.hi, .lo = a.lo ^ b.lo};
+/* Division by a divisor which is only used once, so computing its reciprocal is avoided where possible.
+ * The cheaper cases are tried first:
+ * the higher bits of the dividend are less than the ones of the divisor - the quotient is 0
+ * both operands fit into 64 bits - a single native 64-bit division
+ * the divisor is a power of 2 - a shift and a mask
+ * the higher bits of the dividend are less than a 64-bit divisor - the quotient fits into 64 bits,
+ * 																	 so a single 128-by-64 division is enough
+ * The rest is genuinely 128-bit, which uses the div instruction where it is available, and the reciprocal otherwise */
+static inline uint128_divrem_result divrem_tiered(const uint128_t a, const uint128_t b) {
+	// the remainder is created from the halves, since copying a after it has been spilled in halves
+	// makes the store forwarding fail
+	if (gethi(a) < gethi(b)) {
+		return (uint128_divrem_result){.quotient = uint128_create(0, 0),
+									   .remainder = uint128_create(gethi(a), getlo(a))};
+	}
+
+	if (gethi(b) == 0) {
+		const uint64_t divisor = getlo(b);
+		assert(divisor != 0);	// dividing by 0
+
+		if (gethi(a) == 0) {
+			return (uint128_divrem_result){.quotient = uint128_create(0, getlo(a) / divisor),
+										   .remainder = uint128_create(0, getlo(a) % divisor)};
+		}
+		if ((divisor & (divisor - 1)) == 0) {
+			return (uint128_divrem_result){.quotient = uint128_shift_right(a, lowest_bit(divisor)),
+										   .remainder = uint128_create(0, getlo(a) & (divisor - 1))};
+		}
+		if (gethi(a) < divisor) {
+			const uint128_div_uint64_result result = divrem_uint128_by_uint64_once(a, divisor);
+			return (uint128_divrem_result){.quotient = uint128_create(0, result.quotient),
+										   .remainder = uint128_create(0, result.remainder)};
+		}
+#if CREN_INTS_DIV_INSTRUCTION
+		// the higher bits of the quotient come from the higher bits of the dividend,
+		// and the remainder of that is less than the divisor, so the rest is a single division again
+		const uint128_div_uint64_result result = divrem_uint128_by_uint64_once(
+				uint128_create(gethi(a) % divisor, getlo(a)), divisor
+			);
+		return (uint128_divrem_result){.quotient = uint128_create(gethi(a) / divisor, result.quotient),
+									   .remainder = uint128_create(0, result.remainder)};
 #endif
+	} else {
+		if (getlo(b) == 0 && (gethi(b) & (gethi(b) - 1)) == 0) {
+			return (uint128_divrem_result){.quotient = uint128_create(0, gethi(a) >> lowest_bit(gethi(b))),
+										   .remainder = uint128_create(gethi(a) & (gethi(b) - 1), getlo(a))};
+		}
+#if CREN_INTS_DIV_INSTRUCTION
+		const unsigned shift = uint64_clz(gethi(b));
+		if (shift == 0) {
+			const unsigned quotient = uint128_gte(a, b);
+			return (uint128_divrem_result){.quotient = uint128_create(0, quotient),
+										   .remainder = uint128_subtract(a, quotient ? b : UINT128_ZERO)};
+		}
+		// The quotient fits into 64 bits, and dividing the normalized dividend by the higher bits of the normalized
+		// divisor gives it at most one too large (same as in libgcc). The rest of the divisor is multiplied back
+		// to check that
+		const uint64_t divisor_higher = (gethi(b) << shift) | (getlo(b) >> (64 - shift));
+		const uint64_t divisor_lower = getlo(b) << shift;
+		const uint128_div_uint64_result estimate = divrem_uint128_by_uint64_once(
+				uint128_create(gethi(a) >> (64 - shift), (gethi(a) << shift) | (getlo(a) >> (64 - shift))),
+				divisor_higher
+			);
+		uint64_t quotient = estimate.quotient;
+		uint128_t remainder = uint128_create(estimate.remainder, getlo(a) << shift);
+		const uint128_t product = uint64_multiply(quotient, divisor_lower);
+		if (uint128_gt(product, remainder)) {
+			quotient--;
+			remainder = uint128_add(remainder, uint128_create(divisor_higher, divisor_lower));
+		}
+		return (uint128_divrem_result){.quotient = uint128_create(0, quotient),
+									   .remainder = uint128_shift_right(uint128_subtract(remainder, product), shift)};
+#endif
+	}
+
+	const uint128_divisor_t divisor = divisor_init(b, 0);
+	return divrem_by(a, &divisor);
 }
 
-/* Bitwise xor of an 128-bit uint with a 64-bit uint */
-uint128_t uint128_xor_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a ^ b;
-#else
-	return (uint128_t){.hi = a.hi, .lo = a.lo ^ b};
-#endif
+CREN_INTS_DISPATCHED(uint128_divrem_result, uint128_divrem, (const uint128_t a, const uint128_t b), (a, b)) {
+	return divrem_tiered(a, b);
 }
 
-uint128_t uint128_and(const uint128_t a, const uint128_t b) {
+uint128_t uint128_divide(const uint128_t a, const uint128_t b) {
 #if COMPILER_INT128_AVAILABLE
-	return a & b;
+	return a / b;
 #else
-	return (uint128_t){.hi = a.hi & b.hi, .lo = a.lo & b.lo};
+	return uint128_divrem(a, b).quotient;
 #endif
 }
 
-/* Bitwise xor of an 128-bit uint with a 64-bit uint */
-uint128_t uint128_and_uint64(const uint128_t a, const uint64_t b) {
+uint128_t uint128_mod(const uint128_t a, const uint128_t b) {
 #if COMPILER_INT128_AVAILABLE
-	return a & b;
+	return a % b;
 #else
-	return (uint128_t){.hi = a.hi, .lo = a.lo & b};
+	return uint128_divrem(a, b).remainder;
 #endif
 }
 
-/// Comparison
-
-int uint128_equ(const uint128_t a, const uint128_t b) {
+uint128_t uint128_divide_uint64(const uint128_t a, const uint64_t b) {
 #if COMPILER_INT128_AVAILABLE
-	return a == b;
+	return a / b;
 #else
-	return a.hi == b.hi && a.lo == b.lo;
+	return uint128_divrem(a, (uint128_t){.hi = 0, .lo = b}).quotient;
 #endif
 }
 
-int uint128_lt(const uint128_t a, const uint128_t b) {
+uint64_t uint128_mod_uint64(const uint128_t a, const uint64_t b) {
 #if COMPILER_INT128_AVAILABLE
-	return a < b;
+	return (uint64_t)(a % b);
 #else
-	return (a.hi < b.hi) || ((a.hi == b.hi) && (a.lo < b.lo));
+	return uint128_divrem(a, (uint128_t){.hi = 0, .lo = b}).remainder.lo;
 #endif
 }
 
-int uint128_lte(const uint128_t a, const uint128_t b) {
-	return !uint128_lt(b, a);
-}
+/// Out-parameter division
+// The full divisions store the halves of the result straight from the inlined kernels, the rest only wrap
+// the functions above
 
-int uint128_gt(const uint128_t a, const uint128_t b) {
-	return uint128_lt(b, a);
+CREN_INTS_DISPATCHED_VOID(uint128_divrem_to, (uint128_t * const quotient, uint128_t * const remainder,
+						  const uint128_t a, const uint128_t b), (quotient, remainder, a, b)) {
+	const uint128_divrem_result result = divrem_tiered(a, b);
+	*quotient = result.quotient;
+	*remainder = result.remainder;
 }
 
-int uint128_gte(const uint128_t a, const uint128_t b) {
-	return !uint128_lt(a, b);
+CREN_INTS_DISPATCHED_VOID(uint128_divrem_by_to, (uint128_t * const quotient, uint128_t * const remainder,
+						  const uint128_t a, const uint128_divisor_t * const divisor), (quotient, remainder, a, divisor)) {
+	const uint128_divrem_result result = divrem_by(a, divisor);
+	*quotient = result.quotient;
+	*remainder = result.remainder;
 }
 
-/* Struct defining a result of an operation along with a carry "bit" which resulted from that operation */
-typedef struct uint64_with_carry {
-	const uint64_t value;
-	const int carry;
-} uint64_with_carry;
-
-/// Addition
-
-/* Adds two uint64's and adds the previous carry, as well as calculates the new carry */
-uint64_with_carry uint64_add_with_carry(const uint64_t a, const uint64_t b, const int carry) {
-	const uint64_t result_without_carry = a + b;
-	// Find out if the first addition resulted in a carry
-	const int new_carry1 = result_without_carry < a;
-	const uint64_t result = result_without_carry + carry;
-	// Find out if adding the previous carry has resulted in a carry
-	const int new_carry2 = result < result_without_carry;
-	return (uint64_with_carry){.value = result, .carry = new_carry1 | new_carry2};
+void uint128_divide_to(uint128_t * const dst, const uint128_t a, const uint128_t b) {
+	*dst = uint128_divide(a, b);
 }
 
-uint128_t uint128_add(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a + b;
-#else
-	uint64_with_carry lo = uint64_add_with_carry(a.lo, b.lo, 0);
-	uint64_with_carry hi = uint64_add_with_carry(a.hi, b.hi, lo.carry);
-	return (uint128_t){.hi = hi.value, .lo = lo.value};
-#endif
+void uint128_divide_assign(uint128_t * const acc, const uint128_t b) {
+	*acc = uint128_divide(*acc, b);
 }
 
-uint128_t uint128_add_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a + b;
-#else
-	uint64_with_carry lo = uint64_add_with_carry(a.lo, b, 0);
-	// in order to not have to call the carry add function again, we can simply add the carry from the previous result,
-	// since b doesn't have bits higher than the 64'th
-	return (uint128_t){.hi = a.hi + lo.carry, .lo = lo.value};
-#endif
+void uint128_mod_to(uint128_t * const dst, const uint128_t a, const uint128_t b) {
+	*dst = uint128_mod(a, b);
 }
 
-/// Subtraction
-
-/* Subtracts two uint64's and subs the previous carry, as well as calculates the new carry */
-uint64_with_carry uint64_sub_with_carry(const uint64_t a, const uint64_t b, const int carry) {
-	const uint64_t result_without_carry = a - b;
-	// Find out if the first subtraction resulted in a carry
-	const int new_carry1 = result_without_carry > a;
-	const uint64_t result = result_without_carry - carry;
-	// Find out if the second addition resulted in a carry
-	const int new_carry2 = result > result_without_carry;
-	return (uint64_with_carry){.value = result, .carry = new_carry1 | new_carry2};
+void uint128_mod_assign(uint128_t * const acc, const uint128_t b) {
+	*acc = uint128_mod(*acc, b);
 }
 
-uint128_t uint128_subtract(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a - b;
-#else
-	uint64_with_carry lo = uint64_sub_with_carry(a.lo, b.lo, 0);
-	uint64_with_carry hi = uint64_sub_with_carry(a.hi, b.hi, lo.carry);
-	return (uint128_t){.hi = hi.value, .lo = lo.value};
-#endif
+void uint128_divide_uint64_to(uint128_t * const dst, const uint128_t a, const uint64_t b) {
+	*dst = uint128_divide_uint64(a, b);
 }
 
-uint128_t uint128_subtract_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a - b;
-#else
-	uint64_with_carry lo = uint64_sub_with_carry(a.lo, b, 0);
-	// in order to not have to call the carry sub function again, we can simply sub the carry from the previous result,
-	// since b doesn't have bits higher than the 64'th
-	return (uint128_t){.hi = a.hi - lo.carry, .lo = lo.value};
-#endif
+void uint128_divide_uint64_assign(uint128_t * const acc, const uint64_t b) {
+	*acc = uint128_divide_uint64(*acc, b);
 }
 
-/// Multiplication
-
-/* full multiplication of two 64-bit uints into a 128-bit uint */
-uint128_t uint64_multiply(const uint64_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return ((uint128_t)a) * b;
-#else
-	const uint64_t a_lo = a & 0xffffffff;
-	const uint64_t a_hi = a >> 32;
-	const uint64_t b_lo = b & 0xffffffff;
-	const uint64_t b_hi = b >> 32;
-
-	// Multiply the different parts of the 64 bit numbers in order to correctly identify carry's
-	const uint64_t part0 = a_lo * b_lo;
-	const uint64_t part1 = a_hi * b_lo;
-	const uint64_t part2 = a_lo * b_hi;
-	const uint64_t part3 = a_hi * b_hi;
-
-	// Identify what will carry over into the upper bits of the 128-bit integer
-	const uint64_t lower_parts_carry = part1 + (part0 >> 32);
-	// This will also tell us what has carried into the upper 32 bits of the lower 64 bits of the 128-bit integer
-	const uint64_t upper_parts_carry = part2 + (lower_parts_carry & 0xffffffff);
-
-	// combine all the results into lower and higher bits
-	const uint64_t result_lo = (upper_parts_carry << 32) | (part0 & 0xffffffff);
-	const uint64_t result_hi = part3 + (upper_parts_carry >> 32) + (lower_parts_carry >> 32);
-
-	return (uint128_t){.hi = result_hi, .lo = result_lo};
-#endif
+void uint128_div_by_to(uint128_t * const dst, const uint128_t a, const uint128_divisor_t * const divisor) {
+	*dst = uint128_div_by(a, divisor);
 }
 
-uint128_t uint128_multiply(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a * b;
-#else
-	// Multiply the lower bits properly, and then simply multiply the parts that can be in our higher bits
-	uint128_t lo_multiplication_result = uint64_multiply(a.lo, b.lo);
-	uint128_t result = {.hi = lo_multiplication_result.hi + (a.lo * b.hi) + (a.hi * b.lo),
-					   	  .lo = lo_multiplication_result.lo};
-	return result;
-#endif
+void uint128_div_by_assign(uint128_t * const acc, const uint128_divisor_t * const divisor) {
+	*acc = uint128_div_by(*acc, divisor);
 }
 
-uint128_t uint128_multiply_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a * (uint128_t)(b);
-#else
-	// Multiply the lower bits properly, and then simply multiply the parts that can be in our higher bits
-	uint128_t lo_multiplication_result = uint64_multiply(a.lo, b);
-	uint128_t result = {.hi = lo_multiplication_result.hi + (a.hi * b),
-		.lo = lo_multiplication_result.lo};
-	return result;
-#endif
+void uint128_mod_by_to(uint128_t * const dst, const uint128_t a, const uint128_divisor_t * const divisor) {
+	*dst = uint128_mod_by(a, divisor);
 }
 
-/// Division
-// The division algorithm here is the optimized division by reciprocal, given in gmplib.org/~tege/division-paper.pdf
-// (Improved division by invariant integers)
-
-#define small_reciprocal_for_table(divisor_top_9_bits) \
-	(uint16_t)(0x7fd00 / (0x100 | (uint8_t)(divisor_top_9_bits)))
-#define TWO_RECIPROCALS(x) \
-	small_reciprocal_for_table((x)), small_reciprocal_for_table((x) + 1)
-#define FOUR_RECIPROCALS(x) \
-	TWO_RECIPROCALS((x)), TWO_RECIPROCALS((x) + 2)
-#define EIGHT_RECIPROCALS(x) \
-	FOUR_RECIPROCALS((x)), FOUR_RECIPROCALS((x) + 4)
-#define SIXTEEN_RECIPROCALS(x) \
-	EIGHT_RECIPROCALS((x)), EIGHT_RECIPROCALS((x) + 8)
-#define THIRTYTWO_RECIPROCALS(x) \
-	SIXTEEN_RECIPROCALS((x)), SIXTEEN_RECIPROCALS((x) + 16)
-#define SIXTYFOUR_RECIPROCALS(x) \
-	THIRTYTWO_RECIPROCALS((x)), THIRTYTWO_RECIPROCALS((x) + 32)
-#define ALL_RECIPROCALS() \
-	SIXTYFOUR_RECIPROCALS(0 * 64), SIXTYFOUR_RECIPROCALS(1 * 64), SIXTYFOUR_RECIPROCALS(2 * 64), SIXTYFOUR_RECIPROCALS(3 * 64)
-
-const uint16_t small_reciprocal_table[] = {ALL_RECIPROCALS()};
-
-// Helper defines here since we need these a lot in this part, because we will use this division even
-// if uint128 is present in compiler, cause this is more optimized currently
-#define gethi(a) uint128_get_higher(a)
-#define getlo(a) uint128_get_lower(a)
-
-// Reciprocal-computing algorithm based on Newton's method, described in the GMPlib paper
-uint64_t reciprocal_128_by_64(const uint64_t divisor) {
-	const uint64_t divisor_least_sig_bit = divisor & 1;
-	const uint64_t divisor_top_9_bits = divisor >> 55; // round-down
-	const uint64_t divisor_top_40_bits = (divisor >> 24) + 1; // round-down
-	const uint64_t divisor_top_63_bits = (divisor >> 1) + divisor_least_sig_bit; // round-up
-
-	const uint32_t v0 = small_reciprocal_table[divisor_top_9_bits - 256]; // table lookup of the top bits, iteration 0
-
-	const uint64_t v1 = (v0 << 11) - (uint32_t)(v0 * v0 * divisor_top_40_bits >> 40) - 1; // iteration 1
-	const uint64_t v2 = (v1 << 13) + (v1 * (0x1000000000000000ull - v1 * divisor_top_40_bits) >> 47); // iteration 2
-
-	const uint64_t e = ((v2 >> 1) & (0 - divisor_least_sig_bit)) - v2 * divisor_top_63_bits;
-	const uint64_t v3 = (gethi(uint64_multiply(v2, e)) >> 1) + (v2 << 31); // iteration 3
-	const uint64_t v4 = v3 - gethi(uint128_add_uint64(uint64_multiply(v3, divisor), divisor)) - divisor; // iteration 4
-	return v4;
-}
-
-// Reciprocal algorithm based on the previous one for computing a reciprocal of a 128-bit uint over 196 bits
-uint64_t reciprocal_196_by_128(const uint128_t divisor) {
-	uint64_t v = reciprocal_128_by_64(gethi(divisor));
-	uint64_t p = gethi(divisor) * v + getlo(divisor);
-	if (p < getlo(divisor)) {
-		v--;
-		if (p >= gethi(divisor)) {
-			v--;
-			p -= gethi(divisor);
-		}
-		p -= gethi(divisor);
-	}
-
-	const uint128_t t = uint64_multiply(v, getlo(divisor));
-	p += gethi(t);
-	if (p < gethi(t)) {
-		v--;
-		if (p >= gethi(divisor)) {
-			if (p > gethi(divisor) || getlo(t) >= getlo(divisor))
-				v--;
-		}
-	}
-	return v;
+void uint128_mod_by_assign(uint128_t * const acc, const uint128_divisor_t * const divisor) {
+	*acc = uint128_mod_by(*acc, divisor);
 }
 
-// Struct defining the result of dividing a 128-bit uint by a 64-bit uint
-typedef struct uint128_div_uint64_result {
-	uint64_t quotient, remainder;
-} uint128_div_uint64_result;
+/// Exact division
 
-// Helper functions to increment/decrement the higher 64-bit part of the 128-bit uint
-uint128_t uint128_increment_higher(uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return a + ((uint128_t)(1) << 64);
-#else
-	return (uint128_t){.hi = a.hi + 1, .lo = a.lo};
-#endif
+CREN_INTS_DISPATCHED(uint128_exact_divisor_t, uint128_exact_divisor_init, (const uint128_t b), (b)) {
+	const unsigned shift = uint128_ctz(b);
+	return (uint128_exact_divisor_t){.inverse = inverse_uint128(uint128_shift_right(b, shift)),
+									 .limit = divrem_tiered(UINT128_MAX, b).quotient,
+									 .shift = shift};
 }
 
-uint128_t uint128_decrement_higher(uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return a - ((uint128_t)(1) << 64);
-#else
-	return (uint128_t){.hi = a.hi - 1, .lo = a.lo};
-#endif
+/* Exact division of a 128-bit uint by an odd 64-bit one with its inverse modulo 2^64, limb by limb from the lowest
+ * one (same as GMP's mpn_divexact_1). The lower limb of the quotient is the lower limb of the dividend multiplied
+ * by the inverse, and the higher limb of its product with the divisor is what gets subtracted from the higher limb */
+static inline uint128_t divexact_odd_uint64(const uint128_t a, const uint64_t divisor, const uint64_t inverse) {
+	const uint64_t quotient_lower = getlo(a) * inverse;
+	const uint64_t borrow = gethi(uint64_multiply(quotient_lower, divisor));
+	return uint128_create((gethi(a) - borrow) * inverse, quotient_lower);
 }
 
-// Algorithm div_2by1 from the paper
-uint128_div_uint64_result divrem_uint128_by_uint64(const uint128_t a, const uint64_t divisor, const uint64_t reciprocal) {
-	uint128_t quotient_guess = uint64_multiply(reciprocal, gethi(a));
-	quotient_guess = uint128_add(quotient_guess, a);
-	quotient_guess = uint128_increment_higher(quotient_guess);
+static inline uint128_t divexact_uint64(const uint128_t a, const uint64_t b) {
+	assert(b != 0);	// dividing by 0
+	const unsigned shift = lowest_bit(b);
+	const uint64_t odd = b >> shift;
+	return divexact_odd_uint64(uint128_shift_right(a, shift), odd, inverse_uint64(odd));
+}
 
-	uint64_t remainder_guess = getlo(a) - gethi(quotient_guess) * divisor;
-	if (remainder_guess > getlo(quotient_guess)) {
-		quotient_guess = uint128_decrement_higher(quotient_guess);
-		remainder_guess += divisor;
-	}
-	if (remainder_guess >= divisor) {
-		quotient_guess = uint128_increment_higher(quotient_guess);
-		remainder_guess -= divisor;
-	}
+CREN_INTS_DISPATCHED(uint128_t, uint128_divexact_uint64, (const uint128_t a, const uint64_t b), (a, b)) {
+	return divexact_uint64(a, b);
+}
 
-	return (uint128_div_uint64_result){.quotient = gethi(quotient_guess), .remainder = remainder_guess};
+CREN_INTS_DISPATCHED(uint128_t, uint128_divexact, (const uint128_t a, const uint128_t b), (a, b)) {
+	if (gethi(b) == 0)
+		return divexact_uint64(a, getlo(b));
+	// the quotient fits into 64 bits, so it is determined by its value modulo 2^64
+	const unsigned shift = uint128_ctz(b);
+	const uint64_t odd_lower = getlo(uint128_shift_right(b, shift));
+	return uint128_create(0, getlo(uint128_shift_right(a, shift)) * inverse_uint64(odd_lower));
 }
 
-// Struct defining the result of dividing a 196-bit uint by a 128-bit uint
-typedef struct uint196_div_uint128_result {
-	uint64_t quotient;
-	uint128_t remainder;
-} uint196_div_uint128_result;
+/// Conversion to string
 
-// Algorithm div_3by2 from the paper
-uint196_div_uint128_result divrem_uint196_by_uint128(const uint64_t a2, const uint64_t a1, const uint64_t a0,
-													 const uint128_t divisor, const uint64_t reciprocal) {
-	uint128_t quotient_guess = uint64_multiply(reciprocal, a2);
-	quotient_guess = uint128_add(quotient_guess, uint128_create(a2, a1));
+const char DIGIT_CHARACTERS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
 
-	uint64_t remainder_higher = a1 - gethi(quotient_guess) * gethi(divisor);
-	uint128_t temporary = uint64_multiply(getlo(divisor), gethi(quotient_guess));
+// All two-digit decimal numbers, so that the decimal conversion can write two digits per division
+const char DECIMAL_DIGIT_PAIRS[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
 
-	uint128_t remainder_guess = uint128_subtract(
-		uint128_subtract(uint128_create(remainder_higher, a0), temporary), divisor);
-	remainder_higher = gethi(remainder_guess);
-	quotient_guess = uint128_increment_higher(quotient_guess);
+// All of the following formatting functions write the digits backwards, ending right before end,
+// and return the pointer to the first written digit (same as the ones in uint128_digits.h)
 
-	if (remainder_higher >= getlo(quotient_guess)) {
-		quotient_guess = uint128_decrement_higher(quotient_guess);
-		remainder_guess = uint128_add(remainder_guess, divisor);
+/* Writes the digits of a 128-bit uint in a base which is a power of 2, taking the digits straight from the bits */
+static char * format_power_of_2(uint128_t value, char *end, const unsigned digit_bits) {
+	const uint64_t digit_mask = (1u << digit_bits) - 1;
+	while (gethi(value) != 0) {
+		*--end = DIGIT_CHARACTERS[getlo(value) & digit_mask];
+		value = uint128_shift_right(value, digit_bits);
 	}
-	if (uint128_gte(remainder_guess, divisor)) {
-		quotient_guess = uint128_increment_higher(quotient_guess);
-		remainder_guess = uint128_subtract(remainder_guess, divisor);
+	uint64_t lower = getlo(value);
+	do {
+		*--end = DIGIT_CHARACTERS[lower & digit_mask];
+		lower >>= digit_bits;
+	} while (lower != 0);
+	return end;
+}
+
+/* Writes the digits of a 128-bit uint by splitting it into chunks of the largest power of the base fitting into
+ * 64 bits, so that all digits except for the chunk division are computed using 64-bit arithmetic */
+static char * format_chunked(uint128_t value, char *end, const unsigned base,
+							 const uint128_divisor_t * const chunk_divisor, const unsigned chunk_digits) {
+	while (gethi(value) != 0) {
+		const uint128_divrem_result divided = uint128_divrem_by(value, chunk_divisor);
+		// the lower chunks have to be padded with zeroes
+		end = format_uint64_padded(getlo(divided.remainder), end, base, chunk_digits);
+		value = divided.quotient;
 	}
-
-	return (uint196_div_uint128_result){.quotient = gethi(quotient_guess), .remainder = remainder_guess};
+	return format_uint64(getlo(value), end, base);
 }
 
-// Use the previous funtions/algorithms for school-like division
-uint128_divrem_result uint128_divrem(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return (uint128_divrem_result){.quotient = a / b, .remainder = a % b};
-#else
-	if (gethi(b) == 0) {
-		assert(getlo(b) != 0);	// dividing by 0
-
-		const unsigned left_shift = uint64_clz(getlo(b));
-		const unsigned right_shift = (64 - left_shift) % 64;
-		const uint64_t right_mask = ((uint64_t)(left_shift == 0)) - 1;
-
-		const uint64_t divisor = getlo(b) << left_shift;
-		const uint64_t dividend_lower = getlo(a) << left_shift;
-		const uint64_t dividend_higher = (gethi(a) << left_shift) | ((getlo(a) >> right_shift) & right_mask);
-		const uint64_t dividend_extra = (gethi(a) >> right_shift) & right_mask;
-
-		const uint64_t reciprocal = reciprocal_128_by_64(divisor);
-		const uint128_div_uint64_result result_higher = divrem_uint128_by_uint64(
-				uint128_create(dividend_extra, dividend_higher), divisor, reciprocal
-			);
-		const uint128_div_uint64_result result_lower = divrem_uint128_by_uint64(
-				uint128_create(result_higher.remainder, dividend_lower), divisor, reciprocal
-			);
-		return (uint128_divrem_result){.quotient = uint128_create(result_higher.quotient, result_lower.quotient),
-								 .remainder = uint128_create(0, result_lower.remainder >> left_shift)};
-	}
-
-	if (gethi(b) > gethi(a)) {
-		return (uint128_divrem_result){.quotient = UINT128_ZERO, .remainder = a};
+/* Same as format_chunked in base 10, where the chunk divisor 10^19 is a constant */
+static char * format_decimal(uint128_t value, char *end) {
+	while (gethi(value) != 0) {
+		const uint128_divrem_result divided = UINT128_DIVREM_BY_CONST(value, DECIMAL_CHUNK);
+		end = format_decimal_chunk(getlo(divided.remainder), end);
+		value = divided.quotient;
 	}
-
-	const unsigned left_shift = uint64_clz(gethi(b));
-	// if the divisor has no 0-bits on the left, then the quotient is either 1 or 0
-	if (left_shift == 0) {
-		const unsigned quotient = ((unsigned)(gethi(b) < gethi(a))) | ((unsigned)(getlo(b) <= getlo(a)));
-		return (uint128_divrem_result){.quotient = uint128_create(0, quotient),
-								 .remainder = uint128_subtract(a, quotient ? b : UINT128_ZERO)};
-	}
-
-	const unsigned right_shift = 64 - left_shift;
-	const uint64_t divisor_lower = getlo(b) << left_shift;
-	const uint64_t divisor_higher = (gethi(b) << left_shift) | (getlo(b) >> right_shift);
-	const uint64_t dividend_lower = getlo(a) << left_shift;
-	const uint64_t dividend_higher = (gethi(a) << left_shift) | (getlo(a) >> right_shift);
-	const uint64_t dividend_extra = gethi(a) >> right_shift;
-
-	const uint128_t divisor = uint128_create(divisor_higher, divisor_lower);
-
-	const uint64_t reciprocal = reciprocal_196_by_128(divisor);
-	const uint196_div_uint128_result result = divrem_uint196_by_uint128(dividend_extra, dividend_higher, dividend_lower,
-			divisor, reciprocal
-		);
-
-	return (uint128_divrem_result){.quotient = uint128_create(0, result.quotient),
-								.remainder = uint128_shift_right(result.remainder, left_shift)};
-#endif
+	return format_uint64(getlo(value), end, 10);
 }
 
-uint128_t uint128_divide(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a / b;
-#else
-	return uint128_divrem(a, b).quotient;
-#endif
-}
+size_t uint128_format(const uint128_t a, char * const string, const unsigned int base) {
+	if (base < 2 || base > 36 || string == NULL)
+		return 0;
 
-uint128_t uint128_mod(const uint128_t a, const uint128_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a / b;
-#else
-	return uint128_divrem(a, b).remainder;
-#endif
-}
+	char buffer[UINT128_STRING_SIZE];
+	char * const end = buffer + sizeof(buffer);
+	char *begin;
 
-uint128_t uint128_divide_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a / b;
-#else
-	return uint128_divrem(a, (uint128_t){.hi = 0, .lo = b}).quotient;
-#endif
-}
+	if ((base & (base - 1)) == 0) {
+		begin = format_power_of_2(a, end, uint64_clz(1) - uint64_clz(base));
+	} else if (base == 10) {
+		begin = format_decimal(a, end);
+	} else {
+		const uint64_base_power chunk = LARGEST_BASE_POWERS[base - 2];
+		const uint128_divisor_t chunk_divisor = uint128_divisor_init(uint128_value(chunk.power));
+		begin = format_chunked(a, end, base, &chunk_divisor, chunk.digits);
+	}
 
-uint64_t uint128_mod_uint64(const uint128_t a, const uint64_t b) {
-#if COMPILER_INT128_AVAILABLE
-	return a / b;
-#else
-	return uint128_divrem(a, (uint128_t){.hi = 0, .lo = b}).remainder.lo;
-#endif
+	const size_t length = (size_t)(end - begin);
+	memcpy(string, begin, length);
+	string[length] = '\0';
+	return length;
 }
 
-uint128_t uint128_increment(const uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return a + 1;
-#else
-	const uint64_t new_lo = a.lo + 1;
-	const unsigned int carry = new_lo < a.lo;
-	return (uint128_t){.hi = a.hi + carry, .lo = new_lo};
-#endif
+const char * uint128_to_string(const uint128_t a, char * const string, const unsigned int base) {
+	if (uint128_format(a, string, base) == 0)
+		return NULL;
+	return string;
 }
 
-uint128_t uint128_decrement(const uint128_t a) {
-#if COMPILER_INT128_AVAILABLE
-	return a - 1;
-#else
-	const uint64_t new_lo = a.lo - 1;
-	const unsigned int carry = new_lo > a.lo;
-	return (uint128_t){.hi = a.hi - carry, .lo = new_lo};
-#endif
+/// Formatting of arrays
+// The exact length of the string is computed before writing anything, from the number of digits of every value,
+// which only takes a comparison with a power of 10 in base 10. Then the values are written backwards from the end
+// right into their place, without copying. The divisor of the chunks is the same for all of the values, in base 10
+// it is the constant 10^19, otherwise it is computed once per array.
+
+// Powers of 10 from 10^0 to 10^38 (the largest one fitting into 128 bits), as {higher, lower}
+static const uint64_t DECIMAL_POWERS[39][2] = {
+	{0x0000000000000000ull, 0x0000000000000001ull}, {0x0000000000000000ull, 0x000000000000000aull},
+	{0x0000000000000000ull, 0x0000000000000064ull}, {0x0000000000000000ull, 0x00000000000003e8ull},
+	{0x0000000000000000ull, 0x0000000000002710ull}, {0x0000000000000000ull, 0x00000000000186a0ull},
+	{0x0000000000000000ull, 0x00000000000f4240ull}, {0x0000000000000000ull, 0x0000000000989680ull},
+	{0x0000000000000000ull, 0x0000000005f5e100ull}, {0x0000000000000000ull, 0x000000003b9aca00ull},
+	{0x0000000000000000ull, 0x00000002540be400ull}, {0x0000000000000000ull, 0x000000174876e800ull},
+	{0x0000000000000000ull, 0x000000e8d4a51000ull}, {0x0000000000000000ull, 0x000009184e72a000ull},
+	{0x0000000000000000ull, 0x00005af3107a4000ull}, {0x0000000000000000ull, 0x00038d7ea4c68000ull},
+	{0x0000000000000000ull, 0x002386f26fc10000ull}, {0x0000000000000000ull, 0x016345785d8a0000ull},
+	{0x0000000000000000ull, 0x0de0b6b3a7640000ull}, {0x0000000000000000ull, 0x8ac7230489e80000ull},
+	{0x0000000000000005ull, 0x6bc75e2d63100000ull}, {0x0000000000000036ull, 0x35c9adc5dea00000ull},
+	{0x000000000000021eull, 0x19e0c9bab2400000ull}, {0x000000000000152dull, 0x02c7e14af6800000ull},
+	{0x000000000000d3c2ull, 0x1bcecceda1000000ull}, {0x0000000000084595ull, 0x161401484a000000ull},
+	{0x000000000052b7d2ull, 0xdcc80cd2e4000000ull}, {0x00000000033b2e3cull, 0x9fd0803ce8000000ull},
+	{0x00000000204fce5eull, 0x3e25026110000000ull}, {0x00000001431e0faeull, 0x6d7217caa0000000ull},
+	{0x0000000c9f2c9cd0ull, 0x4674edea40000000ull}, {0x0000007e37be2022ull, 0xc0914b2680000000ull},
+	{0x000004ee2d6d415bull, 0x85acef8100000000ull}, {0x0000314dc6448d93ull, 0x38c15b0a00000000ull},
+	{0x0001ed09bead87c0ull, 0x378d8e6400000000ull}, {0x0013426172c74d82ull, 0x2b878fe800000000ull},
+	{0x00c097ce7bc90715ull, 0xb34b9f1000000000ull}, {0x0785ee10d5da46d9ull, 0x00f436a000000000ull},
+	{0x4b3b4ca85a86c47aull, 0x098a224000000000ull}
+};
+
+// Parameters of formatting in some base, which are the same for all of the values
+typedef struct format_parameters {
+	unsigned base;
+	unsigned digit_bits; // bits per digit if the base is a power of 2, otherwise 0
+	unsigned chunk_digits;
+	uint128_divisor_t chunk_divisor;
+	const char *separator;
+	size_t separator_length;
+} format_parameters;
+
+static int format_parameters_init(format_parameters * const parameters, const unsigned base,
+								  const char * const separator) {
+	if (base < 2 || base > 36)
+		return 0;
+	parameters->base = base;
+	parameters->digit_bits = (base & (base - 1)) == 0 ? uint64_clz(1) - uint64_clz(base) : 0;
+	if (parameters->digit_bits == 0 && base != 10) {
+		parameters->chunk_digits = LARGEST_BASE_POWERS[base - 2].digits;
+		parameters->chunk_divisor = uint128_divisor_init(uint128_value(LARGEST_BASE_POWERS[base - 2].power));
+	}
+	parameters->separator = separator == NULL ? "" : separator;
+	parameters->separator_length = strlen(parameters->separator);
+	return 1;
+}
+
+/* Number of digits of a 128-bit uint in the base. In base 10 the number of bits times log10(2) (about 1233 / 4096)
+ * is either the number of digits or one less, which is decided by comparing with a power of 10 */
+static inline size_t format_digits(uint128_t value, const format_parameters * const parameters) {
+	const unsigned bits = uint128_bit_length(value);
+	if (bits == 0)
+		return 1;
+	if (parameters->base == 10) {
+		const unsigned digits = bits * 1233 >> 12;
+		return digits + uint128_gte(value, uint128_create(DECIMAL_POWERS[digits][0], DECIMAL_POWERS[digits][1]));
+	}
+	if (parameters->digit_bits != 0)
+		return (bits + parameters->digit_bits - 1) / parameters->digit_bits;
+
+	size_t digits = 0;
+	while (gethi(value) != 0) {
+		value = uint128_div_by(value, &parameters->chunk_divisor);
+		digits += parameters->chunk_digits;
+	}
+	for (uint64_t lower = getlo(value); lower != 0; lower /= parameters->base)
+		digits++;
+	return digits;
+}
+
+/* Returns the length of all of the values with the separators between them */
+static size_t format_array_size(const uint128_t * const values, const size_t n,
+								const format_parameters * const parameters) {
+	if (n == 0)
+		return 0;
+	size_t size = (n - 1) * parameters->separator_length;
+	for (size_t i = 0; i < n; i++)
+		size += format_digits(values[i], parameters);
+	return size;
+}
+
+size_t uint128_format_array_size(const uint128_t * const values, const size_t n, const unsigned int base,
+								 const char * const separator) {
+	format_parameters parameters;
+	if (!format_parameters_init(&parameters, base, separator))
+		return 0;
+	return format_array_size(values, n, &parameters);
+}
+
+size_t uint128_format_array(const uint128_t * const values, const size_t n, const unsigned int base,
+							const char * const separator, char * const string, const size_t capacity) {
+	format_parameters parameters;
+	if (string == NULL || !format_parameters_init(&parameters, base, separator))
+		return 0;
+	const size_t size = format_array_size(values, n, &parameters);
+	if (size >= capacity)
+		return 0;
+
+	// knowing the exact length, the values are written backwards from the end, the same way as their digits
+	char *position = string + size;
+	*position = '\0';
+	for (size_t i = n; i-- > 0;) {
+		if (parameters.base == 10)
+			position = format_decimal(values[i], position);
+		else if (parameters.digit_bits != 0)
+			position = format_power_of_2(values[i], position, parameters.digit_bits);
+		else
+			position = format_chunked(values[i], position, parameters.base, &parameters.chunk_divisor,
+									  parameters.chunk_digits);
+		if (i != 0) {
+			position -= parameters.separator_length;
+			memcpy(position, parameters.separator, parameters.separator_length);
+		}
+	}
+	return size;
 }
@@ -0,0 +1,514 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_array.h"
+#include "uint128_division.h"
+
+// On x86-64 the vectorized functions are compiled for AVX2 and AVX-512 along with the scalar ones, and picked
+// at startup by GNU ifunc resolvers, unless the compiler already targets AVX-512 (or the dispatch is disabled,
+// then the best version the compiler targets is used). The uint128_t arrays are handled as arrays of 64-bit lanes,
+// where every even lane is the lower half of an element, so this is only done on little-endian x86-64.
+#if CREN_INTS_IFUNC_AVAILABLE && !defined(__AVX512F__)
+#define ARRAY_DISPATCH 1
+#define ARRAY_AVX2 1
+#define ARRAY_AVX512 1
+#define ARRAY_AVX2_TARGET __attribute__((target("avx2")))
+#define ARRAY_AVX512_TARGET __attribute__((target("avx512f")))
+#else
+#define ARRAY_DISPATCH 0
+#define ARRAY_AVX2_TARGET
+#define ARRAY_AVX512_TARGET
+#if defined(__x86_64__) && defined(__AVX512F__)
+#define ARRAY_AVX2 0
+#define ARRAY_AVX512 1
+#elif defined(__x86_64__) && defined(__AVX2__)
+#define ARRAY_AVX2 1
+#define ARRAY_AVX512 0
+#else
+#define ARRAY_AVX2 0
+#define ARRAY_AVX512 0
+#endif
+#endif
+
+#if ARRAY_AVX2 || ARRAY_AVX512
+#include <immintrin.h>
+#endif
+
+/// Scalar implementation
+// Also handles the elements left after the vectorized loops
+
+static void add_array_scalar(uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+							 const size_t n) {
+	for (size_t i = 0; i < n; i++)
+		result[i] = uint128_add(a[i], b[i]);
+}
+
+static void sub_array_scalar(uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+							 const size_t n) {
+	for (size_t i = 0; i < n; i++)
+		result[i] = uint128_subtract(a[i], b[i]);
+}
+
+static void cmp_array_scalar(int8_t * const result, const uint128_t * const a, const uint128_t * const b,
+							 const size_t n) {
+	for (size_t i = 0; i < n; i++)
+		result[i] = (int8_t)(uint128_lt(b[i], a[i]) - uint128_lt(a[i], b[i]));
+}
+
+static uint128_t sum_scalar(const uint128_t * const a, const size_t n) {
+	uint128_t sum = uint128_value(0);
+	for (size_t i = 0; i < n; i++)
+		sum = uint128_add(sum, a[i]);
+	return sum;
+}
+
+static void add_array_soa_scalar(const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b,
+								 const size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		const uint64_t lower = a.lower[i] + b.lower[i];
+		result.higher[i] = a.higher[i] + b.higher[i] + (lower < a.lower[i]);
+		result.lower[i] = lower;
+	}
+}
+
+static void sub_array_soa_scalar(const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b,
+								 const size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		const uint64_t lower = a.lower[i] - b.lower[i];
+		result.higher[i] = a.higher[i] - b.higher[i] - (a.lower[i] < b.lower[i]);
+		result.lower[i] = lower;
+	}
+}
+
+static void cmp_array_soa_scalar(int8_t * const result, const uint128_soa_t a, const uint128_soa_t b,
+								 const size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		const int greater = a.higher[i] > b.higher[i] || (a.higher[i] == b.higher[i] && a.lower[i] > b.lower[i]);
+		const int less = a.higher[i] < b.higher[i] || (a.higher[i] == b.higher[i] && a.lower[i] < b.lower[i]);
+		result[i] = (int8_t)(greater - less);
+	}
+}
+
+static uint128_t sum_soa_scalar(const uint128_soa_t a, const size_t n) {
+	uint64_t higher = 0, lower = 0;
+	for (size_t i = 0; i < n; i++) {
+		lower += a.lower[i];
+		higher += a.higher[i] + (lower < a.lower[i]);
+	}
+	return uint128_create(higher, lower);
+}
+
+static void byte_swap_array_scalar(void * const to, const void * const from, const size_t n) {
+	for (size_t i = 0; i < n; i++)
+		uint128_store_le((unsigned char *)to + 16 * i, uint128_load_be((const unsigned char *)from + 16 * i));
+}
+
+/// AVX2 implementation
+// AVX2 only has signed 64-bit comparisons, so the unsigned ones flip the highest bits of both operands first.
+// The comparisons give masks of -1, so the carries are added by subtracting the masks
+
+#if ARRAY_AVX2
+/* Lanes of x which are less than the lanes of y, as masks */
+ARRAY_AVX2_TARGET static inline __m256i avx2_less(const __m256i x, const __m256i y) {
+	const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+	return _mm256_cmpgt_epi64(_mm256_xor_si256(y, sign), _mm256_xor_si256(x, sign));
+}
+
+ARRAY_AVX2_TARGET static void add_array_avx2(uint128_t * const result, const uint128_t * const a,
+											 const uint128_t * const b, const size_t n) {
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		const __m256i sum = _mm256_add_epi64(x, _mm256_loadu_si256((const __m256i *)(b + i)));
+		// the carries of the lower lanes are moved to the higher lanes, the ones of the higher lanes are dropped
+		const __m256i carries = _mm256_bslli_epi128(avx2_less(sum, x), 8);
+		_mm256_storeu_si256((__m256i *)(result + i), _mm256_sub_epi64(sum, carries));
+	}
+	add_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX2_TARGET static void sub_array_avx2(uint128_t * const result, const uint128_t * const a,
+											 const uint128_t * const b, const size_t n) {
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		const __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+		const __m256i borrows = _mm256_bslli_epi128(avx2_less(x, y), 8);
+		_mm256_storeu_si256((__m256i *)(result + i), _mm256_add_epi64(_mm256_sub_epi64(x, y), borrows));
+	}
+	sub_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX2_TARGET static void cmp_array_avx2(int8_t * const result, const uint128_t * const a,
+											 const uint128_t * const b, const size_t n) {
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		const __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+		// every element has 2 bits in both masks, the one of the higher half being higher, and the bits of a half
+		// can't be set in both masks, so the elements compare the same way as their bits
+		const unsigned greater = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(avx2_less(y, x)));
+		const unsigned less = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(avx2_less(x, y)));
+		for (unsigned j = 0; j < 2; j++) {
+			const unsigned element_greater = (greater >> (2 * j)) & 3, element_less = (less >> (2 * j)) & 3;
+			result[i + j] = (int8_t)((element_greater > element_less) - (element_greater < element_less));
+		}
+	}
+	cmp_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX2_TARGET static uint128_t sum_avx2(const uint128_t * const a, const size_t n) {
+	__m256i sum = _mm256_setzero_si256(), carries = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 2 <= n; i += 2) {
+		const __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+		sum = _mm256_add_epi64(sum, x);
+		carries = _mm256_sub_epi64(carries, avx2_less(sum, x));
+	}
+	uint64_t sum_lanes[4], carry_lanes[4];
+	_mm256_storeu_si256((__m256i *)sum_lanes, sum);
+	_mm256_storeu_si256((__m256i *)carry_lanes, carries);
+	// the carries of the higher lanes are dropped
+	uint128_t total = sum_scalar(a + i, n - i);
+	total = uint128_add(total, uint128_create(sum_lanes[1] + carry_lanes[0], sum_lanes[0]));
+	return uint128_add(total, uint128_create(sum_lanes[3] + carry_lanes[2], sum_lanes[2]));
+}
+
+ARRAY_AVX2_TARGET static void add_array_soa_avx2(const uint128_soa_t result, const uint128_soa_t a,
+												 const uint128_soa_t b, const size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m256i x_lower = _mm256_loadu_si256((const __m256i *)(a.lower + i));
+		const __m256i lower = _mm256_add_epi64(x_lower, _mm256_loadu_si256((const __m256i *)(b.lower + i)));
+		const __m256i higher = _mm256_add_epi64(_mm256_loadu_si256((const __m256i *)(a.higher + i)),
+												_mm256_loadu_si256((const __m256i *)(b.higher + i)));
+		_mm256_storeu_si256((__m256i *)(result.higher + i), _mm256_sub_epi64(higher, avx2_less(lower, x_lower)));
+		_mm256_storeu_si256((__m256i *)(result.lower + i), lower);
+	}
+	add_array_soa_scalar((uint128_soa_t){result.higher + i, result.lower + i},
+						 (uint128_soa_t){a.higher + i, a.lower + i}, (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX2_TARGET static void sub_array_soa_avx2(const uint128_soa_t result, const uint128_soa_t a,
+												 const uint128_soa_t b, const size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m256i x_lower = _mm256_loadu_si256((const __m256i *)(a.lower + i));
+		const __m256i y_lower = _mm256_loadu_si256((const __m256i *)(b.lower + i));
+		const __m256i higher = _mm256_sub_epi64(_mm256_loadu_si256((const __m256i *)(a.higher + i)),
+												_mm256_loadu_si256((const __m256i *)(b.higher + i)));
+		_mm256_storeu_si256((__m256i *)(result.higher + i), _mm256_add_epi64(higher, avx2_less(x_lower, y_lower)));
+		_mm256_storeu_si256((__m256i *)(result.lower + i), _mm256_sub_epi64(x_lower, y_lower));
+	}
+	sub_array_soa_scalar((uint128_soa_t){result.higher + i, result.lower + i},
+						 (uint128_soa_t){a.higher + i, a.lower + i}, (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX2_TARGET static void cmp_array_soa_avx2(int8_t * const result, const uint128_soa_t a,
+												 const uint128_soa_t b, const size_t n) {
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m256i x_higher = _mm256_loadu_si256((const __m256i *)(a.higher + i));
+		const __m256i y_higher = _mm256_loadu_si256((const __m256i *)(b.higher + i));
+		const __m256i x_lower = _mm256_loadu_si256((const __m256i *)(a.lower + i));
+		const __m256i y_lower = _mm256_loadu_si256((const __m256i *)(b.lower + i));
+		const __m256i equal = _mm256_cmpeq_epi64(x_higher, y_higher);
+		const __m256i greater = _mm256_or_si256(avx2_less(y_higher, x_higher),
+												_mm256_and_si256(equal, avx2_less(y_lower, x_lower)));
+		const __m256i less = _mm256_or_si256(avx2_less(x_higher, y_higher),
+											 _mm256_and_si256(equal, avx2_less(x_lower, y_lower)));
+		const unsigned greater_bits = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(greater));
+		const unsigned less_bits = (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(less));
+		for (unsigned j = 0; j < 4; j++)
+			result[i + j] = (int8_t)(((greater_bits >> j) & 1) - ((less_bits >> j) & 1));
+	}
+	cmp_array_soa_scalar(result + i, (uint128_soa_t){a.higher + i, a.lower + i},
+						 (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX2_TARGET static uint128_t sum_soa_avx2(const uint128_soa_t a, const size_t n) {
+	__m256i higher = _mm256_setzero_si256(), lower = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m256i x_lower = _mm256_loadu_si256((const __m256i *)(a.lower + i));
+		lower = _mm256_add_epi64(lower, x_lower);
+		higher = _mm256_sub_epi64(_mm256_add_epi64(higher, _mm256_loadu_si256((const __m256i *)(a.higher + i))),
+								  avx2_less(lower, x_lower));
+	}
+	uint64_t higher_lanes[4], lower_lanes[4];
+	_mm256_storeu_si256((__m256i *)higher_lanes, higher);
+	_mm256_storeu_si256((__m256i *)lower_lanes, lower);
+	uint128_t total = sum_soa_scalar((uint128_soa_t){a.higher + i, a.lower + i}, n - i);
+	for (unsigned j = 0; j < 4; j++)
+		total = uint128_add(total, uint128_create(higher_lanes[j], lower_lanes[j]));
+	return total;
+}
+#endif
+
+// The byte swap is also used by AVX-512, since vpshufb on 512-bit vectors needs AVX512BW, and the swap is bound
+// by memory anyway
+
+#if ARRAY_AVX2 || ARRAY_AVX512
+ARRAY_AVX2_TARGET static void byte_swap_array_avx2(void * const to, const void * const from, const size_t n) {
+	const __m256i reverse = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0,
+											 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+	const unsigned char * const source = from;
+	unsigned char * const destination = to;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m256i first = _mm256_loadu_si256((const __m256i *)(source + 16 * i));
+		const __m256i second = _mm256_loadu_si256((const __m256i *)(source + 16 * i + 32));
+		_mm256_storeu_si256((__m256i *)(destination + 16 * i), _mm256_shuffle_epi8(first, reverse));
+		_mm256_storeu_si256((__m256i *)(destination + 16 * i + 32), _mm256_shuffle_epi8(second, reverse));
+	}
+	byte_swap_array_scalar(destination + 16 * i, source + 16 * i, n - i);
+}
+#define byte_swap_array_avx512 byte_swap_array_avx2
+#endif
+
+/// AVX-512 implementation
+// AVX-512 has unsigned comparisons into mask registers, and the carries are added using masked additions
+
+#if ARRAY_AVX512
+// The lanes of uint128_t arrays which hold the higher halves
+#define AVX512_HIGHER_LANES 0xaa
+
+ARRAY_AVX512_TARGET static void add_array_avx512(uint128_t * const result, const uint128_t * const a,
+												 const uint128_t * const b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m512i x = _mm512_loadu_si512(a + i);
+		const __m512i sum = _mm512_add_epi64(x, _mm512_loadu_si512(b + i));
+		const __mmask8 carries = (__mmask8)((_mm512_cmplt_epu64_mask(sum, x) << 1) & AVX512_HIGHER_LANES);
+		_mm512_storeu_si512(result + i, _mm512_mask_add_epi64(sum, carries, sum, one));
+	}
+	add_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX512_TARGET static void sub_array_avx512(uint128_t * const result, const uint128_t * const a,
+												 const uint128_t * const b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m512i x = _mm512_loadu_si512(a + i);
+		const __m512i y = _mm512_loadu_si512(b + i);
+		const __m512i difference = _mm512_sub_epi64(x, y);
+		const __mmask8 borrows = (__mmask8)((_mm512_cmplt_epu64_mask(x, y) << 1) & AVX512_HIGHER_LANES);
+		_mm512_storeu_si512(result + i, _mm512_mask_sub_epi64(difference, borrows, difference, one));
+	}
+	sub_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX512_TARGET static void cmp_array_avx512(int8_t * const result, const uint128_t * const a,
+												 const uint128_t * const b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m512i x = _mm512_loadu_si512(a + i);
+		const __m512i y = _mm512_loadu_si512(b + i);
+		// the higher lanes decide, unless the higher halves are equal, then the lower lanes (moved to the higher
+		// ones) do, and the results of the elements are gathered from the higher lanes
+		const __mmask8 lower_greater = _mm512_cmpgt_epu64_mask(x, y), lower_less = _mm512_cmplt_epu64_mask(x, y);
+		const __mmask8 greater = (__mmask8)((lower_greater | (~lower_less & (lower_greater << 1))) & AVX512_HIGHER_LANES);
+		const __mmask8 less = (__mmask8)((lower_less | (~lower_greater & (lower_less << 1))) & AVX512_HIGHER_LANES);
+		const __m512i lanes = _mm512_mask_sub_epi64(_mm512_maskz_mov_epi64(greater, one), less,
+													_mm512_setzero_si512(), one);
+		const uint32_t bytes = (uint32_t)_mm_cvtsi128_si32(_mm512_cvtepi64_epi8(
+				_mm512_maskz_compress_epi64(AVX512_HIGHER_LANES, lanes)));
+		memcpy(result + i, &bytes, sizeof(bytes));
+	}
+	cmp_array_scalar(result + i, a + i, b + i, n - i);
+}
+
+ARRAY_AVX512_TARGET static uint128_t sum_avx512(const uint128_t * const a, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	__m512i sum = _mm512_setzero_si512(), carries = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const __m512i x = _mm512_loadu_si512(a + i);
+		sum = _mm512_add_epi64(sum, x);
+		carries = _mm512_mask_add_epi64(carries, _mm512_cmplt_epu64_mask(sum, x), carries, one);
+	}
+	uint64_t sum_lanes[8], carry_lanes[8];
+	_mm512_storeu_si512(sum_lanes, sum);
+	_mm512_storeu_si512(carry_lanes, carries);
+	uint128_t total = sum_scalar(a + i, n - i);
+	for (unsigned j = 0; j < 8; j += 2)
+		total = uint128_add(total, uint128_create(sum_lanes[j + 1] + carry_lanes[j], sum_lanes[j]));
+	return total;
+}
+
+ARRAY_AVX512_TARGET static void add_array_soa_avx512(const uint128_soa_t result, const uint128_soa_t a,
+													 const uint128_soa_t b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m512i x_lower = _mm512_loadu_si512(a.lower + i);
+		const __m512i lower = _mm512_add_epi64(x_lower, _mm512_loadu_si512(b.lower + i));
+		const __m512i higher = _mm512_add_epi64(_mm512_loadu_si512(a.higher + i), _mm512_loadu_si512(b.higher + i));
+		_mm512_storeu_si512(result.higher + i,
+							_mm512_mask_add_epi64(higher, _mm512_cmplt_epu64_mask(lower, x_lower), higher, one));
+		_mm512_storeu_si512(result.lower + i, lower);
+	}
+	add_array_soa_scalar((uint128_soa_t){result.higher + i, result.lower + i},
+						 (uint128_soa_t){a.higher + i, a.lower + i}, (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX512_TARGET static void sub_array_soa_avx512(const uint128_soa_t result, const uint128_soa_t a,
+													 const uint128_soa_t b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m512i x_lower = _mm512_loadu_si512(a.lower + i);
+		const __m512i y_lower = _mm512_loadu_si512(b.lower + i);
+		const __m512i higher = _mm512_sub_epi64(_mm512_loadu_si512(a.higher + i), _mm512_loadu_si512(b.higher + i));
+		_mm512_storeu_si512(result.higher + i,
+							_mm512_mask_sub_epi64(higher, _mm512_cmplt_epu64_mask(x_lower, y_lower), higher, one));
+		_mm512_storeu_si512(result.lower + i, _mm512_sub_epi64(x_lower, y_lower));
+	}
+	sub_array_soa_scalar((uint128_soa_t){result.higher + i, result.lower + i},
+						 (uint128_soa_t){a.higher + i, a.lower + i}, (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX512_TARGET static void cmp_array_soa_avx512(int8_t * const result, const uint128_soa_t a,
+													 const uint128_soa_t b, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m512i x_higher = _mm512_loadu_si512(a.higher + i), y_higher = _mm512_loadu_si512(b.higher + i);
+		const __m512i x_lower = _mm512_loadu_si512(a.lower + i), y_lower = _mm512_loadu_si512(b.lower + i);
+		const __mmask8 equal = _mm512_cmpeq_epu64_mask(x_higher, y_higher);
+		const __mmask8 greater = _mm512_cmpgt_epu64_mask(x_higher, y_higher) |
+			(equal & _mm512_cmpgt_epu64_mask(x_lower, y_lower));
+		const __mmask8 less = _mm512_cmplt_epu64_mask(x_higher, y_higher) |
+			(equal & _mm512_cmplt_epu64_mask(x_lower, y_lower));
+		const __m512i lanes = _mm512_mask_sub_epi64(_mm512_maskz_mov_epi64(greater, one), less,
+													_mm512_setzero_si512(), one);
+		_mm_storel_epi64((__m128i *)(result + i), _mm512_cvtepi64_epi8(lanes));
+	}
+	cmp_array_soa_scalar(result + i, (uint128_soa_t){a.higher + i, a.lower + i},
+						 (uint128_soa_t){b.higher + i, b.lower + i}, n - i);
+}
+
+ARRAY_AVX512_TARGET static uint128_t sum_soa_avx512(const uint128_soa_t a, const size_t n) {
+	const __m512i one = _mm512_set1_epi64(1);
+	__m512i higher = _mm512_setzero_si512(), lower = _mm512_setzero_si512();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8) {
+		const __m512i x_lower = _mm512_loadu_si512(a.lower + i);
+		lower = _mm512_add_epi64(lower, x_lower);
+		higher = _mm512_add_epi64(higher, _mm512_loadu_si512(a.higher + i));
+		higher = _mm512_mask_add_epi64(higher, _mm512_cmplt_epu64_mask(lower, x_lower), higher, one);
+	}
+	uint64_t higher_lanes[8], lower_lanes[8];
+	_mm512_storeu_si512(higher_lanes, higher);
+	_mm512_storeu_si512(lower_lanes, lower);
+	uint128_t total = sum_soa_scalar((uint128_soa_t){a.higher + i, a.lower + i}, n - i);
+	for (unsigned j = 0; j < 8; j++)
+		total = uint128_add(total, uint128_create(higher_lanes[j], lower_lanes[j]));
+	return total;
+}
+#endif
+
+/// Public functions
+
+#if ARRAY_DISPATCH
+// Defines the public function uint128_<name>, which is resolved to the AVX-512, AVX2 or scalar version of <name>,
+// ARRAY_PROCEDURE is the same for the functions returning void
+#define ARRAY_OPERATION(return_type, name, params, args) \
+	__attribute__((no_sanitize_address, no_sanitize_thread)) \
+	static return_type (*uint128_##name##_resolve(void)) params { \
+		__builtin_cpu_init(); \
+		return __builtin_cpu_supports("avx512f") ? name##_avx512 : __builtin_cpu_supports("avx2") ? name##_avx2 : \
+			   name##_scalar; \
+	} \
+	return_type uint128_##name params __attribute__((ifunc("uint128_" #name "_resolve")));
+#define ARRAY_PROCEDURE(name, params, args) ARRAY_OPERATION(void, name, params, args)
+#else
+#if ARRAY_AVX512
+#define ARRAY_IMPLEMENTATION(name) name##_avx512
+#elif ARRAY_AVX2
+#define ARRAY_IMPLEMENTATION(name) name##_avx2
+#else
+#define ARRAY_IMPLEMENTATION(name) name##_scalar
+#endif
+#define ARRAY_OPERATION(return_type, name, params, args) \
+	return_type uint128_##name params { \
+		return ARRAY_IMPLEMENTATION(name) args; \
+	}
+#define ARRAY_PROCEDURE(name, params, args) \
+	void uint128_##name params { \
+		ARRAY_IMPLEMENTATION(name) args; \
+	}
+#endif
+
+ARRAY_PROCEDURE(add_array, (uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+							const size_t n), (result, a, b, n))
+ARRAY_PROCEDURE(sub_array, (uint128_t * const result, const uint128_t * const a, const uint128_t * const b,
+							const size_t n), (result, a, b, n))
+ARRAY_PROCEDURE(cmp_array, (int8_t * const result, const uint128_t * const a, const uint128_t * const b,
+							const size_t n), (result, a, b, n))
+ARRAY_OPERATION(uint128_t, sum, (const uint128_t * const a, const size_t n), (a, n))
+ARRAY_PROCEDURE(add_array_soa, (const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b,
+								const size_t n), (result, a, b, n))
+ARRAY_PROCEDURE(sub_array_soa, (const uint128_soa_t result, const uint128_soa_t a, const uint128_soa_t b,
+								const size_t n), (result, a, b, n))
+ARRAY_PROCEDURE(cmp_array_soa, (int8_t * const result, const uint128_soa_t a, const uint128_soa_t b,
+								const size_t n), (result, a, b, n))
+ARRAY_OPERATION(uint128_t, sum_soa, (const uint128_soa_t a, const size_t n), (a, n))
+
+ARRAY_PROCEDURE(byte_swap_array, (void * const to, const void * const from, const size_t n), (to, from, n))
+
+void uint128_mul_uint64_array(uint128_t * const result, const uint128_t * const a, const uint64_t * const b,
+							  const size_t n) {
+	for (size_t i = 0; i < n; i++)
+		result[i] = uint128_multiply_uint64(a[i], b[i]);
+}
+
+void uint128_mul_uint64_array_soa(const uint128_soa_t result, const uint128_soa_t a, const uint64_t * const b,
+								  const size_t n) {
+	for (size_t i = 0; i < n; i++) {
+		const uint128_t product = uint128_multiply_uint64(uint128_create(a.higher[i], a.lower[i]), b[i]);
+		result.higher[i] = gethi(product);
+		result.lower[i] = getlo(product);
+	}
+}
+
+// The elements in the machine's own order are copied, the other ones have their bytes swapped
+
+void uint128_load_le_array(uint128_t * const values, const void * const bytes, const size_t n) {
+#if ENDIANNESS == CREN_INTS_LITTLE_ENDIAN
+	memmove(values, bytes, n * sizeof(uint128_t));
+#else
+	uint128_byte_swap_array(values, bytes, n);
+#endif
+}
+
+void uint128_load_be_array(uint128_t * const values, const void * const bytes, const size_t n) {
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	memmove(values, bytes, n * sizeof(uint128_t));
+#else
+	uint128_byte_swap_array(values, bytes, n);
+#endif
+}
+
+void uint128_store_le_array(void * const bytes, const uint128_t * const values, const size_t n) {
+#if ENDIANNESS == CREN_INTS_LITTLE_ENDIAN
+	memmove(bytes, values, n * sizeof(uint128_t));
+#else
+	uint128_byte_swap_array(bytes, values, n);
+#endif
+}
+
+void uint128_store_be_array(void * const bytes, const uint128_t * const values, const size_t n) {
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	memmove(bytes, values, n * sizeof(uint128_t));
+#else
+	uint128_byte_swap_array(bytes, values, n);
+#endif
+}
@@ -0,0 +1,236 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "integers/uint128.h"
+#include "integers/uint128_atomic.h"
+#include "uint128_division.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// The operations are lock-free if the compiler can inline the 128-bit compare-and-swap for the target (x86-64 with
+// -mcx16, AArch64). Otherwise on x86-64 they are compiled both with cmpxchg16b and with locks, and the version is
+// picked at startup by GNU ifunc resolvers, same as the dispatched division functions. Everything else uses locks.
+#if defined(__SIZEOF_INT128__) && defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define CREN_INTS_ATOMIC_NATIVE 1
+#define CREN_INTS_ATOMIC_DISPATCH 0
+#define CREN_INTS_ATOMIC_TARGET
+#elif defined(__SIZEOF_INT128__) && CREN_INTS_IFUNC_AVAILABLE
+#include <cpuid.h>
+#define CREN_INTS_ATOMIC_NATIVE 1
+#define CREN_INTS_ATOMIC_DISPATCH 1
+#define CREN_INTS_ATOMIC_TARGET __attribute__((target("cx16")))
+#else
+#define CREN_INTS_ATOMIC_NATIVE 0
+#define CREN_INTS_ATOMIC_DISPATCH 0
+#endif
+
+/// Updates
+// Every operation except for the compare-exchange is an update, which atomically replaces the value with
+// update(value, operand) and returns the previous value
+
+static inline uint128_t update_keep(const uint128_t value, const uint128_t operand) {
+	(void)operand;
+	return value;
+}
+
+static inline uint128_t update_replace(const uint128_t value, const uint128_t operand) {
+	(void)value;
+	return operand;
+}
+
+static inline uint128_t update_add(const uint128_t value, const uint128_t operand) {
+	return uint128_add(value, operand);
+}
+
+static inline uint128_t update_or(const uint128_t value, const uint128_t operand) {
+	return uint128_or(value, operand);
+}
+
+typedef uint128_t (*update_function)(const uint128_t value, const uint128_t operand);
+
+/// Lock-free implementation
+
+#if CREN_INTS_ATOMIC_NATIVE
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+typedef unsigned __int128 native_uint128_t;
+#pragma GCC diagnostic pop
+// The halves of the value are read separately for the first guess of the compare-and-swap loops
+typedef uint64_t __attribute__((may_alias)) aliased_uint64_t;
+
+/* The compare-and-swap instruction of the target, returns the previous value */
+CREN_INTS_ATOMIC_TARGET static inline __attribute__((always_inline)) uint128_t compare_and_swap(
+		atomic_uint128_t * const a, const uint128_t expected, const uint128_t desired) {
+	const native_uint128_t previous = __sync_val_compare_and_swap(
+			(native_uint128_t *)&a->value, ((native_uint128_t)gethi(expected) << 64) | getlo(expected),
+			((native_uint128_t)gethi(desired) << 64) | getlo(desired)
+		);
+	return uint128_create((uint64_t)(previous >> 64), (uint64_t)previous);
+}
+
+CREN_INTS_ATOMIC_TARGET static inline __attribute__((always_inline)) uint128_t update_native(
+		atomic_uint128_t * const a, const update_function update, const uint128_t operand) {
+	// the guess may be torn, but then the compare-and-swap fails and returns the actual value
+	const aliased_uint64_t * const halves = (const aliased_uint64_t *)&a->value;
+	uint128_t expected = uint128_create(__atomic_load_n(&halves[ENDIANNESS == CREN_INTS_LITTLE_ENDIAN], __ATOMIC_RELAXED),
+										__atomic_load_n(&halves[ENDIANNESS != CREN_INTS_LITTLE_ENDIAN], __ATOMIC_RELAXED));
+	for (;;) {
+		const uint128_t previous = compare_and_swap(a, expected, update(expected, operand));
+		if (uint128_equ(previous, expected))
+			return previous;
+		expected = previous;
+	}
+}
+
+CREN_INTS_ATOMIC_TARGET static int compare_exchange_native(atomic_uint128_t * const a, uint128_t * const expected,
+														   const uint128_t desired) {
+	const uint128_t previous = compare_and_swap(a, *expected, desired);
+	const int swapped = uint128_equ(previous, *expected);
+	*expected = previous;
+	return swapped;
+}
+
+CREN_INTS_ATOMIC_TARGET static uint128_t load_native(atomic_uint128_t * const a) {
+	// replacing 0 with 0 doesn't change the value either way, and doesn't need a loop
+	return compare_and_swap(a, uint128_value(0), uint128_value(0));
+}
+
+CREN_INTS_ATOMIC_TARGET static uint128_t exchange_native(atomic_uint128_t * const a, const uint128_t value) {
+	return update_native(a, update_replace, value);
+}
+
+CREN_INTS_ATOMIC_TARGET static uint128_t fetch_add_native(atomic_uint128_t * const a, const uint128_t value) {
+	return update_native(a, update_add, value);
+}
+
+CREN_INTS_ATOMIC_TARGET static uint128_t fetch_or_native(atomic_uint128_t * const a, const uint128_t value) {
+	return update_native(a, update_or, value);
+}
+#endif
+
+/// Locked implementation
+
+#if !CREN_INTS_ATOMIC_NATIVE || CREN_INTS_ATOMIC_DISPATCH
+// Number of spin locks shared by all of the atomic values, each one is on its own cache line
+#define ATOMIC_LOCKS 64
+
+static struct {
+	atomic_int locked;
+	char padding[64 - sizeof(atomic_int)];
+} atomic_locks[ATOMIC_LOCKS];
+
+static atomic_int * lock_of(const atomic_uint128_t * const a) {
+	const uintptr_t address = (uintptr_t)a >> 4;
+	return &atomic_locks[(address ^ (address >> 6) ^ (address >> 12)) % ATOMIC_LOCKS].locked;
+}
+
+static atomic_int * lock(const atomic_uint128_t * const a) {
+	atomic_int * const locked = lock_of(a);
+	while (atomic_exchange(locked, 1)) {
+		// wait without writing to the cache line until the lock looks free
+		while (atomic_load_explicit(locked, memory_order_relaxed)) {
+#if defined(__SSE2__)
+			_mm_pause();
+#endif
+		}
+	}
+	return locked;
+}
+
+static void unlock(atomic_int * const locked) {
+	atomic_store(locked, 0);
+}
+
+static inline uint128_t update_locked(atomic_uint128_t * const a, const update_function update,
+									  const uint128_t operand) {
+	atomic_int * const locked = lock(a);
+	const uint128_t previous = a->value;
+	a->value = update(previous, operand);
+	unlock(locked);
+	return previous;
+}
+
+static int compare_exchange_locked(atomic_uint128_t * const a, uint128_t * const expected, const uint128_t desired) {
+	atomic_int * const locked = lock(a);
+	const uint128_t previous = a->value;
+	const int swapped = uint128_equ(previous, *expected);
+	if (swapped)
+		a->value = desired;
+	unlock(locked);
+	*expected = previous;
+	return swapped;
+}
+
+static uint128_t load_locked(atomic_uint128_t * const a) {
+	return update_locked(a, update_keep, uint128_value(0));
+}
+
+static uint128_t exchange_locked(atomic_uint128_t * const a, const uint128_t value) {
+	return update_locked(a, update_replace, value);
+}
+
+static uint128_t fetch_add_locked(atomic_uint128_t * const a, const uint128_t value) {
+	return update_locked(a, update_add, value);
+}
+
+static uint128_t fetch_or_locked(atomic_uint128_t * const a, const uint128_t value) {
+	return update_locked(a, update_or, value);
+}
+#endif
+
+/// Public functions
+
+#if CREN_INTS_ATOMIC_DISPATCH
+/* Whether the CPU supports cmpxchg16b, which the very first x86-64 CPUs didn't */
+__attribute__((no_sanitize_address, no_sanitize_thread)) static int cpu_has_cmpxchg16b(void) {
+	unsigned eax, ebx, ecx, edx;
+	return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_CMPXCHG16B) != 0;
+}
+
+// Defines the public function atomic_uint128_<name>, which is resolved to either <name>_native or <name>_locked
+#define ATOMIC_OPERATION(return_type, name, params, args) \
+	__attribute__((no_sanitize_address, no_sanitize_thread)) \
+	static return_type (*atomic_uint128_##name##_resolve(void)) params { \
+		return cpu_has_cmpxchg16b() ? name##_native : name##_locked; \
+	} \
+	return_type atomic_uint128_##name params __attribute__((ifunc("atomic_uint128_" #name "_resolve")));
+#else
+#if CREN_INTS_ATOMIC_NATIVE
+#define ATOMIC_IMPLEMENTATION(name) name##_native
+#else
+#define ATOMIC_IMPLEMENTATION(name) name##_locked
+#endif
+#define ATOMIC_OPERATION(return_type, name, params, args) \
+	return_type atomic_uint128_##name params { \
+		return ATOMIC_IMPLEMENTATION(name) args; \
+	}
+#endif
+
+void atomic_uint128_init(atomic_uint128_t * const a, const uint128_t value) {
+	a->value = value;
+}
+
+int atomic_uint128_is_lock_free(const atomic_uint128_t * const a) {
+	(void)a;
+#if CREN_INTS_ATOMIC_DISPATCH
+	return cpu_has_cmpxchg16b();
+#else
+	return CREN_INTS_ATOMIC_NATIVE;
+#endif
+}
+
+ATOMIC_OPERATION(uint128_t, load, (atomic_uint128_t * const a), (a))
+ATOMIC_OPERATION(uint128_t, exchange, (atomic_uint128_t * const a, const uint128_t value), (a, value))
+ATOMIC_OPERATION(int, compare_exchange, (atomic_uint128_t * const a, uint128_t * const expected,
+										 const uint128_t desired), (a, expected, desired))
+ATOMIC_OPERATION(uint128_t, fetch_add, (atomic_uint128_t * const a, const uint128_t value), (a, value))
+ATOMIC_OPERATION(uint128_t, fetch_or, (atomic_uint128_t * const a, const uint128_t value), (a, value))
+
+void atomic_uint128_store(atomic_uint128_t * const a, const uint128_t value) {
+	atomic_uint128_exchange(a, value);
+}
@@ -0,0 +1,31 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the loads and stores of 64-bit words in little-endian from unaligned bytes, used by
+// the encodings which work on the halves of the values, the whole values use uint128_load_le/uint128_store_le.
+
+#ifndef CREN_INTEGERS_UINT128_BYTES_H
+#define CREN_INTEGERS_UINT128_BYTES_H
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+
+static inline uint64_t load_uint64_le(const unsigned char * const bytes) {
+	uint64_t word;
+	memcpy(&word, bytes, sizeof(word));
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	word = i_uint128_byte_swap_uint64(word);
+#endif
+	return word;
+}
+
+static inline void store_uint64_le(unsigned char * const bytes, uint64_t word) {
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	word = i_uint128_byte_swap_uint64(word);
+#endif
+	memcpy(bytes, &word, sizeof(word));
+}
+
+#endif //CREN_INTEGERS_UINT128_BYTES_H
@@ -0,0 +1,235 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_column.h"
+#include "uint128_bytes.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define COLUMN_MMAP_AVAILABLE 1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define COLUMN_VERSION 1
+#define COLUMN_VALUE_SIZE 16
+// The statistics of a block are its smallest and largest value
+#define COLUMN_STATISTICS_SIZE (2 * COLUMN_VALUE_SIZE)
+// The number of values in a block is a multiple of this, so that every block starts at a 4 KB boundary
+#define COLUMN_BLOCK_GRANULARITY (UINT128_COLUMN_DATA_ALIGNMENT / COLUMN_VALUE_SIZE)
+
+// Offsets of the fields of the header, the rest of it is zeroes
+static const char COLUMN_MAGIC[8] = {'C', 'R', 'E', 'N', 'U', '1', '2', '8'};
+#define HEADER_VERSION 8
+#define HEADER_VALUES 16
+#define HEADER_BLOCK_VALUES 24
+#define HEADER_STATISTICS 32
+#define HEADER_DATA 40
+
+/* Number of blocks of the values */
+static inline uint64_t column_blocks(const uint64_t values, const uint64_t block_values) {
+	return values == 0 ? 0 : (values - 1) / block_values + 1;
+}
+
+/* Offset of the values, the first aligned offset after the statistics */
+static inline uint64_t column_data_offset(const uint64_t blocks) {
+	const uint64_t statistics_end = UINT128_COLUMN_HEADER_SIZE + COLUMN_STATISTICS_SIZE * blocks;
+	return (statistics_end + UINT128_COLUMN_DATA_ALIGNMENT - 1) / UINT128_COLUMN_DATA_ALIGNMENT *
+		UINT128_COLUMN_DATA_ALIGNMENT;
+}
+
+/// Writing
+
+uint128_column_status uint128_column_write(const char * const path, const uint128_t * const values, const size_t n,
+										   const size_t block_values_or_default) {
+	const size_t block_values = block_values_or_default == 0 ? UINT128_COLUMN_BLOCK_VALUES : block_values_or_default;
+	if (block_values % COLUMN_BLOCK_GRANULARITY != 0)
+		return UINT128_COLUMN_INVALID;
+	FILE * const file = fopen(path, "wb");
+	if (file == NULL)
+		return UINT128_COLUMN_FILE_ERROR;
+
+	const uint64_t blocks = column_blocks(n, block_values);
+	const uint64_t data_offset = column_data_offset(blocks);
+	unsigned char header[UINT128_COLUMN_HEADER_SIZE] = {0};
+	memcpy(header, COLUMN_MAGIC, sizeof(COLUMN_MAGIC));
+	store_uint64_le(header + HEADER_VERSION, COLUMN_VERSION);
+	store_uint64_le(header + HEADER_VALUES, n);
+	store_uint64_le(header + HEADER_BLOCK_VALUES, block_values);
+	store_uint64_le(header + HEADER_STATISTICS, UINT128_COLUMN_HEADER_SIZE);
+	store_uint64_le(header + HEADER_DATA, data_offset);
+	int written = fwrite(header, sizeof(header), 1, file) == 1;
+
+	for (size_t first = 0; written && first < n; first += block_values) {
+		const size_t end = n - first < block_values ? n : first + block_values;
+		uint128_t min = values[first], max = values[first];
+		for (size_t i = first + 1; i < end; i++) {
+			min = uint128_lt(values[i], min) ? values[i] : min;
+			max = uint128_lt(max, values[i]) ? values[i] : max;
+		}
+		unsigned char statistics[COLUMN_STATISTICS_SIZE];
+		uint128_store_le(statistics, min);
+		uint128_store_le(statistics + COLUMN_VALUE_SIZE, max);
+		written = fwrite(statistics, sizeof(statistics), 1, file) == 1;
+	}
+
+	static const unsigned char padding[UINT128_COLUMN_DATA_ALIGNMENT] = {0};
+	const size_t padding_size = (size_t)(data_offset - UINT128_COLUMN_HEADER_SIZE - COLUMN_STATISTICS_SIZE * blocks);
+	if (written && padding_size != 0)
+		written = fwrite(padding, padding_size, 1, file) == 1;
+
+	// the values are converted into little-endian a page at a time
+	unsigned char page[UINT128_COLUMN_DATA_ALIGNMENT];
+	for (size_t first = 0; written && first < n; first += COLUMN_BLOCK_GRANULARITY) {
+		const size_t count = n - first < COLUMN_BLOCK_GRANULARITY ? n - first : COLUMN_BLOCK_GRANULARITY;
+		for (size_t i = 0; i < count; i++)
+			uint128_store_le(page + COLUMN_VALUE_SIZE * i, values[first + i]);
+		written = fwrite(page, COLUMN_VALUE_SIZE * count, 1, file) == 1;
+	}
+
+	if (fclose(file) != 0)
+		written = 0;
+	return written ? UINT128_COLUMN_OK : UINT128_COLUMN_FILE_ERROR;
+}
+
+/// Reading
+
+#if defined(COLUMN_MMAP_AVAILABLE)
+/* Gives the advice for the pages of the mapping with the size bytes starting at begin */
+static void column_advise(const uint128_column_t * const column, const unsigned char * const begin, const size_t size,
+						  const int advice) {
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t offset = (size_t)(begin - column->mapping);
+	const size_t page_offset = offset / page * page;
+	madvise((void *)(column->mapping + page_offset), offset + size - page_offset, advice);
+}
+#endif
+
+/* Checks the header and fills the fields of the column from it, returns 0 if the header is invalid */
+static int column_parse_header(uint128_column_t * const column) {
+	const unsigned char * const header = column->mapping;
+	const size_t size = column->mapping_size;
+	if (size < UINT128_COLUMN_HEADER_SIZE || memcmp(header, COLUMN_MAGIC, sizeof(COLUMN_MAGIC)) != 0 ||
+		load_uint64_le(header + HEADER_VERSION) != COLUMN_VERSION ||
+		load_uint64_le(header + HEADER_STATISTICS) != UINT128_COLUMN_HEADER_SIZE)
+		return 0;
+	const uint64_t values = load_uint64_le(header + HEADER_VALUES);
+	const uint64_t block_values = load_uint64_le(header + HEADER_BLOCK_VALUES);
+	const uint64_t data_offset = load_uint64_le(header + HEADER_DATA);
+	// the values must fit into the file before anything is multiplied by their number
+	if (block_values == 0 || block_values % COLUMN_BLOCK_GRANULARITY != 0 || values > size / COLUMN_VALUE_SIZE)
+		return 0;
+	const uint64_t blocks = column_blocks(values, block_values);
+	if (data_offset != column_data_offset(blocks) || data_offset > size ||
+		values > (size - data_offset) / COLUMN_VALUE_SIZE)
+		return 0;
+	column->values = (size_t)values;
+	column->block_values = (size_t)block_values;
+	column->blocks = (size_t)blocks;
+	column->statistics = header + UINT128_COLUMN_HEADER_SIZE;
+	column->data = header + data_offset;
+	return 1;
+}
+
+uint128_column_status uint128_column_open(const char * const path, uint128_column_t * const column) {
+#if defined(COLUMN_MMAP_AVAILABLE)
+	const int file = open(path, O_RDONLY);
+	if (file < 0)
+		return UINT128_COLUMN_FILE_ERROR;
+	struct stat file_stat;
+	if (fstat(file, &file_stat) != 0) {
+		close(file);
+		return UINT128_COLUMN_FILE_ERROR;
+	}
+	const size_t size = (size_t)file_stat.st_size;
+	if (size < UINT128_COLUMN_HEADER_SIZE) {
+		close(file);
+		return UINT128_COLUMN_INVALID;
+	}
+	void * const mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, file, 0);
+	close(file);
+	if (mapping == MAP_FAILED)
+		return UINT128_COLUMN_FILE_ERROR;
+
+	column->mapping = mapping;
+	column->mapping_size = size;
+	if (!column_parse_header(column)) {
+		munmap(mapping, size);
+		return UINT128_COLUMN_INVALID;
+	}
+	// the pages are only read in when the queries need them, except for the statistics, which all of them need
+	madvise(mapping, size, MADV_RANDOM);
+	column_advise(column, column->mapping, UINT128_COLUMN_HEADER_SIZE + COLUMN_STATISTICS_SIZE * column->blocks,
+				  MADV_WILLNEED);
+	return UINT128_COLUMN_OK;
+#else
+	(void)path;
+	(void)column;
+	return UINT128_COLUMN_UNSUPPORTED;
+#endif
+}
+
+void uint128_column_close(uint128_column_t * const column) {
+#if defined(COLUMN_MMAP_AVAILABLE)
+	munmap((void *)column->mapping, column->mapping_size);
+#endif
+	column->mapping = NULL;
+	column->mapping_size = 0;
+}
+
+uint128_t uint128_column_get(const uint128_column_t * const column, const size_t index) {
+	return uint128_load_le(column->data + COLUMN_VALUE_SIZE * index);
+}
+
+uint128_t uint128_column_block_min(const uint128_column_t * const column, const size_t block) {
+	return uint128_load_le(column->statistics + COLUMN_STATISTICS_SIZE * block);
+}
+
+uint128_t uint128_column_block_max(const uint128_column_t * const column, const size_t block) {
+	return uint128_load_le(column->statistics + COLUMN_STATISTICS_SIZE * block + COLUMN_VALUE_SIZE);
+}
+
+/// Range queries
+
+size_t uint128_column_range(const uint128_column_t * const column, const uint128_t lo, const uint128_t hi,
+							size_t * const indices, const size_t capacity) {
+	size_t found = 0;
+	if (!uint128_lt(lo, hi))
+		return 0;
+	for (size_t block = 0; block < column->blocks; block++) {
+		const uint128_t min = uint128_column_block_min(column, block), max = uint128_column_block_max(column, block);
+		if (uint128_lt(max, lo) || !uint128_lt(min, hi))
+			continue;
+		const size_t first = block * column->block_values;
+		const size_t end = column->values - first < column->block_values ? column->values :
+			first + column->block_values;
+
+		if (!uint128_lt(min, lo) && uint128_lt(max, hi)) {
+			// all values of the block are in the range
+			for (size_t i = first; i < end && found + (i - first) < capacity; i++)
+				indices[found + (i - first)] = i;
+			found += end - first;
+			continue;
+		}
+#if defined(COLUMN_MMAP_AVAILABLE)
+		column_advise(column, column->data + COLUMN_VALUE_SIZE * first, COLUMN_VALUE_SIZE * (end - first),
+					  MADV_WILLNEED);
+#endif
+		for (size_t i = first; i < end; i++) {
+			const uint128_t value = uint128_load_le(column->data + COLUMN_VALUE_SIZE * i);
+			if (!uint128_lt(value, lo) && uint128_lt(value, hi)) {
+				if (found < capacity)
+					indices[found] = i;
+				found++;
+			}
+		}
+	}
+	return found;
+}
@@ -0,0 +1,288 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_convert.h"
+#include "uint128_division.h"
+#include "uint128_threads.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CONVERT_MMAP_AVAILABLE 1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Every thread gets at least this many bytes of text, otherwise there are fewer threads
+#define CONVERT_THREAD_BYTES (1u << 16)
+#define CONVERT_MAX_THREADS UINT128_CONVERT_MAX_CHUNKS
+
+/// Finding the line ends
+
+/* Returns the mask of the newlines in the 64 bytes starting at text, bit i is set if text[i] is a newline */
+static inline uint64_t newline_mask(const char * const text) {
+#if defined(__SSE2__)
+	const __m128i newline = _mm_set1_epi8('\n');
+	uint64_t mask = 0;
+	for (unsigned i = 0; i < 4; i++) {
+		const __m128i bytes = _mm_loadu_si128((const __m128i *)(text + 16 * i));
+		mask |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)) << (16 * i);
+	}
+	return mask;
+#else
+	uint64_t mask = 0;
+	for (unsigned i = 0; i < 64; i++)
+		mask |= (uint64_t)(text[i] == '\n') << i;
+	return mask;
+#endif
+}
+
+/* Counts the lines in [begin, end), the last one doesn't need to end with a newline */
+static size_t count_lines(const char * const begin, const char * const end) {
+	size_t lines = 0;
+	const char *position = begin;
+	for (; end - position >= 64; position += 64)
+		lines += count_bits(newline_mask(position));
+	for (; position < end; position++)
+		lines += *position == '\n';
+	return lines + (end > begin && end[-1] != '\n');
+}
+
+/// Conversion of the chunks
+
+// The chunk of the text converted by a thread, which starts at a line and ends after a newline (or at the end)
+typedef struct convert_thread {
+	const char *begin;
+	const char *end;
+	int base;
+	unsigned char *output; // where the values of the chunk's lines go
+	size_t first_line; // index of the chunk's first line in the text
+	size_t lines;
+	size_t errors;
+	size_t first_error_line; // index of the first line which couldn't be parsed, from the start of the chunk
+	uint128_parse_status first_error_status;
+} convert_thread;
+
+static void * convert_count(void * const argument) {
+	convert_thread * const thread = argument;
+	thread->lines = count_lines(thread->begin, thread->end);
+	return NULL;
+}
+
+/* Parses the line [begin, end) without the newline and stores it as the line-th value of the chunk */
+static inline void convert_line(convert_thread * const thread, const size_t line, const char * const begin,
+								const char *end) {
+	if (end > begin && end[-1] == '\r')
+		end--;
+	uint128_t value = uint128_create(0, 0);
+	const char *stop;
+	uint128_parse_status status = uint128_parse_n(begin, end, thread->base, &value, &stop);
+	if (status == UINT128_PARSE_OK && stop != end)
+		status = UINT128_PARSE_INVALID_DIGIT;
+	if (status != UINT128_PARSE_OK) {
+		value = uint128_create(0, 0);
+		if (thread->errors++ == 0) {
+			thread->first_error_line = line;
+			thread->first_error_status = status;
+		}
+	}
+	uint128_store_le(thread->output + line * UINT128_CONVERT_VALUE_SIZE, value);
+}
+
+static void * convert_parse(void * const argument) {
+	convert_thread * const thread = argument;
+	thread->errors = 0;
+	size_t line = 0;
+	const char *line_begin = thread->begin, *position = thread->begin;
+	for (; thread->end - position >= 64; position += 64) {
+		for (uint64_t mask = newline_mask(position); mask != 0; mask &= mask - 1) {
+			const char * const newline = position + lowest_bit(mask);
+			convert_line(thread, line++, line_begin, newline);
+			line_begin = newline + 1;
+		}
+	}
+	for (; position < thread->end; position++) {
+		if (*position == '\n') {
+			convert_line(thread, line++, line_begin, position);
+			line_begin = position + 1;
+		}
+	}
+	if (line_begin < thread->end)
+		convert_line(thread, line, line_begin, thread->end);
+	return NULL;
+}
+
+/* Splits the text into chunks for the threads and returns their number, every chunk except the last one ends
+ * right after a newline, so some of them may be empty */
+static unsigned split_text(convert_thread * const threads, const char * const text, const size_t length,
+						   const unsigned threads_requested) {
+	unsigned count = threads_requested == 0 ? 1 :
+		threads_requested > CONVERT_MAX_THREADS ? CONVERT_MAX_THREADS : threads_requested;
+	if (length / CONVERT_THREAD_BYTES < count)
+		count = length / CONVERT_THREAD_BYTES == 0 ? 1 : (unsigned)(length / CONVERT_THREAD_BYTES);
+
+	const char * const end = text + length;
+	const char *begin = text;
+	for (unsigned i = 0; i < count; i++) {
+		const char *chunk_end = end;
+		if (i != count - 1) {
+			// the chunk ends after the first newline past its share of the text
+			const char * const split = text + length / count * (i + 1) > begin ? text + length / count * (i + 1) :
+				begin;
+			const char * const newline = memchr(split, '\n', (size_t)(end - split));
+			chunk_end = newline == NULL ? end : newline + 1;
+		}
+		threads[i].begin = begin;
+		threads[i].end = chunk_end;
+		begin = chunk_end;
+	}
+	return count;
+}
+
+/* Splits the text into chunks and counts their lines, so that every chunk knows where its values go in the output,
+ * and returns the number of chunks */
+static unsigned split_count(convert_thread * const threads, const char * const text, const size_t length,
+							const unsigned threads_requested, size_t * const lines) {
+	const unsigned count = split_text(threads, text, length, threads_requested);
+	run_threads(threads, sizeof(threads[0]), count, convert_count);
+	*lines = 0;
+	for (unsigned i = 0; i < count; i++) {
+		threads[i].first_line = *lines;
+		*lines += threads[i].lines;
+	}
+	return count;
+}
+
+/* Parses the lines of the counted chunks into output and merges their results, which are also stored
+ * into chunks unless it is NULL */
+static uint128_convert_result convert_chunks(convert_thread * const threads, const unsigned count, const size_t lines,
+											 const int base_or_auto, unsigned char * const output,
+											 uint128_convert_chunk * const chunks) {
+	for (unsigned i = 0; i < count; i++) {
+		threads[i].base = base_or_auto;
+		threads[i].output = output + threads[i].first_line * UINT128_CONVERT_VALUE_SIZE;
+	}
+	run_threads(threads, sizeof(threads[0]), count, convert_parse);
+
+	uint128_convert_result result = {lines, 0, 0, UINT128_PARSE_OK, count};
+	for (unsigned i = 0; i < count; i++) {
+		const uint128_convert_chunk chunk = {
+			threads[i].first_line, threads[i].lines, threads[i].errors,
+			threads[i].errors != 0 ? threads[i].first_line + threads[i].first_error_line : 0,
+			threads[i].errors != 0 ? threads[i].first_error_status : UINT128_PARSE_OK
+		};
+		if (chunks != NULL)
+			chunks[i] = chunk;
+		if (result.errors == 0 && chunk.errors != 0) {
+			result.first_error_line = chunk.first_error_line;
+			result.first_error_status = chunk.first_error_status;
+		}
+		result.errors += chunk.errors;
+	}
+	return result;
+}
+
+size_t uint128_convert_count(const char * const text, const size_t length, const unsigned threads) {
+	convert_thread thread_states[CONVERT_MAX_THREADS];
+	size_t lines;
+	split_count(thread_states, text, length, threads, &lines);
+	return lines;
+}
+
+uint128_convert_result uint128_convert_chunks(const char * const text, const size_t length, const int base_or_auto,
+											  unsigned char * const output, const unsigned threads,
+											  uint128_convert_chunk * const chunks) {
+	convert_thread thread_states[CONVERT_MAX_THREADS];
+	size_t lines;
+	const unsigned count = split_count(thread_states, text, length, threads, &lines);
+	return convert_chunks(thread_states, count, lines, base_or_auto, output, chunks);
+}
+
+uint128_convert_result uint128_convert(const char * const text, const size_t length, const int base_or_auto,
+									   unsigned char * const output, const unsigned threads) {
+	return uint128_convert_chunks(text, length, base_or_auto, output, threads, NULL);
+}
+
+/// Conversion of files
+
+uint128_convert_file_status uint128_convert_file(const char * const input_path, const char * const output_path,
+												 const int base_or_auto, const unsigned threads,
+												 uint128_convert_result * const result,
+												 uint128_convert_chunk * const chunks) {
+#if defined(CONVERT_MMAP_AVAILABLE)
+	const int input = open(input_path, O_RDONLY);
+	if (input < 0)
+		return UINT128_CONVERT_FILE_INPUT_ERROR;
+	struct stat input_stat;
+	if (fstat(input, &input_stat) != 0) {
+		close(input);
+		return UINT128_CONVERT_FILE_INPUT_ERROR;
+	}
+	const size_t length = (size_t)input_stat.st_size;
+	// empty files can't be mapped, but they are converted into empty files all the same
+	const char *text = "";
+	if (length != 0) {
+		void * const mapping = mmap(NULL, length, PROT_READ, MAP_PRIVATE, input, 0);
+		if (mapping == MAP_FAILED) {
+			close(input);
+			return UINT128_CONVERT_FILE_INPUT_ERROR;
+		}
+		madvise(mapping, length, MADV_SEQUENTIAL);
+		text = mapping;
+	}
+	close(input);
+
+	// the output is sized from the lines of the chunks, which are then parsed without counting them again
+	convert_thread thread_states[CONVERT_MAX_THREADS];
+	size_t lines;
+	const unsigned count = split_count(thread_states, text, length, threads, &lines);
+	uint128_convert_file_status status = UINT128_CONVERT_FILE_OUTPUT_ERROR;
+	const size_t output_size = lines * UINT128_CONVERT_VALUE_SIZE;
+	const int output = open(output_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (output >= 0) {
+		if (ftruncate(output, (off_t)output_size) == 0) {
+			if (output_size == 0) {
+				*result = convert_chunks(thread_states, count, lines, base_or_auto, NULL, chunks);
+				status = UINT128_CONVERT_FILE_OK;
+			} else {
+				void * const mapping = mmap(NULL, output_size, PROT_READ | PROT_WRITE, MAP_SHARED, output, 0);
+				if (mapping != MAP_FAILED) {
+					*result = convert_chunks(thread_states, count, lines, base_or_auto, mapping, chunks);
+					status = munmap(mapping, output_size) == 0 ? UINT128_CONVERT_FILE_OK :
+						UINT128_CONVERT_FILE_OUTPUT_ERROR;
+				}
+			}
+		}
+		// errno keeps the reason of the first error
+		const int error = errno;
+		if (close(output) != 0 && status == UINT128_CONVERT_FILE_OK)
+			status = UINT128_CONVERT_FILE_OUTPUT_ERROR;
+		else
+			errno = error;
+	}
+
+	if (length != 0) {
+		const int error = errno;
+		munmap((void *)text, length);
+		errno = error;
+	}
+	return status;
+#else
+	(void)input_path;
+	(void)output_path;
+	(void)base_or_auto;
+	(void)threads;
+	(void)result;
+	(void)chunks;
+	return UINT128_CONVERT_FILE_UNSUPPORTED;
+#endif
+}
@@ -0,0 +1,165 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the digit tables and helpers shared by the parsing and formatting code of all integer widths.
+// The tables are defined in uint128.c. It isn't part of the public interface.
+
+#ifndef CREN_INTEGERS_UINT128_DIGITS_H
+#define CREN_INTEGERS_UINT128_DIGITS_H
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128_const_division.h"
+
+// Struct defining the largest power of some base which still fits into a 64-bit uint
+typedef struct uint64_base_power {
+	unsigned digits;
+	uint64_t power;
+} uint64_base_power;
+
+// Largest powers of all bases from 2 to 36 which fit into 64 bits, indexed by base - 2
+extern const uint64_base_power LARGEST_BASE_POWERS[];
+
+// Values of all characters as digits (0-9, then a-z case-insensitively), 0xff for characters which aren't digits
+extern const uint8_t DIGIT_VALUES[256];
+
+// Characters of all digits up to base 36
+extern const char DIGIT_CHARACTERS[];
+
+// All two-digit decimal numbers, so that the decimal conversion can write two digits per division
+extern const char DECIMAL_DIGIT_PAIRS[];
+
+// 10^19 is the largest power of 10 fitting into 64 bits, it is already normalized (the highest bit is set)
+#define DECIMAL_CHUNK 10000000000000000000ull
+#define DECIMAL_CHUNK_DIGITS 19
+#define DECIMAL_CHUNK_RECIPROCAL UINT128_CONST_RECIPROCAL(DECIMAL_CHUNK)
+
+/* Determines the base of the number starting at *begin from its prefix (0x, 0o or 0b, in any case), moving *begin
+ * past the prefix. The prefix only counts if it is followed by a digit, otherwise this is just a 0 followed
+ * by something else, and the number is decimal */
+static inline unsigned parse_base_prefix(const char ** const begin, const char * const end) {
+	const char * const digits = *begin;
+	if (end - digits > 2 && digits[0] == '0') {
+		unsigned prefix_base = 0;
+		switch (digits[1]) {
+			case 'x':
+			case 'X':
+				prefix_base = 16;
+				break;
+			case 'o':
+			case 'O':
+				prefix_base = 8;
+				break;
+			case 'b':
+			case 'B':
+				prefix_base = 2;
+				break;
+		}
+		if (prefix_base != 0 && DIGIT_VALUES[(unsigned char)digits[2]] < prefix_base) {
+			*begin = digits + 2;
+			return prefix_base;
+		}
+	}
+	return 10;
+}
+
+/* Checks the arguments of parsing [*begin, end) in the base (0 to detect it from the prefix), the start shared by
+ * the parsers of all integer widths, so that they report the errors the same way. Points *stop at *begin, or at
+ * unused_stop if it is NULL, so that the parsers can always store the stop position. On success stores the base
+ * and moves *begin past its prefix, if there is one */
+static inline uint128_parse_status parse_start(const char ** const begin, const char * const end,
+											   const int base_or_auto, unsigned * const base,
+											   const char *** const stop, const char ** const unused_stop) {
+	if (*stop == NULL)
+		*stop = unused_stop;
+	**stop = *begin;
+
+	if (base_or_auto != 0 && (base_or_auto < 2 || base_or_auto > 36))
+		return UINT128_PARSE_INVALID_BASE;
+	if (*begin == NULL || end == NULL || *begin >= end)
+		return UINT128_PARSE_EMPTY;
+
+	*base = base_or_auto != 0 ? (unsigned)base_or_auto : parse_base_prefix(begin, end);
+	return UINT128_PARSE_OK;
+}
+
+/* Skips the leading zeroes of a number */
+static inline const char * skip_zeroes(const char *begin, const char * const end) {
+	while (begin < end && *begin == '0')
+		begin++;
+	return begin;
+}
+
+// The formatting functions write the digits backwards, ending right before end,
+// and return the pointer to the first written digit
+
+/* Writes exactly 4 decimal digits of a value below 10^4 as two pairs */
+static inline void format_4_digits(const uint32_t value, char * const end) {
+	memcpy(end - 4, DECIMAL_DIGIT_PAIRS + value / 100 * 2, 2);
+	memcpy(end - 2, DECIMAL_DIGIT_PAIRS + value % 100 * 2, 2);
+}
+
+/* Writes exactly 8 decimal digits of a value below 10^8, using 32-bit arithmetic */
+static inline void format_8_digits(const uint32_t value, char * const end) {
+	format_4_digits(value / 10000, end - 4);
+	format_4_digits(value % 10000, end);
+}
+
+/* Writes the decimal digits of a 64-bit uint, 8 digits at a time using 32-bit arithmetic while there are more
+ * than 8 of them, and then two digits per iteration */
+static inline char * format_uint64_decimal(uint64_t value, char *end) {
+	while (value >= 100000000) {
+		format_8_digits((uint32_t)(value % 100000000), end);
+		value /= 100000000;
+		end -= 8;
+	}
+	uint32_t rest = (uint32_t)value;
+	while (rest >= 100) {
+		const unsigned pair = rest % 100 * 2;
+		rest /= 100;
+		*--end = DECIMAL_DIGIT_PAIRS[pair + 1];
+		*--end = DECIMAL_DIGIT_PAIRS[pair];
+	}
+	if (rest >= 10) {
+		*--end = DECIMAL_DIGIT_PAIRS[rest * 2 + 1];
+		*--end = DECIMAL_DIGIT_PAIRS[rest * 2];
+	} else {
+		*--end = (char)('0' + rest);
+	}
+	return end;
+}
+
+/* Writes exactly DECIMAL_CHUNK_DIGITS decimal digits of a value below 10^19 (padded with zeroes). It is split into
+ * independent parts of 3, 8 and 8 digits, so that the parts don't wait for each other's divisions */
+static inline char * format_decimal_chunk(const uint64_t value, char * const end) {
+	const uint64_t lower = value % 10000000000000000ull;
+	const uint32_t highest = (uint32_t)(value / 10000000000000000ull);
+	format_8_digits((uint32_t)(lower % 100000000), end);
+	format_8_digits((uint32_t)(lower / 100000000), end - 8);
+	end[-19] = (char)('0' + highest / 100);
+	memcpy(end - 18, DECIMAL_DIGIT_PAIRS + highest % 100 * 2, 2);
+	return end - DECIMAL_CHUNK_DIGITS;
+}
+
+/* Writes the digits of a 64-bit uint in any base */
+static inline char * format_uint64(uint64_t value, char *end, const unsigned base) {
+	if (base == 10)
+		return format_uint64_decimal(value, end);
+	do {
+		*--end = DIGIT_CHARACTERS[value % base];
+		value /= base;
+	} while (value != 0);
+	return end;
+}
+
+/* Writes the digits of a 64-bit uint in any base, padded with zeroes to exactly digits characters */
+static inline char * format_uint64_padded(const uint64_t value, char * const end, const unsigned base,
+										  const unsigned digits) {
+	char *begin = format_uint64(value, end, base);
+	while (begin > end - digits)
+		*--begin = '0';
+	return begin;
+}
+
+#endif // CREN_INTEGERS_UINT128_DIGITS_H
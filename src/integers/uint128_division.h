@@ -0,0 +1,323 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the division kernels and the runtime dispatch helpers, shared by the translation units
+// of the integers library. It isn't part of the public interface. Translation units other than uint128.c are compiled
+// with CREN_INTEGERS_INLINE (see cmake/Integers_CMakeLists.txt), so that the primitives used by the kernels
+// are inlined into them.
+
+#ifndef CREN_INTEGERS_UINT128_DIVISION_H
+#define CREN_INTEGERS_UINT128_DIVISION_H
+
+#include <stdint.h>
+#include <assert.h>
+#include "integers/uint128.h"
+#include "bitfuncs/bitfuncs.h"
+#include "../cren_compiler.h"
+
+/// Runtime dispatch
+// On x86-64 the division functions are compiled twice: for the baseline ISA and with BMI2 (mulx, shlx/shrx),
+// LZCNT and ADX enabled. The primitives they use are inlined into both versions, and the right version is picked
+// once at startup by a GNU ifunc resolver using cpuid, so a single binary uses the faster kernels where possible.
+// Define CREN_INTS_NO_DISPATCH to disable this, it is also disabled if the target ISA already has these extensions.
+// The resolvers run before AddressSanitizer and ThreadSanitizer are initialized, so they mustn't be instrumented
+// by either of them. The other dispatched functions of the library are only compiled if CREN_INTS_IFUNC_AVAILABLE.
+#if CREN_IFUNC_AVAILABLE && !defined(CREN_INTS_NO_DISPATCH)
+#define CREN_INTS_IFUNC_AVAILABLE 1
+#else
+#define CREN_INTS_IFUNC_AVAILABLE 0
+#endif
+
+#if CREN_INTS_IFUNC_AVAILABLE && !(defined(__BMI2__) && defined(__LZCNT__))
+#define CREN_INTS_DISPATCH_TARGET "bmi2,lzcnt,adx"
+// Defines the function "return_type name params" with the body following the macro, dispatched at runtime
+#define CREN_INTS_DISPATCHED(return_type, name, params, args) \
+	static inline __attribute__((always_inline)) return_type name##_body params; \
+	__attribute__((target(CREN_INTS_DISPATCH_TARGET))) static return_type name##_bmi2 params { \
+		return name##_body args; \
+	} \
+	static return_type name##_baseline params { \
+		return name##_body args; \
+	} \
+	__attribute__((no_sanitize_address, no_sanitize_thread)) static return_type (*name##_resolve(void)) params { \
+		__builtin_cpu_init(); \
+		return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("lzcnt") && __builtin_cpu_supports("adx") ? \
+			   name##_bmi2 : name##_baseline; \
+	} \
+	return_type name params __attribute__((ifunc(#name "_resolve"))); \
+	static inline __attribute__((always_inline)) return_type name##_body params
+// The same for the functions returning void, which can't return the result of the body
+#define CREN_INTS_DISPATCHED_VOID(name, params, args) \
+	static inline __attribute__((always_inline)) void name##_body params; \
+	__attribute__((target(CREN_INTS_DISPATCH_TARGET))) static void name##_bmi2 params { \
+		name##_body args; \
+	} \
+	static void name##_baseline params { \
+		name##_body args; \
+	} \
+	__attribute__((no_sanitize_address, no_sanitize_thread)) static void (*name##_resolve(void)) params { \
+		__builtin_cpu_init(); \
+		return __builtin_cpu_supports("bmi2") && __builtin_cpu_supports("lzcnt") && __builtin_cpu_supports("adx") ? \
+			   name##_bmi2 : name##_baseline; \
+	} \
+	void name params __attribute__((ifunc(#name "_resolve"))); \
+	static inline __attribute__((always_inline)) void name##_body params
+#else
+#define CREN_INTS_DISPATCHED(return_type, name, params, args) return_type name params
+#define CREN_INTS_DISPATCHED_VOID(name, params, args) void name params
+#endif
+
+/// Bits
+// The bitfuncs functions are calls, these are inlined wherever the compiler has the builtins
+
+/* Index of the lowest set bit of a non-zero mask */
+static inline unsigned lowest_bit(const uint64_t mask) {
+#if defined(__GNUC__)
+	return (unsigned)__builtin_ctzll(mask);
+#else
+	return uint64_ctz(mask);
+#endif
+}
+
+/* Index of the highest set bit of a non-zero mask */
+static inline unsigned highest_bit(const uint64_t mask) {
+#if defined(__GNUC__)
+	return 63 - (unsigned)__builtin_clzll(mask);
+#else
+	return 63 - uint64_clz(mask);
+#endif
+}
+
+/* Number of trailing zero bits of a non-zero 128-bit uint */
+static inline unsigned uint128_ctz(const uint128_t a) {
+	const uint64_t lo = uint128_get_lower(a);
+	return lo != 0 ? lowest_bit(lo) : 64 + lowest_bit(uint128_get_higher(a));
+}
+
+/* Number of bits of a 128-bit uint without the leading zeroes */
+static inline unsigned uint128_bit_length(const uint128_t a) {
+	const uint64_t hi = uint128_get_higher(a), lo = uint128_get_lower(a);
+	return hi != 0 ? 65 + highest_bit(hi) : lo != 0 ? 1 + highest_bit(lo) : 0;
+}
+
+/* Number of set bits of a mask, bitfuncs doesn't have a popcount */
+static inline unsigned count_bits(const uint64_t mask) {
+#if defined(__GNUC__)
+	return (unsigned)__builtin_popcountll(mask);
+#else
+	unsigned count = 0;
+	for (uint64_t bits = mask; bits != 0; bits &= bits - 1)
+		count++;
+	return count;
+#endif
+}
+
+/// Division kernels
+// The division algorithm here is the optimized division by reciprocal, given in gmplib.org/~tege/division-paper.pdf
+// (Improved division by invariant integers)
+
+// Table of reciprocals of the top 9 bits of a normalized divisor, defined in uint128.c
+extern const uint16_t small_reciprocal_table[];
+
+// Helper defines here since we need these a lot in this part, because we will use this division even
+// if uint128 is present in compiler, cause this is more optimized currently
+#define gethi(a) uint128_get_higher(a)
+#define getlo(a) uint128_get_lower(a)
+
+// Reciprocal-computing algorithm based on Newton's method, described in the GMPlib paper
+static inline uint64_t reciprocal_128_by_64(const uint64_t divisor) {
+	const uint64_t divisor_least_sig_bit = divisor & 1;
+	const uint64_t divisor_top_9_bits = divisor >> 55; // round-down
+	const uint64_t divisor_top_40_bits = (divisor >> 24) + 1; // round-down
+	const uint64_t divisor_top_63_bits = (divisor >> 1) + divisor_least_sig_bit; // round-up
+
+	const uint32_t v0 = small_reciprocal_table[divisor_top_9_bits - 256]; // table lookup of the top bits, iteration 0
+
+	const uint64_t v1 = (v0 << 11) - (uint32_t)(v0 * v0 * divisor_top_40_bits >> 40) - 1; // iteration 1
+	const uint64_t v2 = (v1 << 13) + (v1 * (0x1000000000000000ull - v1 * divisor_top_40_bits) >> 47); // iteration 2
+
+	const uint64_t e = ((v2 >> 1) & (0 - divisor_least_sig_bit)) - v2 * divisor_top_63_bits;
+	const uint64_t v3 = (gethi(uint64_multiply(v2, e)) >> 1) + (v2 << 31); // iteration 3
+	const uint64_t v4 = v3 - gethi(uint128_add_uint64(uint64_multiply(v3, divisor), divisor)) - divisor; // iteration 4
+	return v4;
+}
+
+// Reciprocal algorithm based on the previous one for computing a reciprocal of a 128-bit uint over 196 bits
+static inline uint64_t reciprocal_196_by_128(const uint128_t divisor) {
+	uint64_t v = reciprocal_128_by_64(gethi(divisor));
+	uint64_t p = gethi(divisor) * v + getlo(divisor);
+	if (p < getlo(divisor)) {
+		v--;
+		if (p >= gethi(divisor)) {
+			v--;
+			p -= gethi(divisor);
+		}
+		p -= gethi(divisor);
+	}
+
+	const uint128_t t = uint64_multiply(v, getlo(divisor));
+	p += gethi(t);
+	if (p < gethi(t)) {
+		v--;
+		if (p >= gethi(divisor)) {
+			if (p > gethi(divisor) || getlo(t) >= getlo(divisor))
+				v--;
+		}
+	}
+	return v;
+}
+
+/* Normalizes the divisor and computes its reciprocal. If the divisor has no 0-bits on the left, then the quotient
+ * of a 128-bit uint is either 1 or 0, so the reciprocal is only computed if always_reciprocal is set (the modular
+ * reduction needs it, since its dividends are up to 256 bits long) */
+static inline uint128_divisor_t divisor_init(const uint128_t b, const int always_reciprocal) {
+	if (gethi(b) == 0) {
+		assert(getlo(b) != 0);	// dividing by 0
+
+		const unsigned left_shift = uint64_clz(getlo(b));
+		const uint64_t divisor = getlo(b) << left_shift;
+		return (uint128_divisor_t){.divisor = uint128_create(0, divisor),
+								   .reciprocal = reciprocal_128_by_64(divisor),
+								   .shift = left_shift};
+	}
+
+	const unsigned left_shift = uint64_clz(gethi(b));
+	if (left_shift == 0 && !always_reciprocal)
+		return (uint128_divisor_t){.divisor = b, .reciprocal = 0, .shift = 0};
+
+	const uint128_t divisor = uint128_shift_left(b, left_shift);
+	return (uint128_divisor_t){.divisor = divisor,
+							   .reciprocal = reciprocal_196_by_128(divisor),
+							   .shift = left_shift};
+}
+
+// Struct defining the result of dividing a 128-bit uint by a 64-bit uint
+typedef struct uint128_div_uint64_result {
+	uint64_t quotient, remainder;
+} uint128_div_uint64_result;
+
+// Helper functions to increment/decrement the higher 64-bit part of the 128-bit uint
+static inline uint128_t uint128_increment_higher(uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return a + ((uint128_t)(1) << 64);
+#else
+	return (uint128_t){.hi = a.hi + 1, .lo = a.lo};
+#endif
+}
+
+static inline uint128_t uint128_decrement_higher(uint128_t a) {
+#if COMPILER_INT128_AVAILABLE
+	return a - ((uint128_t)(1) << 64);
+#else
+	return (uint128_t){.hi = a.hi - 1, .lo = a.lo};
+#endif
+}
+
+// Algorithm div_2by1 from the paper
+static inline uint128_div_uint64_result divrem_uint128_by_uint64(const uint128_t a, const uint64_t divisor,
+																 const uint64_t reciprocal) {
+	uint128_t quotient_guess = uint64_multiply(reciprocal, gethi(a));
+	quotient_guess = uint128_add(quotient_guess, a);
+	quotient_guess = uint128_increment_higher(quotient_guess);
+
+	uint64_t remainder_guess = getlo(a) - gethi(quotient_guess) * divisor;
+	if (remainder_guess > getlo(quotient_guess)) {
+		quotient_guess = uint128_decrement_higher(quotient_guess);
+		remainder_guess += divisor;
+	}
+	if (remainder_guess >= divisor) {
+		quotient_guess = uint128_increment_higher(quotient_guess);
+		remainder_guess -= divisor;
+	}
+
+	return (uint128_div_uint64_result){.quotient = gethi(quotient_guess), .remainder = remainder_guess};
+}
+
+// On x86-64 a 128-bit dividend can be divided by a 64-bit divisor using a single div instruction, if the quotient
+// fits into 64 bits. For a divisor used only once this is cheaper than computing its reciprocal.
+// Define CREN_INTS_NO_DIV_INSTRUCTION to always use the reciprocals instead
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__)) && !defined(CREN_INTS_NO_DIV_INSTRUCTION)
+#define CREN_INTS_DIV_INSTRUCTION 1
+#else
+#define CREN_INTS_DIV_INSTRUCTION 0
+#endif
+
+/* Divides a 128-bit uint by a non-zero 64-bit uint without a precomputed reciprocal, when the quotient is known
+ * to fit into 64 bits (the higher bits of the dividend are less than the divisor). Without the div instruction
+ * the divisor gets normalized and the reciprocal is computed anyway */
+static inline uint128_div_uint64_result divrem_uint128_by_uint64_once(const uint128_t a, const uint64_t divisor) {
+#if CREN_INTS_DIV_INSTRUCTION
+	uint64_t quotient, remainder;
+	__asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(getlo(a)), "d"(gethi(a)), "rm"(divisor));
+	return (uint128_div_uint64_result){.quotient = quotient, .remainder = remainder};
+#else
+	const unsigned shift = uint64_clz(divisor);
+	const uint64_t normalized = divisor << shift;
+	// the shift by 64 - shift is split in two so that it is defined even when shift is 0
+	const uint128_t dividend = uint128_create((gethi(a) << shift) | ((getlo(a) >> 1) >> (63 - shift)),
+											  getlo(a) << shift);
+	uint128_div_uint64_result result = divrem_uint128_by_uint64(dividend, normalized,
+																reciprocal_128_by_64(normalized));
+	result.remainder >>= shift;
+	return result;
+#endif
+}
+
+/// Inverses modulo 2^64 and 2^128
+
+/* Computes the inverse of an odd 64-bit uint modulo 2^64 using Newton's iteration, every step doubles the number
+ * of correct bits. This is the form from Dumas' "On Newton-Raphson iteration for multiplicative inverses modulo
+ * prime powers", where the error term is squared independently of the inverse, so every step adds
+ * a single multiplication to the dependency chain instead of two */
+static inline uint64_t inverse_uint64(const uint64_t d) {
+	// 3d xor 2 is the inverse modulo 2^5 for any odd d
+	uint64_t inverse = (3 * d) ^ 2;
+	uint64_t error = 1 - d * inverse;
+	for (int i = 0; i < 3; i++) {
+		inverse *= 1 + error;
+		error *= error;
+	}
+	return inverse * (1 + error);
+}
+
+/* Computes the inverse of an odd 128-bit uint modulo 2^128, one more step of the iteration after the 64-bit one */
+static inline uint128_t inverse_uint128(const uint128_t d) {
+	const uint128_t inverse = uint128_create(0, inverse_uint64(getlo(d)));
+	return uint128_multiply(inverse, uint128_subtract(uint128_create(0, 2), uint128_multiply(d, inverse)));
+}
+
+// Struct defining the result of dividing a 196-bit uint by a 128-bit uint
+typedef struct uint196_div_uint128_result {
+	uint64_t quotient;
+	uint128_t remainder;
+} uint196_div_uint128_result;
+
+// Algorithm div_3by2 from the paper
+static inline uint196_div_uint128_result divrem_uint196_by_uint128(const uint64_t a2, const uint64_t a1,
+																   const uint64_t a0, const uint128_t divisor,
+																   const uint64_t reciprocal) {
+	uint128_t quotient_guess = uint64_multiply(reciprocal, a2);
+	quotient_guess = uint128_add(quotient_guess, uint128_create(a2, a1));
+
+	uint64_t remainder_higher = a1 - gethi(quotient_guess) * gethi(divisor);
+	uint128_t temporary = uint64_multiply(getlo(divisor), gethi(quotient_guess));
+
+	uint128_t remainder_guess = uint128_subtract(
+		uint128_subtract(uint128_create(remainder_higher, a0), temporary), divisor);
+	remainder_higher = gethi(remainder_guess);
+	quotient_guess = uint128_increment_higher(quotient_guess);
+
+	if (remainder_higher >= getlo(quotient_guess)) {
+		quotient_guess = uint128_decrement_higher(quotient_guess);
+		remainder_guess = uint128_add(remainder_guess, divisor);
+	}
+	if (uint128_gte(remainder_guess, divisor)) {
+		quotient_guess = uint128_increment_higher(quotient_guess);
+		remainder_guess = uint128_subtract(remainder_guess, divisor);
+	}
+
+	return (uint196_div_uint128_result){.quotient = gethi(quotient_guess), .remainder = remainder_guess};
+}
+
+#endif // CREN_INTEGERS_UINT128_DIVISION_H
@@ -0,0 +1,319 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdlib.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_map.h"
+#include "bitfuncs/bitfuncs.h"
+#include "uint128_division.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/// Control bytes
+// A full slot has the lower 7 bits of the key's hash in its control byte, so the highest bit is only set
+// for the empty and deleted slots
+
+#define CONTROL_EMPTY 0x80
+#define CONTROL_DELETED 0xfe
+
+/// Groups
+// The control bytes are matched a group at a time, a match is a mask with one bit per slot of the group
+// (every GROUP_BIT_SHIFT-th bit), which can be iterated from the lowest bit
+
+#if defined(__SSE2__)
+#define GROUP_WIDTH 16
+#define GROUP_BIT_SHIFT 0
+
+typedef __m128i group_t;
+
+static inline group_t group_load(const uint8_t * const control) {
+	return _mm_loadu_si128((const __m128i *)control);
+}
+
+static inline uint64_t group_match(const group_t group, const uint8_t hash) {
+	return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)hash)));
+}
+
+static inline uint64_t group_match_empty(const group_t group) {
+	return (uint64_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)CONTROL_EMPTY)));
+}
+
+static inline uint64_t group_match_empty_or_deleted(const group_t group) {
+	return (uint64_t)_mm_movemask_epi8(group);
+}
+#else
+// Without SSE2 a group is 8 control bytes in a 64-bit word, and the match has the highest bit of every matched byte
+// set. group_match may have false positives for bytes right after a match, which are ruled out by comparing the keys
+#define GROUP_WIDTH 8
+#define GROUP_BIT_SHIFT 3
+#define GROUP_LOWEST_BITS 0x0101010101010101ull
+#define GROUP_HIGHEST_BITS 0x8080808080808080ull
+
+typedef uint64_t group_t;
+
+static inline group_t group_load(const uint8_t * const control) {
+	uint64_t group;
+	memcpy(&group, control, sizeof(group));
+#if ENDIANNESS == CREN_INTS_BIG_ENDIAN
+	group = __builtin_bswap64(group);
+#endif
+	return group;
+}
+
+static inline uint64_t group_match(const group_t group, const uint8_t hash) {
+	const uint64_t matched = group ^ (GROUP_LOWEST_BITS * hash);
+	return (matched - GROUP_LOWEST_BITS) & ~matched & GROUP_HIGHEST_BITS;
+}
+
+static inline uint64_t group_match_empty(const group_t group) {
+	// only the empty bytes have the highest bit set and the second lowest one clear
+	return group & ~(group << 6) & GROUP_HIGHEST_BITS;
+}
+
+static inline uint64_t group_match_empty_or_deleted(const group_t group) {
+	return group & GROUP_HIGHEST_BITS;
+}
+#endif
+
+/// Hashing and probing
+
+/* Mixes both halves of the key using a single 64x64-bit multiplication, folding the product's halves together
+ * (the same mixing as in wyhash). The lower 7 bits go into the control byte, the rest select the group */
+static inline uint64_t hash_key(const uint64_t lower, const uint64_t higher) {
+	const uint128_t product = uint64_multiply(lower ^ 0xa0761d6478bd642full, higher ^ 0xe7037ed1a0b428dbull);
+	return uint128_get_higher(product) ^ uint128_get_lower(product);
+}
+
+/* Probe sequence over the groups of the map: the groups start at every slot, and the distance to the next one
+ * grows by a group every time, which visits every group once if the capacity is a power of 2 */
+typedef struct probe_t {
+	size_t position, step;
+} probe_t;
+
+static inline probe_t probe_start(const uint128_map_t * const map, const uint64_t hash) {
+	return (probe_t){.position = (size_t)(hash >> 7) & (map->capacity - 1), .step = 0};
+}
+
+static inline void probe_next(probe_t * const probe, const uint128_map_t * const map) {
+	probe->step += GROUP_WIDTH;
+	probe->position = (probe->position + probe->step) & (map->capacity - 1);
+}
+
+/* Sets the control byte of a slot, along with its copy after the end if it is in the first group */
+static inline void set_control(const uint128_map_t * const map, const size_t slot, const uint8_t control) {
+	map->control[slot] = control;
+	map->control[((slot - (GROUP_WIDTH - 1)) & (map->capacity - 1)) + (GROUP_WIDTH - 1)] = control;
+}
+
+/* Finds the slot of the key, returns capacity if it isn't in the map */
+static inline size_t find_slot(const uint128_map_t * const map, const uint64_t lower, const uint64_t higher,
+							   const uint64_t hash) {
+	if (map->capacity == 0)
+		return 0;
+	probe_t probe = probe_start(map, hash);
+	for (;;) {
+		const group_t group = group_load(map->control + probe.position);
+		for (uint64_t match = group_match(group, hash & 0x7f); match != 0; match &= match - 1) {
+			const size_t slot = (probe.position + (lowest_bit(match) >> GROUP_BIT_SHIFT)) & (map->capacity - 1);
+			const uint128_map_entry * const entry = &map->entries[slot];
+			if (entry->key_lower == lower && entry->key_higher == higher)
+				return slot;
+		}
+		// the key would have been inserted into the empty slot
+		if (group_match_empty(group) != 0)
+			return map->capacity;
+		probe_next(&probe, map);
+	}
+}
+
+/* Finds the first empty or deleted slot on the probe sequence of the hash */
+static inline size_t find_free_slot(const uint128_map_t * const map, const uint64_t hash) {
+	probe_t probe = probe_start(map, hash);
+	for (;;) {
+		const uint64_t free_slots = group_match_empty_or_deleted(group_load(map->control + probe.position));
+		if (free_slots != 0)
+			return (probe.position + (lowest_bit(free_slots) >> GROUP_BIT_SHIFT)) & (map->capacity - 1);
+		probe_next(&probe, map);
+	}
+}
+
+/// Memory
+
+// Largest number of entries whose memory size still fits into size_t
+#define MAX_ENTRIES (SIZE_MAX / (2 * UINT128_MAP_SLOT_SIZE) - GROUP_WIDTH)
+
+/* Number of slots needed to hold the entries, keeping at most 7/8 of the slots used */
+static size_t capacity_for(const size_t entries) {
+	size_t capacity = GROUP_WIDTH;
+	while (capacity - capacity / 8 < entries)
+		capacity *= 2;
+	return capacity;
+}
+
+static size_t allocation_size(const size_t capacity) {
+	return capacity * sizeof(uint128_map_entry) + capacity + GROUP_WIDTH;
+}
+
+/* Moves all of the entries into newly allocated slots, which also drops the deleted ones */
+static int rehash(uint128_map_t * const map, const size_t capacity) {
+	uint128_map_entry * const entries = malloc(allocation_size(capacity));
+	if (entries == NULL)
+		return 0;
+
+	uint128_map_t resized = {.entries = entries, .control = (uint8_t *)(entries + capacity), .capacity = capacity,
+							 .size = map->size, .growth_left = capacity - capacity / 8 - map->size};
+	memset(resized.control, CONTROL_EMPTY, capacity + GROUP_WIDTH);
+	for (size_t slot = 0; slot < map->capacity; slot++) {
+		if (map->control[slot] & 0x80)
+			continue;
+		const uint128_map_entry * const entry = &map->entries[slot];
+		const uint64_t hash = hash_key(entry->key_lower, entry->key_higher);
+		const size_t new_slot = find_free_slot(&resized, hash);
+		set_control(&resized, new_slot, hash & 0x7f);
+		resized.entries[new_slot] = *entry;
+	}
+
+	free(map->entries);
+	*map = resized;
+	return 1;
+}
+
+void uint128_map_init(uint128_map_t * const map) {
+	*map = (uint128_map_t){.entries = NULL, .control = NULL, .capacity = 0, .size = 0, .growth_left = 0};
+}
+
+void uint128_map_free(uint128_map_t * const map) {
+	free(map->entries);
+	uint128_map_init(map);
+}
+
+size_t uint128_map_memory_size(const size_t entries) {
+	if (entries > MAX_ENTRIES)
+		return SIZE_MAX;
+	return entries == 0 ? 0 : allocation_size(capacity_for(entries));
+}
+
+int uint128_map_reserve(uint128_map_t * const map, const size_t entries) {
+	// the deleted slots are counted as used, since they only become free after rehashing
+	if (entries <= map->size || entries - map->size <= map->growth_left)
+		return 1;
+	if (entries > MAX_ENTRIES)
+		return 0;
+	const size_t capacity = capacity_for(entries);
+	return rehash(map, capacity > map->capacity ? capacity : map->capacity);
+}
+
+/// Operations
+
+/* Inserts the key with the hash, which isn't in the map, into its first free slot. Grows the map if there are
+ * no empty slots left, unless the slot is a deleted one, which can be reused */
+static inline uint128_map_status insert_new(uint128_map_t * const map, const uint64_t lower, const uint64_t higher,
+											const uint64_t hash, const uint64_t value) {
+	size_t slot = find_free_slot(map, hash);
+	if (map->growth_left == 0 && map->control[slot] == CONTROL_EMPTY) {
+		// if a lot of the slots are deleted, it is enough to rehash without growing
+		const size_t capacity = map->size * 32 <= map->capacity * 25 ? map->capacity : map->capacity * 2;
+		if (!rehash(map, capacity))
+			return UINT128_MAP_NO_MEMORY;
+		slot = find_free_slot(map, hash);
+	}
+	map->growth_left -= map->control[slot] == CONTROL_EMPTY;
+	map->size++;
+	set_control(map, slot, hash & 0x7f);
+	map->entries[slot] = (uint128_map_entry){.key_lower = lower, .key_higher = higher, .value = value};
+	return UINT128_MAP_INSERTED;
+}
+
+uint128_map_status uint128_map_insert(uint128_map_t * const map, const uint128_t key, const uint64_t value) {
+	if (map->capacity == 0 && !uint128_map_reserve(map, 1))
+		return UINT128_MAP_NO_MEMORY;
+	const uint64_t lower = uint128_get_lower(key), higher = uint128_get_higher(key);
+	const uint64_t hash = hash_key(lower, higher);
+	const size_t slot = find_slot(map, lower, higher, hash);
+	if (slot != map->capacity) {
+		map->entries[slot].value = value;
+		return UINT128_MAP_UPDATED;
+	}
+	return insert_new(map, lower, higher, hash, value);
+}
+
+// Number of keys hashed and prefetched at once by uint128_map_insert_many
+#define INSERT_BATCH 16
+
+uint128_map_status uint128_map_insert_many(uint128_map_t * const map, const uint128_t * const keys,
+										   const uint64_t * const values, const size_t n) {
+	if (n == 0)
+		return UINT128_MAP_INSERTED;
+	if (!uint128_map_reserve(map, map->size + n))
+		return UINT128_MAP_NO_MEMORY;
+
+	uint64_t hashes[INSERT_BATCH];
+	for (size_t start = 0; start < n; start += INSERT_BATCH) {
+		const size_t batch = n - start < INSERT_BATCH ? n - start : INSERT_BATCH;
+		// all of the cache misses of the batch are started before waiting on the first one
+		for (size_t i = 0; i < batch; i++) {
+			hashes[i] = hash_key(uint128_get_lower(keys[start + i]), uint128_get_higher(keys[start + i]));
+#if defined(__GNUC__)
+			const size_t position = probe_start(map, hashes[i]).position;
+			__builtin_prefetch(map->control + position);
+			__builtin_prefetch(map->entries + position);
+#endif
+		}
+		for (size_t i = 0; i < batch; i++) {
+			const uint64_t lower = uint128_get_lower(keys[start + i]), higher = uint128_get_higher(keys[start + i]);
+			const size_t slot = find_slot(map, lower, higher, hashes[i]);
+			if (slot != map->capacity)
+				map->entries[slot].value = values[start + i];
+			else
+				insert_new(map, lower, higher, hashes[i], values[start + i]);	// can't grow after the reserve
+		}
+	}
+	return UINT128_MAP_INSERTED;
+}
+
+uint64_t * uint128_map_find(const uint128_map_t * const map, const uint128_t key) {
+	const uint64_t lower = uint128_get_lower(key), higher = uint128_get_higher(key);
+	const size_t slot = find_slot(map, lower, higher, hash_key(lower, higher));
+	return slot != map->capacity ? &map->entries[slot].value : NULL;
+}
+
+int uint128_map_erase(uint128_map_t * const map, const uint128_t key) {
+	const uint64_t lower = uint128_get_lower(key), higher = uint128_get_higher(key);
+	const size_t slot = find_slot(map, lower, higher, hash_key(lower, higher));
+	if (slot == map->capacity)
+		return 0;
+
+	// if every group containing the slot has had an empty slot since the slot was filled, no probe sequence
+	// could have continued past it, so it can become empty instead of deleted
+	const uint64_t empty_after = group_match_empty(group_load(map->control + slot));
+	const uint64_t empty_before = group_match_empty(
+			group_load(map->control + ((slot - GROUP_WIDTH) & (map->capacity - 1)))
+		);
+	const int never_full = empty_after != 0 && empty_before != 0 &&
+						   (lowest_bit(empty_after) >> GROUP_BIT_SHIFT) +
+						   (GROUP_WIDTH - 1 - (highest_bit(empty_before) >> GROUP_BIT_SHIFT)) < GROUP_WIDTH;
+	set_control(map, slot, never_full ? CONTROL_EMPTY : CONTROL_DELETED);
+	map->growth_left += never_full;
+	map->size--;
+	return 1;
+}
+
+int uint128_map_next(const uint128_map_t * const map, size_t * const position, uint128_t * const key,
+					 uint64_t * const value) {
+	for (size_t slot = *position; slot < map->capacity; slot++) {
+		if (map->control[slot] & 0x80)
+			continue;
+		if (key != NULL)
+			*key = uint128_create(map->entries[slot].key_higher, map->entries[slot].key_lower);
+		if (value != NULL)
+			*value = map->entries[slot].value;
+		*position = slot + 1;
+		return 1;
+	}
+	*position = map->capacity;
+	return 0;
+}
@@ -0,0 +1,341 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <assert.h>
+#include "integers/uint128.h"
+#include "integers/uint128_modular.h"
+#include "bitfuncs/bitfuncs.h"
+#include "uint128_division.h"
+
+/// Reduction by reciprocal
+// This is basically the Barrett reduction, but using the division kernels from the GMP paper, which need a single
+// 64-bit reciprocal of the normalized modulus and do the correction steps for us
+
+/* Reduces the 256-bit uint (hi, lo) modulo the precomputed modulus, hi must be less than the modulus,
+ * which is always the case for a product of two reduced values */
+static inline uint128_t reduce_uint256(const uint128_t hi, const uint128_t lo, const uint128_modulus_t * const modulus) {
+	const unsigned left_shift = modulus->divisor.shift;
+	// the shifts by 64 - left_shift are split in two so that they are defined even when left_shift is 0
+#define shifted_limb(higher, lower) (((higher) << left_shift) | (((lower) >> 1) >> (63 - left_shift)))
+	const uint64_t a4 = (gethi(hi) >> 1) >> (63 - left_shift);
+	const uint64_t a3 = shifted_limb(gethi(hi), getlo(hi));
+	const uint64_t a2 = shifted_limb(getlo(hi), gethi(lo));
+	const uint64_t a1 = shifted_limb(gethi(lo), getlo(lo));
+	const uint64_t a0 = getlo(lo) << left_shift;
+#undef shifted_limb
+
+	const uint128_t divisor = modulus->divisor.divisor;
+	const uint64_t reciprocal = modulus->divisor.reciprocal;
+
+	if (gethi(divisor) == 0) {
+		// here hi < modulus < 2^64, so a4 is always 0 and the dividend is 4 limbs long
+		const uint64_t d = getlo(divisor);
+		uint64_t remainder = divrem_uint128_by_uint64(uint128_create(a3, a2), d, reciprocal).remainder;
+		remainder = divrem_uint128_by_uint64(uint128_create(remainder, a1), d, reciprocal).remainder;
+		remainder = divrem_uint128_by_uint64(uint128_create(remainder, a0), d, reciprocal).remainder;
+		return uint128_create(0, remainder >> left_shift);
+	}
+
+	uint128_t remainder = divrem_uint196_by_uint128(a4, a3, a2, divisor, reciprocal).remainder;
+	remainder = divrem_uint196_by_uint128(gethi(remainder), getlo(remainder), a1, divisor, reciprocal).remainder;
+	remainder = divrem_uint196_by_uint128(gethi(remainder), getlo(remainder), a0, divisor, reciprocal).remainder;
+	return uint128_shift_right(remainder, left_shift);
+}
+
+static inline uint128_t mulmod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus) {
+	const uint128_multiply_full_result product = uint128_multiply_full(a, b);
+	return reduce_uint256(product.hi, product.lo, modulus);
+}
+
+static inline uint128_t addmod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus) {
+	const uint128_t sum = uint128_add(a, b);
+	// the sum can overflow if the modulus is larger than 2^127
+	if (uint128_lt(sum, a) || uint128_gte(sum, modulus->modulus))
+		return uint128_subtract(sum, modulus->modulus);
+	return sum;
+}
+
+static inline uint128_t submod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus) {
+	const uint128_t difference = uint128_subtract(a, b);
+	return uint128_lt(a, b) ? uint128_add(difference, modulus->modulus) : difference;
+}
+
+/// Montgomery multiplication
+
+/* Montgomery reduction (REDC) of the 256-bit uint (hi, lo), hi must be less than the modulus */
+static inline uint128_t montgomery_reduce(const uint128_t hi, const uint128_t lo,
+										  const uint128_modulus_t * const modulus) {
+	// u is chosen so that lo + u * modulus is divisible by 2^128
+	const uint128_t u = uint128_multiply(lo, modulus->montgomery_inverse);
+	const uint128_multiply_full_result um = uint128_multiply_full(u, modulus->modulus);
+
+	// the lower half of the sum is 0, so it only carries if lo isn't 0
+	const uint128_t carry = uint128_create(0, gethi(lo) != 0 || getlo(lo) != 0);
+	const uint128_t partial = uint128_add(hi, um.hi);
+	const uint128_t result = uint128_add(partial, carry);
+	// the result is less than 2 * modulus, but can still overflow if the modulus is larger than 2^127
+	if (uint128_lt(partial, hi) || uint128_lt(result, partial) || uint128_gte(result, modulus->modulus))
+		return uint128_subtract(result, modulus->modulus);
+	return result;
+}
+
+static inline uint128_t montgomery_multiply(const uint128_t a, const uint128_t b,
+											const uint128_modulus_t * const modulus) {
+	const uint128_multiply_full_result product = uint128_multiply_full(a, b);
+	return montgomery_reduce(product.hi, product.lo, modulus);
+}
+
+/* Computes -m^-1 mod 2^128 for an odd m */
+static inline uint128_t montgomery_inverse(const uint128_t m) {
+	return uint128_subtract(uint128_create(0, 0), inverse_uint128(m));
+}
+
+/// Exponentiation
+
+static inline int uint128_bit(const uint128_t a, const unsigned bit) {
+	return (int)((bit >= 64 ? gethi(a) >> (bit - 64) : getlo(a) >> bit) & 1);
+}
+
+/* Left-to-right binary exponentiation of a value in the Montgomery form */
+static inline uint128_t powmod_montgomery(const uint128_t base, const uint128_t exponent,
+										  const uint128_modulus_t * const modulus) {
+	uint128_t result = modulus->montgomery_one;
+	for (unsigned bit = uint128_bit_length(exponent); bit-- > 0;) {
+		result = montgomery_multiply(result, result, modulus);
+		if (uint128_bit(exponent, bit))
+			result = montgomery_multiply(result, base, modulus);
+	}
+	return result;
+}
+
+static inline uint128_t powmod(const uint128_t base, const uint128_t exponent,
+							   const uint128_modulus_t * const modulus) {
+	if (getlo(modulus->modulus) & 1) {
+		const uint128_t base_montgomery = montgomery_multiply(reduce_uint256(uint128_create(0, 0), base, modulus),
+															  modulus->montgomery_r2, modulus);
+		return montgomery_reduce(uint128_create(0, 0), powmod_montgomery(base_montgomery, exponent, modulus),
+								 modulus);
+	}
+
+	const uint128_t base_reduced = reduce_uint256(uint128_create(0, 0), base, modulus);
+	uint128_t result = reduce_uint256(uint128_create(0, 0), uint128_create(0, 1), modulus);
+	for (unsigned bit = uint128_bit_length(exponent); bit-- > 0;) {
+		result = mulmod(result, result, modulus);
+		if (uint128_bit(exponent, bit))
+			result = mulmod(result, base_reduced, modulus);
+	}
+	return result;
+}
+
+/// Modulus context
+
+static inline uint128_modulus_t modulus_init(const uint128_t m) {
+	uint128_modulus_t modulus = {.modulus = m, .divisor = divisor_init(m, 1)};
+	// 2^128 mod m = (2^128 - m) mod m
+	modulus.montgomery_one = reduce_uint256(uint128_create(0, 0), uint128_subtract(uint128_create(0, 0), m), &modulus);
+	modulus.montgomery_r2 = mulmod(modulus.montgomery_one, modulus.montgomery_one, &modulus);
+	modulus.montgomery_inverse = (getlo(m) & 1) ? montgomery_inverse(m) : uint128_create(0, 0);
+	return modulus;
+}
+
+CREN_INTS_DISPATCHED(uint128_modulus_t, uint128_modulus_init, (const uint128_t m), (m)) {
+	return modulus_init(m);
+}
+
+uint128_t uint128_reduce(const uint128_t a, const uint128_modulus_t * const modulus) {
+	return reduce_uint256(uint128_create(0, 0), a, modulus);
+}
+
+uint128_t uint128_addmod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus) {
+	return addmod(a, b, modulus);
+}
+
+uint128_t uint128_submod(const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus) {
+	return submod(a, b, modulus);
+}
+
+CREN_INTS_DISPATCHED(uint128_t, uint128_mulmod,
+					 (const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus),
+					 (a, b, modulus)) {
+	return mulmod(a, b, modulus);
+}
+
+CREN_INTS_DISPATCHED(uint128_t, uint128_powmod,
+					 (const uint128_t base, const uint128_t exponent, const uint128_modulus_t * const modulus),
+					 (base, exponent, modulus)) {
+	return powmod(base, exponent, modulus);
+}
+
+uint128_t uint128_to_montgomery(const uint128_t a, const uint128_modulus_t * const modulus) {
+	assert(getlo(modulus->modulus) & 1);	// Montgomery form requires an odd modulus
+	return montgomery_multiply(reduce_uint256(uint128_create(0, 0), a, modulus), modulus->montgomery_r2, modulus);
+}
+
+uint128_t uint128_from_montgomery(const uint128_t a, const uint128_modulus_t * const modulus) {
+	assert(getlo(modulus->modulus) & 1);	// Montgomery form requires an odd modulus
+	return montgomery_reduce(uint128_create(0, 0), a, modulus);
+}
+
+CREN_INTS_DISPATCHED(uint128_t, uint128_montgomery_multiply,
+					 (const uint128_t a, const uint128_t b, const uint128_modulus_t * const modulus),
+					 (a, b, modulus)) {
+	assert(getlo(modulus->modulus) & 1);	// Montgomery form requires an odd modulus
+	return montgomery_multiply(a, b, modulus);
+}
+
+/// Primality
+
+// The first 13 primes, with these as Miller-Rabin bases the test is exact for all n < 3317044064679887385961981
+// (J. Sorenson, J. Webster, "Strong pseudoprimes to twelve prime bases", 2015)
+static const uint64_t MILLER_RABIN_BASES[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41};
+#define MILLER_RABIN_EXACT_BOUND uint128_create(0x2be69ull, 0x51adc5b22410a5fdull)
+
+/* Strong probable prime test of an odd n > 41 to the given base, all values are in the Montgomery form */
+static inline int miller_rabin(const uint64_t base, const uint128_t odd_part, const unsigned twos,
+							   const uint128_modulus_t * const modulus) {
+	const uint128_t minus_one = uint128_subtract(modulus->modulus, modulus->montgomery_one);
+	const uint128_t base_montgomery = montgomery_multiply(uint128_create(0, base), modulus->montgomery_r2, modulus);
+
+	uint128_t x = powmod_montgomery(base_montgomery, odd_part, modulus);
+	if (uint128_equ(x, modulus->montgomery_one) || uint128_equ(x, minus_one))
+		return 1;
+	for (unsigned i = 1; i < twos; i++) {
+		x = montgomery_multiply(x, x, modulus);
+		if (uint128_equ(x, minus_one))
+			return 1;
+	}
+	return 0;
+}
+
+/* Jacobi symbol (a/n) for an odd n */
+static int jacobi_symbol(uint128_t a, uint128_t n) {
+	int result = 1;
+	a = uint128_mod(a, n);
+	while (gethi(a) != 0 || getlo(a) != 0) {
+		while ((getlo(a) & 1) == 0) {
+			a = uint128_shift_right(a, 1);
+			const uint64_t n_mod_8 = getlo(n) & 7;
+			if (n_mod_8 == 3 || n_mod_8 == 5)
+				result = -result;
+		}
+		const uint128_t swap = a;
+		a = n;
+		n = swap;
+		if ((getlo(a) & 3) == 3 && (getlo(n) & 3) == 3)
+			result = -result;
+		a = uint128_mod(a, n);
+	}
+	return gethi(n) == 0 && getlo(n) == 1 ? result : 0;
+}
+
+static int is_perfect_square(const uint128_t n) {
+	// Newton's method starting from a power of 2 which is not less than the root
+	uint128_t root = uint128_shift_left(uint128_create(0, 1), (uint128_bit_length(n) + 1) / 2);
+	for (;;) {
+		const uint128_t next = uint128_shift_right(uint128_add(root, uint128_divide(n, root)), 1);
+		if (uint128_gte(next, root))
+			break;
+		root = next;
+	}
+	return uint128_equ(uint128_multiply(root, root), n);
+}
+
+/* Halves a reduced value modulo an odd modulus */
+static inline uint128_t halfmod(const uint128_t a, const uint128_modulus_t * const modulus) {
+	if ((getlo(a) & 1) == 0)
+		return uint128_shift_right(a, 1);
+	// (a + m) / 2 without overflowing, both are odd
+	return uint128_add_uint64(uint128_add(uint128_shift_right(a, 1), uint128_shift_right(modulus->modulus, 1)), 1);
+}
+
+/* Converts a small signed value to a value reduced modulo the modulus */
+static inline uint128_t signed_residue(const int64_t value, const uint128_modulus_t * const modulus) {
+	const uint128_t magnitude = reduce_uint256(uint128_create(0, 0),
+											   uint128_create(0, value < 0 ? 0 - (uint64_t)value : (uint64_t)value),
+											   modulus);
+	return value < 0 ? submod(uint128_create(0, 0), magnitude, modulus) : magnitude;
+}
+
+/* Strong Lucas probable prime test of an odd n > 41 which isn't 2^128 - 1, with the parameters chosen using
+ * Selfridge's method: the first D in 5, -7, 9, -11, ... with Jacobi symbol (D/n) = -1, P = 1 and Q = (1 - D) / 4 */
+static int strong_lucas(const uint128_modulus_t * const modulus) {
+	const uint128_t n = modulus->modulus;
+	// there is no such D for perfect squares
+	if (is_perfect_square(n))
+		return 0;
+
+	int64_t d = 5;
+	for (;;) {
+		const int jacobi = jacobi_symbol(d < 0 ? uint128_subtract(n, uint128_create(0, (uint64_t)-d)) :
+												 uint128_create(0, (uint64_t)d), n);
+		if (jacobi == -1)
+			break;
+		if (jacobi == 0 && !(uint128_equ(n, uint128_create(0, d < 0 ? (uint64_t)-d : (uint64_t)d))))
+			return 0;
+		d = d < 0 ? 2 - d : -(d + 2);
+	}
+
+	const uint128_t D = signed_residue(d, modulus);
+	const uint128_t Q = signed_residue((1 - d) / 4, modulus);
+
+	// n + 1 = odd_part * 2^twos, n + 1 isn't 0, since 2^128 - 1 is a multiple of 3 and never gets here
+	const uint128_t n_plus_one = uint128_add_uint64(n, 1);
+	const unsigned twos = uint128_ctz(n_plus_one);
+	const uint128_t odd_part = uint128_shift_right(n_plus_one, twos);
+
+	// U_1 = 1, V_1 = P = 1, going through the bits of odd_part from the top
+	uint128_t U = uint128_create(0, 1), V = uint128_create(0, 1), Qk = Q;
+	for (unsigned bit = uint128_bit_length(odd_part) - 1; bit-- > 0;) {
+		// U_2k = U_k * V_k, V_2k = V_k^2 - 2 * Q^k
+		U = mulmod(U, V, modulus);
+		V = submod(mulmod(V, V, modulus), addmod(Qk, Qk, modulus), modulus);
+		Qk = mulmod(Qk, Qk, modulus);
+		if (uint128_bit(odd_part, bit)) {
+			// U_2k+1 = (P * U_2k + V_2k) / 2, V_2k+1 = (D * U_2k + P * V_2k) / 2
+			const uint128_t next_U = halfmod(addmod(U, V, modulus), modulus);
+			V = halfmod(addmod(mulmod(D, U, modulus), V, modulus), modulus);
+			U = next_U;
+			Qk = mulmod(Qk, Q, modulus);
+		}
+	}
+
+	const uint128_t zero = uint128_create(0, 0);
+	if (uint128_equ(U, zero) || uint128_equ(V, zero))
+		return 1;
+	for (unsigned i = 1; i < twos; i++) {
+		V = submod(mulmod(V, V, modulus), addmod(Qk, Qk, modulus), modulus);
+		if (uint128_equ(V, zero))
+			return 1;
+		Qk = mulmod(Qk, Qk, modulus);
+	}
+	return 0;
+}
+
+CREN_INTS_DISPATCHED(int, uint128_is_prime, (const uint128_t n), (n)) {
+	if (gethi(n) == 0 && getlo(n) <= MILLER_RABIN_BASES[12]) {
+		for (unsigned i = 0; i < 13; i++) {
+			if (getlo(n) == MILLER_RABIN_BASES[i])
+				return 1;
+		}
+		return 0;
+	}
+	for (unsigned i = 0; i < 13; i++) {
+		if (uint128_mod_uint64(n, MILLER_RABIN_BASES[i]) == 0)
+			return 0;
+	}
+
+	// n - 1 = odd_part * 2^twos, n is odd here so n - 1 isn't 0
+	const uint128_t n_minus_one = uint128_subtract_uint64(n, 1);
+	const unsigned twos = uint128_ctz(n_minus_one);
+	const uint128_t odd_part = uint128_shift_right(n_minus_one, twos);
+
+	const uint128_modulus_t modulus = modulus_init(n);
+	for (unsigned i = 0; i < 13; i++) {
+		if (!miller_rabin(MILLER_RABIN_BASES[i], odd_part, twos, &modulus))
+			return 0;
+	}
+	if (uint128_lt(n, MILLER_RABIN_EXACT_BOUND))
+		return 1;
+	return strong_lucas(&modulus);
+}
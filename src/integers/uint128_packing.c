@@ -0,0 +1,277 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_packing.h"
+#include "bitfuncs/bitfuncs.h"
+#include "uint128_division.h"
+#include "uint128_bytes.h"
+
+// The unpacking is compiled for AVX2 along with the scalar version and picked at startup by a GNU ifunc resolver,
+// the same way as the functions of uint128_array.c. AVX-512 doesn't get its own version, since the lanes are laid
+// out for 256-bit vectors, and the unpacking already runs at a few cycles per value
+#if CREN_INTS_IFUNC_AVAILABLE && !defined(__AVX2__)
+#define PACKING_DISPATCH 1
+#define PACKING_AVX2 1
+#define PACKING_AVX2_TARGET __attribute__((target("avx2")))
+#else
+#define PACKING_DISPATCH 0
+#define PACKING_AVX2_TARGET
+#if defined(__x86_64__) && defined(__AVX2__)
+#define PACKING_AVX2 1
+#else
+#define PACKING_AVX2 0
+#endif
+#endif
+
+#if PACKING_AVX2
+#include <immintrin.h>
+#endif
+
+// Offsets of the header fields, the packed differences start right after the header
+#define HEADER_WIDTH 16
+#define HEADER_COUNT 17
+#define PACKING_LANES 4
+
+static inline uint64_t width_mask(const unsigned width) {
+	return width >= 64 ? UINT64_MAX : (1ull << width) - 1;
+}
+
+/* The lower differences take up to 64 bits, the rest of the bits are the higher ones */
+static inline unsigned lower_width(const unsigned width) {
+	return width > 64 ? 64 : width;
+}
+
+/* Returns the size of the block, or 0 if it is invalid or the bytes end before the end of the block */
+static inline size_t block_size(const unsigned char * const bytes, const size_t length) {
+	if (length < UINT128_PACKING_HEADER_SIZE || bytes[HEADER_WIDTH] > 128 || bytes[HEADER_WIDTH] % 2 != 0 ||
+		bytes[HEADER_COUNT] == 0 || bytes[HEADER_COUNT] > UINT128_PACKING_BLOCK_VALUES)
+		return 0;
+	const size_t size = uint128_pack_block_size(bytes[HEADER_WIDTH]);
+	return size <= length ? size : 0;
+}
+
+/// Packing
+// Every stream of packed bits is 4 lanes of 32 values, the word j of the lane l is the word (4 * j + l) of the stream,
+// so the stream of 128 values of some bits takes 16 bytes per bit
+
+/* Packs 128 parts of the values with the number of bits into the stream */
+static void pack_stream(unsigned char * const stream, const uint64_t * const parts, const unsigned width) {
+	uint64_t words[2 * 64] = {0};
+	for (unsigned i = 0; i < UINT128_PACKING_BLOCK_VALUES; i++) {
+		const unsigned lane = i % PACKING_LANES, bit = i / PACKING_LANES * width;
+		const unsigned word = bit / 64 * PACKING_LANES + lane, shift = bit % 64;
+		words[word] |= parts[i] << shift;
+		if (shift + width > 64)
+			words[word + PACKING_LANES] |= parts[i] >> (64 - shift);
+	}
+	for (unsigned i = 0; i < 2 * width; i++)
+		store_uint64_le(stream + 8 * i, words[i]);
+}
+
+/* The smallest of the values, which is the first one if they are sorted */
+static inline uint128_t block_base(const uint128_t * const values, const size_t n) {
+	uint128_t base = values[0];
+	for (size_t i = 1; i < n; i++)
+		base = uint128_lt(values[i], base) ? values[i] : base;
+	return base;
+}
+
+/* Number of bits of the packed differences, all of them or-ed together have as many bits as the largest one,
+ * which is rounded up to an even number, so that the 32 values of every lane end at the end of a word */
+static inline unsigned differences_width(const uint64_t higher_bits, const uint64_t lower_bits) {
+	const unsigned width = higher_bits != 0 ? 128 - uint64_clz(higher_bits) :
+		lower_bits != 0 ? 64 - uint64_clz(lower_bits) : 0;
+	return width + width % 2;
+}
+
+unsigned uint128_pack_width(const uint128_t * const values, const size_t n) {
+	const uint128_t base = block_base(values, n);
+	uint64_t higher_bits = 0, lower_bits = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint128_t difference = uint128_subtract(values[i], base);
+		higher_bits |= gethi(difference);
+		lower_bits |= getlo(difference);
+	}
+	return differences_width(higher_bits, lower_bits);
+}
+
+size_t uint128_pack_block_size(const unsigned width) {
+	return UINT128_PACKING_HEADER_SIZE + 16 * (size_t)width;
+}
+
+size_t uint128_pack_block(const uint128_t * const values, const size_t n, unsigned char * const bytes) {
+	const uint128_t base = block_base(values, n);
+	// the missing values of the last block are packed as zero differences
+	uint64_t higher[UINT128_PACKING_BLOCK_VALUES] = {0}, lower[UINT128_PACKING_BLOCK_VALUES] = {0};
+	uint64_t higher_bits = 0, lower_bits = 0;
+	for (size_t i = 0; i < n; i++) {
+		const uint128_t difference = uint128_subtract(values[i], base);
+		higher[i] = gethi(difference);
+		lower[i] = getlo(difference);
+		higher_bits |= higher[i];
+		lower_bits |= lower[i];
+	}
+	const unsigned width = differences_width(higher_bits, lower_bits);
+
+	uint128_store_le(bytes, base);
+	bytes[HEADER_WIDTH] = (unsigned char)width;
+	bytes[HEADER_COUNT] = (unsigned char)n;
+	unsigned char * const stream = bytes + UINT128_PACKING_HEADER_SIZE;
+	pack_stream(stream, lower, lower_width(width));
+	if (width > 64)
+		pack_stream(stream + 16 * 64, higher, width - 64);
+	return uint128_pack_block_size(width);
+}
+
+/// Scalar unpacking
+
+/* Unpacks the value of the lane from the stream, packed with the number of bits, which mustn't be 0 */
+static inline uint64_t unpack_part(const unsigned char * const stream, const unsigned index, const unsigned width) {
+	const unsigned lane = index % PACKING_LANES, bit = index / PACKING_LANES * width;
+	const unsigned word = bit / 64 * PACKING_LANES + lane, shift = bit % 64;
+	uint64_t part = load_uint64_le(stream + 8 * word) >> shift;
+	if (shift + width > 64)
+		part |= load_uint64_le(stream + 8 * (word + PACKING_LANES)) << (64 - shift);
+	return part & width_mask(width);
+}
+
+static inline uint128_t unpack_value(const unsigned char * const bytes, const uint128_t base, const unsigned index) {
+	const unsigned width = bytes[HEADER_WIDTH];
+	const unsigned char * const stream = bytes + UINT128_PACKING_HEADER_SIZE;
+	const uint64_t lower = width != 0 ? unpack_part(stream, index, lower_width(width)) : 0;
+	const uint64_t higher = width > 64 ? unpack_part(stream + 16 * 64, index, width - 64) : 0;
+	return uint128_add(base, uint128_create(higher, lower));
+}
+
+#if !PACKING_AVX2 || PACKING_DISPATCH
+static void unpack_block_scalar(const unsigned char * const bytes, uint128_t * const values) {
+	const uint128_t base = uint128_load_le(bytes);
+	for (unsigned i = 0; i < bytes[HEADER_COUNT]; i++)
+		values[i] = unpack_value(bytes, base, i);
+}
+#endif
+
+/// AVX2 unpacking
+// The lanes of a vector are the 4 consecutive values, which are shifted by the same number of bits.
+// The carries from the lower halves are added by subtracting the comparison masks, like in uint128_array.c
+
+#if PACKING_AVX2
+/* Unpacks the index-th values of all 4 lanes of the stream, packed with the number of bits, which mustn't be 0 */
+PACKING_AVX2_TARGET static inline __m256i unpack_parts_avx2(const unsigned char * const stream, const unsigned index,
+															 const unsigned width, const __m256i mask) {
+	const unsigned bit = index * width, word = bit / 64, shift = bit % 64;
+	__m256i parts = _mm256_srl_epi64(_mm256_loadu_si256((const __m256i *)(stream + 32 * word)),
+									 _mm_cvtsi32_si128((int)shift));
+	if (shift + width > 64)
+		parts = _mm256_or_si256(parts, _mm256_sll_epi64(_mm256_loadu_si256((const __m256i *)(stream + 32 * word + 32)),
+														_mm_cvtsi32_si128((int)(64 - shift))));
+	return _mm256_and_si256(parts, mask);
+}
+
+PACKING_AVX2_TARGET static void unpack_block_avx2(const unsigned char * const bytes, uint128_t * const values) {
+	const unsigned width = bytes[HEADER_WIDTH], count = bytes[HEADER_COUNT];
+	const unsigned char * const lower_stream = bytes + UINT128_PACKING_HEADER_SIZE;
+	const unsigned char * const higher_stream = lower_stream + 16 * 64;
+	const unsigned lower_bits = lower_width(width), higher_bits = width > 64 ? width - 64 : 0;
+	const __m256i lower_mask = _mm256_set1_epi64x((long long)width_mask(lower_bits));
+	const __m256i higher_mask = _mm256_set1_epi64x((long long)width_mask(higher_bits));
+	const __m256i base_lower = _mm256_set1_epi64x((long long)load_uint64_le(bytes));
+	const __m256i base_higher = _mm256_set1_epi64x((long long)load_uint64_le(bytes + 8));
+	const __m256i sign = _mm256_set1_epi64x(INT64_MIN);
+	unsigned i = 0;
+	for (; i + PACKING_LANES <= count; i += PACKING_LANES) {
+		const unsigned index = i / PACKING_LANES;
+		const __m256i lower_parts = lower_bits != 0 ?
+			unpack_parts_avx2(lower_stream, index, lower_bits, lower_mask) : _mm256_setzero_si256();
+		const __m256i higher_parts = higher_bits != 0 ?
+			unpack_parts_avx2(higher_stream, index, higher_bits, higher_mask) : _mm256_setzero_si256();
+		const __m256i lower = _mm256_add_epi64(lower_parts, base_lower);
+		const __m256i carries = _mm256_cmpgt_epi64(_mm256_xor_si256(lower_parts, sign),
+												   _mm256_xor_si256(lower, sign));
+		const __m256i higher = _mm256_sub_epi64(_mm256_add_epi64(higher_parts, base_higher), carries);
+		// the lanes are the values 0 1 2 3, and the vectors of the halves are interleaved into 0 2 and 1 3
+		const __m256i even = _mm256_unpacklo_epi64(lower, higher), odd = _mm256_unpackhi_epi64(lower, higher);
+		_mm256_storeu_si256((__m256i *)(values + i), _mm256_permute2x128_si256(even, odd, 0x20));
+		_mm256_storeu_si256((__m256i *)(values + i + 2), _mm256_permute2x128_si256(even, odd, 0x31));
+	}
+	const uint128_t base = uint128_load_le(bytes);
+	for (; i < count; i++)
+		values[i] = unpack_value(bytes, base, i);
+}
+#endif
+
+#if PACKING_DISPATCH
+__attribute__((no_sanitize_address, no_sanitize_thread))
+static void (*unpack_block_resolve(void))(const unsigned char *, uint128_t *) {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") ? unpack_block_avx2 : unpack_block_scalar;
+}
+static void unpack_block(const unsigned char *bytes, uint128_t *values) __attribute__((ifunc("unpack_block_resolve")));
+#elif PACKING_AVX2
+#define unpack_block unpack_block_avx2
+#else
+#define unpack_block unpack_block_scalar
+#endif
+
+/// Public functions
+
+size_t uint128_unpack_block(const unsigned char * const bytes, const size_t length, uint128_t * const values) {
+	if (block_size(bytes, length) == 0)
+		return 0;
+	unpack_block(bytes, values);
+	return bytes[HEADER_COUNT];
+}
+
+uint128_t uint128_unpack_block_value(const unsigned char * const bytes, const size_t index) {
+	return unpack_value(bytes, uint128_load_le(bytes), (unsigned)index);
+}
+
+size_t uint128_pack_size(const uint128_t * const values, const size_t n) {
+	size_t size = 0;
+	for (size_t i = 0; i < n; i += UINT128_PACKING_BLOCK_VALUES) {
+		const size_t block = n - i < UINT128_PACKING_BLOCK_VALUES ? n - i : UINT128_PACKING_BLOCK_VALUES;
+		size += uint128_pack_block_size(uint128_pack_width(values + i, block));
+	}
+	return size;
+}
+
+size_t uint128_pack_array(const uint128_t * const values, const size_t n, unsigned char * const bytes) {
+	size_t size = 0;
+	for (size_t i = 0; i < n; i += UINT128_PACKING_BLOCK_VALUES) {
+		const size_t block = n - i < UINT128_PACKING_BLOCK_VALUES ? n - i : UINT128_PACKING_BLOCK_VALUES;
+		size += uint128_pack_block(values + i, block, bytes + size);
+	}
+	return size;
+}
+
+size_t uint128_pack_index(const unsigned char * const bytes, const size_t length, size_t * const offsets,
+						  const size_t blocks) {
+	size_t position = 0;
+	for (size_t i = 0; i < blocks; i++) {
+		const size_t size = block_size(bytes + position, length - position);
+		if (size == 0)
+			return 0;
+		offsets[i] = position;
+		position += size;
+	}
+	return position;
+}
+
+size_t uint128_unpack_array(const unsigned char * const bytes, const size_t length, uint128_t * const values,
+							const size_t n) {
+	size_t position = 0;
+	for (size_t i = 0; i < n; i += UINT128_PACKING_BLOCK_VALUES) {
+		const size_t block = n - i < UINT128_PACKING_BLOCK_VALUES ? n - i : UINT128_PACKING_BLOCK_VALUES;
+		const size_t size = block_size(bytes + position, length - position);
+		// every block except for the last one must be full, so that the values are where they are expected
+		if (size == 0 || bytes[position + HEADER_COUNT] != block)
+			return 0;
+		unpack_block(bytes + position, values + i);
+		position += size;
+	}
+	return position;
+}
@@ -0,0 +1,223 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdlib.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_sort.h"
+#include "uint128_threads.h"
+
+// Arrays (and buckets of the MSD sort) smaller than this are sorted using insertion sort
+#define SORT_SMALL 48
+// Every thread of the LSD sort gets at least this many keys, otherwise there are fewer threads
+#define SORT_THREAD_KEYS (1u << 16)
+#define SORT_MAX_THREADS RUN_THREADS_MAX
+
+/* Sorts the keys using insertion sort */
+static void insertion_sort(uint128_t * const keys, const size_t n) {
+	for (size_t i = 1; i < n; i++) {
+		const uint128_t key = keys[i];
+		size_t j = i;
+		for (; j > 0 && uint128_lt(key, keys[j - 1]); j--)
+			keys[j] = keys[j - 1];
+		keys[j] = key;
+	}
+}
+
+/// LSD radix sort
+// The 128 bits are split into 12 digits of 11 bits (the last one has 7), so every histogram has 2048 counters
+
+#define LSD_DIGIT_BITS 11
+#define LSD_DIGITS ((128 + LSD_DIGIT_BITS - 1) / LSD_DIGIT_BITS)
+#define LSD_BUCKETS (1u << LSD_DIGIT_BITS)
+
+static inline size_t lsd_digit(const uint128_t key, const unsigned digit) {
+	return (size_t)uint128_get_lower(uint128_shift_right(key, digit * LSD_DIGIT_BITS)) & (LSD_BUCKETS - 1);
+}
+
+// The part of the keys processed by a thread, which is the same for all of the passes
+typedef struct sort_thread {
+	const uint128_t *from;
+	uint128_t *to;
+	size_t begin;
+	size_t end;
+	unsigned digit;
+	size_t *counts;	   // histograms of all digits of the thread's keys, LSD_DIGITS * LSD_BUCKETS
+	size_t *offsets;   // histogram of the current digit, turned into the positions of the thread's keys in to
+} sort_thread;
+
+/* Counts all of the digits of the thread's keys at once */
+static void * lsd_count_all(void * const argument) {
+	sort_thread * const thread = argument;
+	memset(thread->counts, 0, LSD_DIGITS * LSD_BUCKETS * sizeof(size_t));
+	for (size_t i = thread->begin; i < thread->end; i++) {
+		const uint64_t lower = uint128_get_lower(thread->from[i]), higher = uint128_get_higher(thread->from[i]);
+		for (unsigned digit = 0; digit < LSD_DIGITS; digit++) {
+			const unsigned shift = digit * LSD_DIGIT_BITS;
+			const uint64_t bits = shift >= 64 ? higher >> (shift - 64) :
+				shift + LSD_DIGIT_BITS > 64 ? (lower >> shift) | (higher << (64 - shift)) : lower >> shift;
+			thread->counts[digit * LSD_BUCKETS + (bits & (LSD_BUCKETS - 1))]++;
+		}
+	}
+	return NULL;
+}
+
+/* Counts the current digit of the thread's keys, which have been moved by the previous pass */
+static void * lsd_count(void * const argument) {
+	sort_thread * const thread = argument;
+	memset(thread->offsets, 0, LSD_BUCKETS * sizeof(size_t));
+	for (size_t i = thread->begin; i < thread->end; i++)
+		thread->offsets[lsd_digit(thread->from[i], thread->digit)]++;
+	return NULL;
+}
+
+/* Moves the thread's keys to their positions for the current digit */
+static void * lsd_scatter(void * const argument) {
+	sort_thread * const thread = argument;
+	size_t * const offsets = thread->offsets;
+	for (size_t i = thread->begin; i < thread->end; i++) {
+		const uint128_t key = thread->from[i];
+		thread->to[offsets[lsd_digit(key, thread->digit)]++] = key;
+	}
+	return NULL;
+}
+
+void uint128_sort(uint128_t * const keys, const size_t n, const unsigned threads) {
+	if (n <= SORT_SMALL) {
+		insertion_sort(keys, n);
+		return;
+	}
+	unsigned count = threads == 0 ? 1 : threads > SORT_MAX_THREADS ? SORT_MAX_THREADS : threads;
+	if (n / SORT_THREAD_KEYS < count)
+		count = n / SORT_THREAD_KEYS == 0 ? 1 : (unsigned)(n / SORT_THREAD_KEYS);
+
+	// the buffer and all of the histograms are a single allocation, the histograms go first, since their size
+	// keeps the buffer aligned
+	const size_t counts_size = (size_t)count * LSD_DIGITS * LSD_BUCKETS * sizeof(size_t);
+	if (n > (SIZE_MAX - counts_size) / sizeof(uint128_t)) {
+		uint128_sort_in_place(keys, n);
+		return;
+	}
+	size_t * const counts = malloc(counts_size + n * sizeof(uint128_t));
+	if (counts == NULL) {
+		uint128_sort_in_place(keys, n);
+		return;
+	}
+	uint128_t * const buffer = (uint128_t *)((char *)counts + counts_size);
+
+	sort_thread thread_states[SORT_MAX_THREADS];
+	for (unsigned i = 0; i < count; i++) {
+		thread_states[i].from = keys;
+		thread_states[i].to = buffer;
+		thread_states[i].begin = n / count * i;
+		thread_states[i].end = i == count - 1 ? n : n / count * (i + 1);
+		thread_states[i].counts = counts + (size_t)i * LSD_DIGITS * LSD_BUCKETS;
+	}
+	run_threads(thread_states, sizeof(thread_states[0]), count, lsd_count_all);
+
+	int first_pass = 1;
+	for (unsigned digit = 0; digit < LSD_DIGITS; digit++) {
+		// the digit is skipped if all of the keys have it the same, which doesn't depend on the order of the keys
+		int skip = 0;
+		for (size_t bucket = 0; bucket < LSD_BUCKETS && !skip; bucket++) {
+			size_t total = 0;
+			for (unsigned i = 0; i < count; i++)
+				total += thread_states[i].counts[digit * LSD_BUCKETS + bucket];
+			skip = total == n;
+		}
+		if (skip)
+			continue;
+
+		// the histograms of the first pass are already known, after that the keys of every thread change
+		for (unsigned i = 0; i < count; i++) {
+			thread_states[i].digit = digit;
+			thread_states[i].offsets = first_pass ? thread_states[i].counts + digit * LSD_BUCKETS :
+				thread_states[i].counts;
+		}
+		if (!first_pass)
+			run_threads(thread_states, sizeof(thread_states[0]), count, lsd_count);
+		first_pass = 0;
+
+		// the keys of a bucket are placed in the order of the threads, so that the sort stays stable
+		size_t position = 0;
+		for (size_t bucket = 0; bucket < LSD_BUCKETS; bucket++) {
+			for (unsigned i = 0; i < count; i++) {
+				const size_t keys_in_bucket = thread_states[i].offsets[bucket];
+				thread_states[i].offsets[bucket] = position;
+				position += keys_in_bucket;
+			}
+		}
+		run_threads(thread_states, sizeof(thread_states[0]), count, lsd_scatter);
+
+		for (unsigned i = 0; i < count; i++) {
+			const uint128_t * const from = thread_states[i].from;
+			thread_states[i].from = thread_states[i].to;
+			thread_states[i].to = (uint128_t *)from;
+		}
+	}
+
+	if (thread_states[0].from != keys)
+		memcpy(keys, thread_states[0].from, n * sizeof(uint128_t));
+	free(counts);
+}
+
+/// MSD radix sort
+// The keys are split by their bytes, starting from the highest one, and every bucket is sorted recursively
+// by the next byte, so the recursion is at most 16 levels deep
+
+static inline size_t msd_digit(const uint128_t key, const unsigned byte) {
+	return (size_t)(byte >= 8 ? uint128_get_higher(key) >> (8 * (byte - 8)) : uint128_get_lower(key) >> (8 * byte))
+		& 0xff;
+}
+
+static void msd_sort(uint128_t * const keys, const size_t n, unsigned byte) {
+	if (n <= SORT_SMALL) {
+		insertion_sort(keys, n);
+		return;
+	}
+
+	size_t ends[256];
+	for (;;) {
+		memset(ends, 0, sizeof(ends));
+		for (size_t i = 0; i < n; i++)
+			ends[msd_digit(keys[i], byte)]++;
+		// the byte is skipped if all of the keys have it the same
+		if (ends[msd_digit(keys[0], byte)] != n)
+			break;
+		if (byte == 0)
+			return;
+		byte--;
+	}
+
+	size_t starts[256], next[256], position = 0;
+	for (size_t bucket = 0; bucket < 256; bucket++) {
+		starts[bucket] = next[bucket] = position;
+		position += ends[bucket];
+		ends[bucket] = position;
+	}
+
+	// every key is swapped into the next free position of its bucket, until a key of the current bucket is found
+	for (size_t bucket = 0; bucket < 256; bucket++) {
+		while (next[bucket] < ends[bucket]) {
+			uint128_t key = keys[next[bucket]];
+			size_t digit = msd_digit(key, byte);
+			while (digit != bucket) {
+				const uint128_t displaced = keys[next[digit]];
+				keys[next[digit]++] = key;
+				key = displaced;
+				digit = msd_digit(key, byte);
+			}
+			keys[next[bucket]++] = key;
+		}
+	}
+
+	if (byte == 0)
+		return;
+	for (size_t bucket = 0; bucket < 256; bucket++)
+		msd_sort(keys + starts[bucket], ends[bucket] - starts[bucket], byte - 1);
+}
+
+void uint128_sort_in_place(uint128_t * const keys, const size_t n) {
+	msd_sort(keys, n, 15);
+}
@@ -0,0 +1,35 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+// Internal header with the helper running a function on several threads, used by the parallel sort
+// and the conversion. Every thread gets its own state from an array of them.
+
+#ifndef CREN_INTEGERS_UINT128_THREADS_H
+#define CREN_INTEGERS_UINT128_THREADS_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+// Maximum number of states run_threads is called with
+#define RUN_THREADS_MAX 64
+
+/* Runs the function for every one of count states of state_size bytes, the first one runs on the calling thread,
+ * as do the ones which couldn't be started */
+static inline void run_threads(void * const states, const size_t state_size, const unsigned count,
+							   void * (* const function)(void *)) {
+	unsigned char * const bytes = states;
+	pthread_t ids[RUN_THREADS_MAX];
+	unsigned started = 1;
+	for (; started < count; started++) {
+		if (pthread_create(&ids[started], NULL, function, bytes + state_size * started) != 0)
+			break;
+	}
+	function(bytes);
+	for (unsigned i = started; i < count; i++)
+		function(bytes + state_size * i);
+	for (unsigned i = 1; i < started; i++)
+		pthread_join(ids[i], NULL);
+}
+
+#endif //CREN_INTEGERS_UINT128_THREADS_H
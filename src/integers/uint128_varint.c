@@ -0,0 +1,223 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <stdint.h>
+#include <string.h>
+#include "integers/uint128.h"
+#include "integers/uint128_varint.h"
+#include "uint128_division.h"
+#include "uint128_bytes.h"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// 24 bytes of ones followed by 24 zero bytes, the bytes starting at (24 - k) keep the first k of up to 24 bytes,
+// which is how the bytes after a value are masked without any branches
+#define BYTE_MASKS_SIZE 24
+static const unsigned char BYTE_MASKS[2 * BYTE_MASKS_SIZE] = {
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+/* Mask of the word-th 64-bit word (in little-endian) of 24 bytes, which keeps the first bytes of them */
+static inline uint64_t first_bytes(const unsigned bytes, const unsigned word) {
+	return load_uint64_le(BYTE_MASKS + BYTE_MASKS_SIZE - bytes + 8 * word);
+}
+
+/// LEB128
+// The value is split into 3 parts of 56, 56 and 16 bits, which are 8, 8 and 3 bytes of 7 bits, and every part
+// is spread into (or packed from) a 64-bit word by moving its halves apart 3 times: 28-bit, 14-bit and 7-bit units
+
+#define LEB128_HIGHEST_BITS 0x8080808080808080ull
+#define LEB128_PART_BITS 56
+#define LEB128_PART_MASK ((1ull << LEB128_PART_BITS) - 1)
+
+/* Spreads the lower 56 bits into 8 bytes of 7 bits */
+static inline uint64_t leb128_spread(uint64_t bits) {
+	bits = (bits & 0x000000000fffffffull) | (bits & 0x00fffffff0000000ull) << 4;
+	bits = (bits & 0x00003fff00003fffull) | (bits & 0x0fffc0000fffc000ull) << 2;
+	return (bits & 0x007f007f007f007full) | (bits & 0x3f803f803f803f80ull) << 1;
+}
+
+/* Packs the lower 7 bits of 8 bytes into 56 bits, the highest bits of the bytes must be clear */
+static inline uint64_t leb128_pack(uint64_t bytes) {
+	bytes = (bytes & 0x007f007f007f007full) | (bytes & 0x7f007f007f007f00ull) >> 1;
+	bytes = (bytes & 0x00003fff00003fffull) | (bytes & 0x3fff00003fff0000ull) >> 2;
+	return (bytes & 0x000000000fffffffull) | (bytes & 0x0fffffff00000000ull) >> 4;
+}
+
+/* Mask with the bit i set if the byte i of the word ends a value (its highest bit is clear), the highest bits
+ * of all bytes are gathered into the highest byte by a multiplication */
+static inline uint32_t leb128_word_ends(const uint64_t word) {
+	return (uint32_t)((((~word & LEB128_HIGHEST_BITS) >> 7) * 0x0102040810204080ull) >> 56);
+}
+
+/* Mask with the bit i set if the byte i ends a value, for the first 24 bytes */
+static inline uint32_t leb128_ends(const unsigned char * const bytes, const uint64_t last_word) {
+#if defined(__SSE2__)
+	const uint32_t first = (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)bytes)) ^ 0xffff;
+#else
+	const uint32_t first = leb128_word_ends(load_uint64_le(bytes)) | leb128_word_ends(load_uint64_le(bytes + 8)) << 8;
+#endif
+	return first | leb128_word_ends(last_word) << 16;
+}
+
+size_t uint128_leb128_size(const uint128_t a) {
+	const unsigned bits = uint128_bit_length(a);
+	return bits == 0 ? 1 : (bits + 6) / 7;
+}
+
+size_t uint128_leb128_encode(const uint128_t a, unsigned char * const bytes) {
+	const size_t size = uint128_leb128_size(a);
+	const unsigned continued = (unsigned)size - 1;
+	const uint64_t lower = getlo(a), higher = gethi(a);
+	// every byte except for the last one has the highest bit set
+	store_uint64_le(bytes, leb128_spread(lower & LEB128_PART_MASK) | (LEB128_HIGHEST_BITS & first_bytes(continued, 0)));
+	store_uint64_le(bytes + 8, leb128_spread((lower >> LEB128_PART_BITS | higher << 8) & LEB128_PART_MASK) |
+		(LEB128_HIGHEST_BITS & first_bytes(continued, 1)));
+	const uint64_t last = leb128_spread(higher >> 48) | (LEB128_HIGHEST_BITS & first_bytes(continued, 2));
+	bytes[16] = (unsigned char)last;
+	bytes[17] = (unsigned char)(last >> 8);
+	bytes[18] = (unsigned char)(last >> 16);
+	return size;
+}
+
+/* Decodes a value, which has at least 24 bytes to read (even if not all of them are a part of it) */
+static inline size_t leb128_decode_padded(const unsigned char * const bytes, uint128_t * const out) {
+	const uint64_t last_word = load_uint64_le(bytes + 16);
+	const uint32_t ends = leb128_ends(bytes, last_word) & 0x7ffff;
+	if (ends == 0)
+		return 0;
+	const unsigned size = lowest_bit(ends) + 1;
+	const uint64_t first = leb128_pack(load_uint64_le(bytes) & first_bytes(size, 0) & ~LEB128_HIGHEST_BITS);
+	const uint64_t second = leb128_pack(load_uint64_le(bytes + 8) & first_bytes(size, 1) & ~LEB128_HIGHEST_BITS);
+	const uint64_t third = leb128_pack(last_word & first_bytes(size, 2) & ~LEB128_HIGHEST_BITS);
+	// the last 3 bytes have 21 bits, only 16 of which fit
+	if (third >> 16 != 0)
+		return 0;
+	*out = uint128_create(second >> 8 | third << 48, first | second << LEB128_PART_BITS);
+	return (size_t)size;
+}
+
+/* Decodes a value, copying the bytes into a padded buffer if there are fewer than 24 of them */
+static inline size_t leb128_decode(const unsigned char * const bytes, const size_t length, uint128_t * const out) {
+	if (length >= 24)
+		return leb128_decode_padded(bytes, out);
+	unsigned char padded[24] = {0};
+	memcpy(padded, bytes, length);
+	uint128_t value;
+	const size_t size = leb128_decode_padded(padded, &value);
+	if (size == 0 || size > length)
+		return 0;
+	*out = value;
+	return size;
+}
+
+size_t uint128_leb128_decode(const unsigned char * const bytes, const size_t length, uint128_t * const out) {
+	return leb128_decode(bytes, length, out);
+}
+
+size_t uint128_leb128_encode_array(const uint128_t * const values, const size_t n, unsigned char * const bytes) {
+	size_t position = 0;
+	for (size_t i = 0; i < n; i++)
+		position += uint128_leb128_encode(values[i], bytes + position);
+	return position;
+}
+
+size_t uint128_leb128_decode_array(const unsigned char * const bytes, const size_t length,
+								   uint128_t * const values, const size_t n) {
+	size_t position = 0;
+	for (size_t i = 0; i < n; i++) {
+		const size_t size = leb128_decode(bytes + position, length - position, &values[i]);
+		if (size == 0)
+			return 0;
+		position += size;
+	}
+	return position;
+}
+
+/// Prefix varint
+// The value is always stored as 16 bytes, and the length only tells how far the next value begins,
+// so the encoding needs room for the whole 16 bytes, and the decoding masks the bytes after the value
+
+static inline unsigned prefix_varint_bytes(const uint128_t a) {
+	return (uint128_bit_length(a) + 7) / 8;
+}
+
+/* Keeps the first bytes of the value loaded from 16 bytes */
+static inline uint128_t prefix_varint_mask(const uint128_t loaded, const unsigned bytes) {
+	return uint128_and(loaded, uint128_load_le(BYTE_MASKS + BYTE_MASKS_SIZE - bytes));
+}
+
+/* Loads the bytes of a value, which may be fewer than 16 */
+static inline uint128_t prefix_varint_load(const unsigned char * const bytes, const size_t available,
+										   const unsigned value_bytes) {
+	if (available >= 16)
+		return prefix_varint_mask(uint128_load_le(bytes), value_bytes);
+	unsigned char padded[16] = {0};
+	memcpy(padded, bytes, value_bytes);
+	return uint128_load_le(padded);
+}
+
+size_t uint128_prefix_varint_size(const uint128_t a) {
+	return 1 + prefix_varint_bytes(a);
+}
+
+size_t uint128_prefix_varint_encode(const uint128_t a, unsigned char * const bytes) {
+	const unsigned value_bytes = prefix_varint_bytes(a);
+	bytes[0] = (unsigned char)value_bytes;
+	uint128_store_le(bytes + 1, a);
+	return 1 + value_bytes;
+}
+
+size_t uint128_prefix_varint_decode(const unsigned char * const bytes, const size_t length, uint128_t * const out) {
+	if (length == 0 || bytes[0] > 16 || bytes[0] >= length)
+		return 0;
+	*out = prefix_varint_load(bytes + 1, length - 1, bytes[0]);
+	return 1 + (size_t)bytes[0];
+}
+
+size_t uint128_prefix_varint_encode_array(const uint128_t * const values, const size_t n,
+										  unsigned char * const bytes) {
+	unsigned char *data = bytes + n;
+	for (size_t i = 0; i < n; i++) {
+		const unsigned value_bytes = prefix_varint_bytes(values[i]);
+		bytes[i] = (unsigned char)value_bytes;
+		uint128_store_le(data, values[i]);
+		data += value_bytes;
+	}
+	return (size_t)(data - bytes);
+}
+
+size_t uint128_prefix_varint_decode_array(const unsigned char * const bytes, const size_t length,
+										  uint128_t * const values, const size_t n) {
+	if (length < n)
+		return 0;
+	const unsigned char *data = bytes + n;
+	const unsigned char * const end = bytes + length;
+	size_t i = 0;
+	// while there are 16 bytes to load, the lengths don't need to be checked against the end
+	for (; i < n && end - data >= 16; i++) {
+		const unsigned value_bytes = bytes[i];
+		if (value_bytes > 16)
+			return 0;
+#if defined(__SSE2__)
+		// x86 is little-endian, so the masked bytes are the value
+		const __m128i mask = _mm_loadu_si128((const __m128i *)(BYTE_MASKS + BYTE_MASKS_SIZE - value_bytes));
+		_mm_storeu_si128((__m128i *)&values[i], _mm_and_si128(_mm_loadu_si128((const __m128i *)data), mask));
+#else
+		values[i] = prefix_varint_mask(uint128_load_le(data), value_bytes);
+#endif
+		data += value_bytes;
+	}
+	for (; i < n; i++) {
+		const unsigned value_bytes = bytes[i];
+		if (value_bytes > 16 || end - data < value_bytes)
+			return 0;
+		values[i] = prefix_varint_load(data, (size_t)(end - data), value_bytes);
+		data += value_bytes;
+	}
+	return (size_t)(data - bytes);
+}
@@ -0,0 +1,353 @@
+// extended precision integers library for C
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+#include <string.h>
+#include <assert.h>
+#include "integers/uint128.h"
+#include "integers/uint_wide.h"
+#include "bitfuncs/bitfuncs.h"
+#include "uint128_division.h"
+#include "uint128_digits.h"
+#include "limbs.h"
+
+// All of the widths are implemented by the generic functions working on limb arrays of length n, which are
+// instantiated for every width with a constant n by UINT_WIDE_DEFINE. The scratch space is sized for the largest width
+#define WIDE_MAX_LIMBS 8
+#define WIDE_MAX_BITS (WIDE_MAX_LIMBS * 64)
+
+/// Shifts
+
+static inline void wide_shift_left(uint64_t * const r, const uint64_t * const a, const size_t n,
+								   const unsigned shift) {
+	const size_t limb_shift = shift / 64;
+	const unsigned bit_shift = shift % 64;
+	if (limb_shift >= n) {
+		memset(r, 0, n * sizeof(uint64_t));
+		return;
+	}
+	if (bit_shift == 0) {
+		for (size_t i = n; i-- > limb_shift;)
+			r[i] = a[i - limb_shift];
+	} else {
+		for (size_t i = n; --i > limb_shift;)
+			r[i] = (a[i - limb_shift] << bit_shift) | (a[i - limb_shift - 1] >> (64 - bit_shift));
+		r[limb_shift] = a[0] << bit_shift;
+	}
+	memset(r, 0, limb_shift * sizeof(uint64_t));
+}
+
+static inline void wide_shift_right(uint64_t * const r, const uint64_t * const a, const size_t n,
+									const unsigned shift) {
+	const size_t limb_shift = shift / 64;
+	const unsigned bit_shift = shift % 64;
+	if (limb_shift >= n) {
+		memset(r, 0, n * sizeof(uint64_t));
+		return;
+	}
+	const size_t length = n - limb_shift;
+	if (bit_shift == 0) {
+		for (size_t i = 0; i < length; i++)
+			r[i] = a[i + limb_shift];
+	} else {
+		for (size_t i = 0; i + 1 < length; i++)
+			r[i] = (a[i + limb_shift] >> bit_shift) | (a[i + limb_shift + 1] << (64 - bit_shift));
+		r[length - 1] = a[n - 1] >> bit_shift;
+	}
+	memset(r + length, 0, limb_shift * sizeof(uint64_t));
+}
+
+/// Multiplication and division
+
+/* r = a * b mod 2^(64 * n), r mustn't overlap with a or b */
+static inline void wide_multiply(uint64_t * const r, const uint64_t * const a, const uint64_t * const b,
+								 const size_t n) {
+	memset(r, 0, n * sizeof(uint64_t));
+	for (size_t i = 0; i < n; i++) {
+		// only the lower n limbs of the product are needed, so the rows get shorter
+		if (b[i] != 0)
+			limbs_addmul_1(r + i, a, n - i, b[i]);
+	}
+}
+
+/* Divides a by b (which mustn't be 0) using the normalized schoolbook division,
+ * the quotient and the remainder mustn't overlap with a or b */
+static inline void wide_divrem(uint64_t * const q, uint64_t * const r, const uint64_t * const a,
+							   const uint64_t * const b, const size_t n) {
+	const size_t divisor_length = limbs_normalized_length(b, n);
+	assert(divisor_length != 0);	// dividing by 0
+	const size_t dividend_length = limbs_normalized_length(a, n);
+
+	memset(q, 0, n * sizeof(uint64_t));
+	memset(r, 0, n * sizeof(uint64_t));
+	// the quotient is 0, so don't bother normalizing anything
+	if (dividend_length < divisor_length ||
+		(dividend_length == divisor_length && limbs_cmp(a, b, dividend_length) < 0)) {
+		memcpy(r, a, n * sizeof(uint64_t));
+		return;
+	}
+
+	uint64_t numerator[WIDE_MAX_LIMBS + 1], divisor[WIDE_MAX_LIMBS];
+	limbs_divrem(q, r, a, dividend_length, b, divisor_length, numerator, divisor);
+}
+
+/// Parsing
+
+/* Parses the integer the same way uint128_parse_n does, by converting chunks of digits which fit into 64 bits and
+ * combining them with one multiplication per chunk. Only the limbs which are already significant are multiplied,
+ * so short values are parsed as fast as with the narrower types */
+static inline uint128_parse_status wide_parse_n(uint64_t * const out, const size_t n, const char *begin,
+												const char * const end, const int base_or_auto,
+												const char ** stop) {
+	const char *unused_stop;
+	unsigned base;
+	const uint128_parse_status status = parse_start(&begin, end, base_or_auto, &base, &stop, &unused_stop);
+	if (status != UINT128_PARSE_OK)
+		return status;
+
+	const uint64_base_power largest_power = LARGEST_BASE_POWERS[base - 2];
+	const char *current = skip_zeroes(begin, end);
+
+	uint64_t value[WIDE_MAX_LIMBS] = {0};
+	size_t length = 0;
+	int overflow = 0;
+	for (;;) {
+		uint64_t chunk = 0, multiplier = 1;
+		unsigned chunk_digits = 0;
+		for (; chunk_digits < largest_power.digits && current < end; chunk_digits++, current++) {
+			const uint8_t digit = DIGIT_VALUES[(unsigned char)*current];
+			if (digit >= base)
+				break;
+			chunk = chunk * base + digit;
+			multiplier *= base;
+		}
+		if (chunk_digits == 0)
+			break;
+		// keep going after an overflow, so that stop still points to the end of the digits
+		if (!overflow) {
+			const uint64_t carry = limbs_mul_1(value, value, length, multiplier) +
+								   limbs_add_1(value, value, length, chunk);
+			// the carry is at most multiplier - 1 (or the chunk itself while the value is 0),
+			// so adding the carry of the addition can't overflow
+			if (carry != 0) {
+				if (length == n)
+					overflow = 1;
+				else
+					value[length++] = carry;
+			}
+		}
+		if (chunk_digits < largest_power.digits)
+			break;
+	}
+	*stop = current;
+
+	if (current == begin)
+		return UINT128_PARSE_INVALID_DIGIT;
+	if (overflow)
+		return UINT128_PARSE_OVERFLOW;
+
+	if (out != NULL)
+		memcpy(out, value, n * sizeof(uint64_t));
+	return UINT128_PARSE_OK;
+}
+
+/// Conversion to string
+
+/* Writes the digits of the integer in a base which is a power of 2, taking the digits straight from the bits */
+static inline char * wide_format_power_of_2(const uint64_t * const a, const size_t n, char *end,
+											const unsigned digit_bits) {
+	const size_t length = limbs_normalized_length(a, n);
+	if (length == 0) {
+		*--end = '0';
+		return end;
+	}
+
+	const size_t bits = length * 64 - uint64_clz(a[length - 1]);
+	const uint64_t digit_mask = (1u << digit_bits) - 1;
+	for (size_t bit = 0; bit < bits; bit += digit_bits) {
+		const size_t limb = bit / 64;
+		const unsigned offset = bit % 64;
+		uint64_t digit = a[limb] >> offset;
+		// the digit can be split between two limbs if the digit size isn't a power of 2
+		if (offset + digit_bits > 64 && limb + 1 < length)
+			digit |= a[limb + 1] << (64 - offset);
+		*--end = DIGIT_CHARACTERS[digit & digit_mask];
+	}
+	return end;
+}
+
+/* Writes the digits of the integer by dividing it by the largest power of the base fitting into 64 bits,
+ * so that all digits except for the chunk division are computed using 64-bit arithmetic */
+static inline char * wide_format_chunked(const uint64_t * const a, const size_t n, char *end, const unsigned base) {
+	uint64_t value[WIDE_MAX_LIMBS];
+	memcpy(value, a, n * sizeof(uint64_t));
+	size_t length = limbs_normalized_length(value, n);
+
+	uint64_t chunk = DECIMAL_CHUNK, reciprocal = DECIMAL_CHUNK_RECIPROCAL;
+	unsigned chunk_digits = DECIMAL_CHUNK_DIGITS, shift = 0;
+	if (base != 10) {
+		chunk = LARGEST_BASE_POWERS[base - 2].power;
+		chunk_digits = LARGEST_BASE_POWERS[base - 2].digits;
+		shift = uint64_clz(chunk);
+		chunk <<= shift;
+		reciprocal = reciprocal_128_by_64(chunk);
+	}
+
+	while (length > 1) {
+		const uint64_t remainder_higher = shift != 0 ? limbs_lshift(value, value, length, shift) : 0;
+		const uint64_t remainder = limbs_divrem_1_normalized(value, value, length, remainder_higher, chunk,
+															 reciprocal) >> shift;
+		// the lower chunks have to be padded with zeroes
+		end = format_uint64_padded(remainder, end, base, chunk_digits);
+		length = limbs_normalized_length(value, length);
+	}
+	return format_uint64(value[0], end, base);
+}
+
+static inline size_t wide_format(const uint64_t * const a, const size_t n, char * const string,
+								 const unsigned base) {
+	if (base < 2 || base > 36 || string == NULL)
+		return 0;
+
+	char buffer[WIDE_MAX_BITS + 1];
+	char * const end = buffer + sizeof(buffer);
+	char *begin;
+	if ((base & (base - 1)) == 0)
+		begin = wide_format_power_of_2(a, n, end, uint64_clz(1) - uint64_clz(base));
+	else
+		begin = wide_format_chunked(a, n, end, base);
+
+	const size_t length = (size_t)(end - begin);
+	memcpy(string, begin, length);
+	string[length] = '\0';
+	return length;
+}
+
+/// Instantiation
+
+#define UINT_WIDE_LIMBS(bits) ((bits) / 64)
+
+/* Defines all of the functions declared by CREN_UINT_WIDE_DECLARE for the given width */
+#define UINT_WIDE_DEFINE(bits) \
+	uint##bits##_t uint##bits##_value(const uint64_t a) { \
+		uint##bits##_t result = {{0}}; \
+		result.limbs[0] = a; \
+		return result; \
+	} \
+	\
+	uint##bits##_t uint##bits##_from_uint128(const uint128_t a) { \
+		uint##bits##_t result = {{0}}; \
+		result.limbs[0] = uint128_get_lower(a); \
+		result.limbs[1] = uint128_get_higher(a); \
+		return result; \
+	} \
+	\
+	uint128_t uint##bits##_to_uint128(const uint##bits##_t a) { \
+		return uint128_create(a.limbs[1], a.limbs[0]); \
+	} \
+	\
+	uint##bits##_t uint##bits##_shift_left(const uint##bits##_t a, const unsigned int shift) { \
+		uint##bits##_t result; \
+		wide_shift_left(result.limbs, a.limbs, UINT_WIDE_LIMBS(bits), shift); \
+		return result; \
+	} \
+	\
+	uint##bits##_t uint##bits##_shift_right(const uint##bits##_t a, const unsigned int shift) { \
+		uint##bits##_t result; \
+		wide_shift_right(result.limbs, a.limbs, UINT_WIDE_LIMBS(bits), shift); \
+		return result; \
+	} \
+	\
+	int uint##bits##_cmp(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)); \
+	} \
+	\
+	int uint##bits##_equ(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)) == 0; \
+	} \
+	\
+	int uint##bits##_lt(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)) < 0; \
+	} \
+	\
+	int uint##bits##_lte(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)) <= 0; \
+	} \
+	\
+	int uint##bits##_gt(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)) > 0; \
+	} \
+	\
+	int uint##bits##_gte(const uint##bits##_t a, const uint##bits##_t b) { \
+		return limbs_cmp(a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)) >= 0; \
+	} \
+	\
+	uint##bits##_t uint##bits##_add(const uint##bits##_t a, const uint##bits##_t b) { \
+		uint##bits##_t result; \
+		limbs_add_n(result.limbs, a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)); \
+		return result; \
+	} \
+	\
+	uint##bits##_t uint##bits##_subtract(const uint##bits##_t a, const uint##bits##_t b) { \
+		uint##bits##_t result; \
+		limbs_sub_n(result.limbs, a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)); \
+		return result; \
+	} \
+	\
+	CREN_INTS_DISPATCHED(uint##bits##_t, uint##bits##_multiply, (const uint##bits##_t a, const uint##bits##_t b), \
+						 (a, b)) { \
+		uint##bits##_t result; \
+		wide_multiply(result.limbs, a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)); \
+		return result; \
+	} \
+	\
+	CREN_INTS_DISPATCHED(uint##bits##_divrem_result, uint##bits##_divrem, \
+						 (const uint##bits##_t a, const uint##bits##_t b), (a, b)) { \
+		uint##bits##_divrem_result result; \
+		wide_divrem(result.quotient.limbs, result.remainder.limbs, a.limbs, b.limbs, UINT_WIDE_LIMBS(bits)); \
+		return result; \
+	} \
+	\
+	uint##bits##_t uint##bits##_divide(const uint##bits##_t a, const uint##bits##_t b) { \
+		return uint##bits##_divrem(a, b).quotient; \
+	} \
+	\
+	uint##bits##_t uint##bits##_mod(const uint##bits##_t a, const uint##bits##_t b) { \
+		return uint##bits##_divrem(a, b).remainder; \
+	} \
+	\
+	uint128_parse_status uint##bits##_parse_n(const char *begin, const char * const end, const int base_or_auto, \
+											  uint##bits##_t * const out, const char ** stop) { \
+		return wide_parse_n(out != NULL ? out->limbs : NULL, UINT_WIDE_LIMBS(bits), begin, end, base_or_auto, stop); \
+	} \
+	\
+	uint##bits##_t uint##bits##_parse(const char *string) { \
+		uint##bits##_t value = {{0}}; \
+		if (string == NULL) \
+			return value; \
+		const char * const end = string + strlen(string); \
+		const char *stop; \
+		switch (uint##bits##_parse_n(string, end, 0, &value, &stop)) { \
+			case UINT128_PARSE_OK: \
+				/* the whole string has to be a number */ \
+				return stop == end ? value : uint##bits##_value(0); \
+			case UINT128_PARSE_OVERFLOW: \
+				memset(value.limbs, 0xff, sizeof(value.limbs)); \
+				return value; \
+			default: \
+				return value; \
+		} \
+	} \
+	\
+	size_t uint##bits##_format(const uint##bits##_t a, char * const string, const unsigned int base) { \
+		return wide_format(a.limbs, UINT_WIDE_LIMBS(bits), string, base); \
+	} \
+	\
+	const char * uint##bits##_to_string(const uint##bits##_t a, char * const string, const unsigned int base) { \
+		if (uint##bits##_format(a, string, base) == 0) \
+			return NULL; \
+		return string; \
+	}
+
+UINT_WIDE_DEFINE(256)
+UINT_WIDE_DEFINE(512)
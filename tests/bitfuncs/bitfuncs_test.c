@@ -1,7 +1,34 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <bitfuncs/bitfuncs.h>
 
+/* Checks the number of trailing zeros counted by the function, exits on failure */
+static void expect_ctz(const char *what, const unsigned long long x, const unsigned ctz, const unsigned expected) {
+	if (ctz != expected) {
+		printf(
+			"!ERROR! Problem with %s:\n"
+			"\tTrailing zeros of 0x%llx were supposed to be %u, but are actually %u\n",
+			what, x, expected, ctz);
+		exit(-1);
+	}
+}
+
 int main () {
 	printf("%u\n", uint64_clz(81723417029384));
-}
 
+	expect_ctz("uint32_ctz", 0, uint32_ctz(0), 32);
+	expect_ctz("uint64_ctz", 0, uint64_ctz(0), 64);
+	for (unsigned i = 0; i < 64; i++) {
+		// the lowest set bit decides the count, whatever the bits above it are
+		const uint64_t bit = (uint64_t)1 << i, above = ~(uint64_t)0 << i, sparse = 0x8000100000040000ull << i | bit;
+		if (i < 32) {
+			expect_ctz("uint32_ctz", (uint32_t)bit, uint32_ctz((uint32_t)bit), i);
+			expect_ctz("uint32_ctz", (uint32_t)above, uint32_ctz((uint32_t)above), i);
+			expect_ctz("uint32_ctz", (uint32_t)sparse, uint32_ctz((uint32_t)sparse), i);
+		}
+		expect_ctz("uint64_ctz", bit, uint64_ctz(bit), i);
+		expect_ctz("uint64_ctz", above, uint64_ctz(above), i);
+		expect_ctz("uint64_ctz", sparse, uint64_ctz(sparse), i);
+	}
+	puts("Trailing zeros have been counted correctly!");
+}
@@ -1,6 +1,92 @@
 #include <stdlib.h>
+#include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 #include <integers/uint128.h>
+#include <integers/uint128_modular.h>
+#include <integers/uint_wide.h>
+#include <integers/natural.h>
+#include <integers/uint128_const_division.h>
+#include <integers/uint128_atomic.h>
+#include <integers/uint128_map.h>
+#include <integers/uint128_sort.h>
+#include <integers/uint128_array.h>
+#include <integers/uint128_convert.h>
+#include <integers/uint128_varint.h>
+#include <integers/uint128_packing.h>
+#include <integers/uint128_column.h>
+
+/* Checks that the value has the expected higher and lower bits, exits on failure */
+static void expect_uint128(const char *what, const uint128_t value, const uint64_t hi, const uint64_t lo) {
+	if (!(uint128_get_higher(value) == hi && uint128_get_lower(value) == lo)) {
+		printf(
+			"!ERROR! Problem with %s:\n"
+			"\tHigher bits were supposed to be 0x%llx, but are actually 0x%llx\n"
+			"\tLower bits were supposed to be 0x%llx, but are actually 0x%llx\n",
+			what, (unsigned long long)hi, (unsigned long long)uint128_get_higher(value),
+			(unsigned long long)lo, (unsigned long long)uint128_get_lower(value));
+		exit(-1);
+	}
+}
+
+/* Checks that the value is formatted into the expected string in the given base, exits on failure */
+static void expect_string(const uint128_t value, const unsigned base, const char *expected) {
+	char buffer[UINT128_STRING_SIZE];
+	const size_t length = uint128_format(value, buffer, base);
+	if (length != strlen(expected) || strcmp(buffer, expected) != 0) {
+		printf(
+			"!ERROR! Problem with uint128_format:\n"
+			"\tValue in base %u was supposed to be %s, but is actually %s (length %zu)\n",
+			base, expected, buffer, length);
+		exit(-1);
+	}
+}
+
+/* Checks that a wider integer has been formatted into the expected string, exits on failure */
+static void expect_formatted(const char *what, const char *formatted, const char *expected) {
+	if (formatted == NULL || strcmp(formatted, expected) != 0) {
+		printf(
+			"!ERROR! Problem with %s:\n"
+			"\tValue was supposed to be %s, but is actually %s\n",
+			what, expected, formatted == NULL ? "NULL" : formatted);
+		exit(-1);
+	}
+}
+
+/* Checks the status and stop position of parsing [string, string + length), exits on failure
+ * returns the parsed value, or 0xdead if the value hasn't been stored */
+static uint128_t expect_parse_n(const char *string, const size_t length, const int base,
+								const uint128_parse_status status, const size_t stop_offset) {
+	uint128_t value = uint128_value(0xdead);
+	const char *stop;
+	if (uint128_parse_n(string, string + length, base, &value, &stop) != status || stop != string + stop_offset) {
+		printf(
+			"!ERROR! Problem with uint128_parse_n:\n"
+			"\tParsing \"%.*s\" in base %d was supposed to return %d and stop at %zu\n",
+			(int)length, string, base, status, stop_offset);
+		exit(-1);
+	}
+	return value;
+}
+
+// Number of threads and increments per thread of the atomic counter test
+#define ATOMIC_TEST_THREADS 4
+#define ATOMIC_TEST_INCREMENTS 100000
+
+/* Adds 2^64 + 1 to the shared counter ATOMIC_TEST_INCREMENTS times, half of the time using a compare-exchange loop,
+ * so that both halves of the value change and a torn update would be noticed */
+static void * atomic_test_thread(void *counter) {
+	for (int i = 0; i < ATOMIC_TEST_INCREMENTS; i++) {
+		if (i & 1) {
+			atomic_uint128_fetch_add(counter, uint128_create(1, 1));
+		} else {
+			uint128_t expected = atomic_uint128_load(counter);
+			while (!atomic_uint128_compare_exchange(counter, &expected, uint128_add(expected, uint128_create(1, 1))))
+				;
+		}
+	}
+	return NULL;
+}
 
 int main() {
 	puts("--- uint128 library testing ---");
@@ -106,6 +192,14 @@ int main() {
 		exit(-1);
 	}
 
+	expect_uint128("uint128_parse", uint128_parse("99999999999999999999"), 0x5, 0x6bc75e2d630fffffull);
+	expect_uint128("uint128_parse", uint128_parse("12345678901234567890123456789012345678"),
+		0x949b0f6f0023313ull, 0xc4499050de38f34eull);
+	expect_uint128("uint128_parse", uint128_parse("340282366920938463463374607431768211456"),
+		0xffffffffffffffffull, 0xffffffffffffffffull);
+	expect_uint128("uint128_parse", uint128_parse("1234567890123456789012345678901234x"), 0, 0);
+	expect_uint128("uint128_parse", uint128_parse("00000000000000000000000000000000000000000001"), 0, 1);
+
 	puts("[\\1] Test block has been passed!");
 
 	puts("[2] Bitwise operation tests");
@@ -113,6 +207,1084 @@ int main() {
 	uint128_t test3_a = uint128_parse("12736123489127397865128647");
 	uint128_t test3_b = uint128_parse("2");
 	uint128_divrem_result divided = uint128_divrem(test3_a, test3_b);
+	(void)divided;
+
+	puts("[3] Division tests");
+
+	const uint128_t test3_max = uint128_create(0xffffffffffffffffull, 0xffffffffffffffffull);
+	divided = uint128_divrem(test3_max, uint128_value(10000000000000000000ull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0x1, 0xd83c94fb6d2ac34aull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0x2ed503946aefffffull);
+
+	divided = uint128_divrem(test3_max, uint128_create(0xdeadull, 0xbeefcafebabe1234ull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0x1264eb564b347ull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0x3d09, 0xcc33fdd16e3e9793ull);
+
+	divided = uint128_divrem(test3_max, uint128_create(0xffffffffffffffffull, 0xffffffffffffff00ull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 1);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0xff);
+
+	// every shortcut taken by uint128_divrem before the full division
+	divided = uint128_divrem(uint128_value(0xfedcba9876543210ull), uint128_value(0x12345));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0xe0004fa01c4dull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0x10a4f);
+
+	divided = uint128_divrem(test3_max, uint128_value(0x2000));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0x7ffffffffffffull, 0xffffffffffffffffull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0x1fff);
+
+	divided = uint128_divrem(uint128_create(0x123456789abcdef0ull, 0x0fedcba987654321ull), uint128_create(0x40, 0));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0x48d159e26af37bull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0x30, 0x0fedcba987654321ull);
+
+	divided = uint128_divrem(uint128_create(0x1234, 0x56789abcdef01234ull), uint128_value(0xfedcba9876543211ull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0x1249);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0x2468acf13568995bull);
+
+	divided = uint128_divrem(test3_max, uint128_create(0x1, 0x8000000000000001ull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0xaaaaaaaaaaaaaaaaull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0, 0x5555555555555555ull);
+
+	// the quotient estimated from the higher bits is one too large here
+	divided = uint128_divrem(uint128_create(0xac954ab592c9357dull, 0x34accd781959b9efull),
+		uint128_create(0xc, 0x58d07674334de73dull));
+	expect_uint128("uint128_divrem quotient", divided.quotient, 0, 0xdfa5260cd9ad272ull);
+	expect_uint128("uint128_divrem remainder", divided.remainder, 0xc, 0x3bd63bba6546b6c5ull);
+
+	// the precomputed divisor has to give the same results for every dividend
+	const uint128_divisor_t test3_divisor = uint128_divisor_init(uint128_create(0xdeadull, 0xbeefcafebabe1234ull));
+	for (uint64_t i = 0; i < 1000; i++) {
+		const uint128_t dividend = uint128_create(i * 0x9e3779b97f4a7c15ull, ~i * 0xc2b2ae3d27d4eb4full);
+		const uint128_divrem_result expected = uint128_divrem(dividend, uint128_create(0xdeadull, 0xbeefcafebabe1234ull));
+		expect_uint128("uint128_div_by", uint128_div_by(dividend, &test3_divisor),
+			uint128_get_higher(expected.quotient), uint128_get_lower(expected.quotient));
+		expect_uint128("uint128_mod_by", uint128_mod_by(dividend, &test3_divisor),
+			uint128_get_higher(expected.remainder), uint128_get_lower(expected.remainder));
+	}
+
+	const uint128_divisor_t test3_small = uint128_divisor_init(uint128_value(3));
+	expect_uint128("uint128_div_by", uint128_div_by(test3_max, &test3_small),
+		0x5555555555555555ull, 0x5555555555555555ull);
+	expect_uint128("uint128_mod_by", uint128_mod_by(test3_max, &test3_small), 0, 0);
+
+	// exact division, 10^19 * 3^40 and a divisor with both an odd and an even part
+	const uint128_t test3_product = uint128_multiply(uint128_value(10000000000000000000ull),
+		uint128_value(12157665459056928801ull));
+	expect_uint128("uint128_divexact_uint64", uint128_divexact_uint64(test3_product, 10000000000000000000ull),
+		0, 12157665459056928801ull);
+	expect_uint128("uint128_divexact", uint128_divexact(test3_product, uint128_value(12157665459056928801ull)),
+		0, 10000000000000000000ull);
+	expect_uint128("uint128_divexact", uint128_divexact(test3_max, uint128_create(0x5555555555555555ull,
+		0x5555555555555555ull)), 0, 3);
+	const uint128_exact_divisor_t test3_exact = uint128_exact_divisor_init(uint128_create(0x30, 0x3000000000000000ull));
+	expect_uint128("uint128_divexact_by", uint128_divexact_by(uint128_create(0x36d38c, 0xf000000000000000ull),
+		&test3_exact), 0, 0x12345);
+	// only every multiple of the divisor passes the divisibility test, including the even part
+	for (uint64_t i = 0; i < 1000; i++) {
+		const uint128_t multiple = uint128_multiply_uint64(uint128_create(0x30, 0x3000000000000000ull), i);
+		if (!uint128_is_divisible_by(multiple, &test3_exact) ||
+			uint128_is_divisible_by(uint128_add_uint64(multiple, 1 + i % 7), &test3_exact) ||
+			uint128_is_divisible_by(uint128_add(multiple, uint128_create(0x18, 0x1800000000000000ull)), &test3_exact) ||
+			!uint128_equ(uint128_divexact_by(multiple, &test3_exact), uint128_value(i))) {
+			puts("!ERROR! Problem with uint128_is_divisible_by");
+			exit(-1);
+		}
+	}
+
+	// division by constants, including a power of 2 and an already normalized divisor
+	expect_uint128("UINT128_DIV_BY_CONST", UINT128_DIV_BY_CONST(test3_max, 3), 0x5555555555555555ull, 0x5555555555555555ull);
+	expect_uint128("UINT128_DIV_BY_CONST", UINT128_DIV_BY_CONST(test3_product, 10000000000000000000ull),
+		0, 12157665459056928801ull);
+	expect_uint128("UINT128_DIV_BY_CONST", UINT128_DIV_BY_CONST(test3_max, 1ull << 40), 0xffffff, UINT64_MAX);
+	if (UINT128_MOD_BY_CONST(test3_max, 1ull << 40) != (1ull << 40) - 1 || UINT128_MOD_BY_CONST(test3_max, 1) != 0 ||
+		UINT128_CONST_RECIPROCAL(10000000000000000000ull) != 0xd83c94fb6d2ac34aull) {
+		puts("!ERROR! Problem with UINT128_MOD_BY_CONST");
+		exit(-1);
+	}
+	for (uint64_t i = 0; i < 1000; i++) {
+		const uint128_t dividend = uint128_create(i * 0x9e3779b97f4a7c15ull, ~i * 0xc2b2ae3d27d4eb4full);
+		const uint128_divrem_result by_const = UINT128_DIVREM_BY_CONST(dividend, 86400000000000ull);
+		const uint128_divrem_result expected = uint128_divrem(dividend, uint128_value(86400000000000ull));
+		if (!uint128_equ(by_const.quotient, expected.quotient) || !uint128_equ(by_const.remainder, expected.remainder) ||
+			UINT128_MOD_BY_CONST(dividend, 1000) != uint128_mod_uint64(dividend, 1000)) {
+			puts("!ERROR! Problem with UINT128_DIVREM_BY_CONST");
+			exit(-1);
+		}
+	}
+
+	puts("[\\3] Test block has been passed!");
+
+	puts("[4] Conversion to string tests");
+
+	expect_string(test3_max, 10, "340282366920938463463374607431768211455");
+	expect_string(test3_max, 16, "ffffffffffffffffffffffffffffffff");
+	expect_string(test3_max, 8, "3777777777777777777777777777777777777777777");
+	expect_string(test3_max, 36, "f5lxx1zz5pnorynqglhzmsp33");
+	expect_string(uint128_value(0), 10, "0");
+	expect_string(uint128_value(0), 2, "0");
+	expect_string(uint128_value(10000000000000000000ull), 10, "10000000000000000000");
+	expect_string(uint128_create(1, 0), 10, "18446744073709551616");
+	expect_string(uint128_create(0x5ull, 0x6bc75e2d63100000ull), 10, "100000000000000000000");
+	expect_string(uint128_parse("100000000000000000000000000000000000001"), 10,
+		"100000000000000000000000000000000000001");
+	expect_string(test1_g, 16, "11112233445566778899aabbccddeeff");
+	expect_string(test1_j, 8, "3740717004103225754457272103241747576");
+	expect_string(uint128_create(0x1ull, 0x0ull), 3, "11112220022122120101211020120210210211221");
+	expect_string(uint128_value(5), 2, "101");
+
+	char test4_buffer[UINT128_STRING_SIZE];
+	if (uint128_to_string(test3_max, test4_buffer, 1) != NULL || uint128_to_string(test3_max, test4_buffer, 37) != NULL) {
+		puts("!ERROR! Problem with uint128_to_string:\n\tInvalid bases were supposed to return NULL");
+		exit(-1);
+	}
+	if (uint128_to_string(test3_max, test4_buffer, 2) != test4_buffer || strlen(test4_buffer) != 128) {
+		puts("!ERROR! Problem with uint128_to_string:\n\tBinary representation of the max value must be 128 chars");
+		exit(-1);
+	}
+
+	puts("[\\4] Test block has been passed!");
+
+	puts("[5] Bounded parsing tests");
+
+	uint128_t test5_value;
+	const char test5_fields[] = "12345678901234567890,0xdeadbeef;0b102;;";
+	test5_value = expect_parse_n(test5_fields, sizeof(test5_fields) - 1, 0, UINT128_PARSE_OK, 20);
+	expect_uint128("uint128_parse_n", test5_value, 0, 12345678901234567890ull);
+	test5_value = expect_parse_n(test5_fields + 21, sizeof(test5_fields) - 22, 0, UINT128_PARSE_OK, 10);
+	expect_uint128("uint128_parse_n", test5_value, 0, 0xdeadbeefull);
+	test5_value = expect_parse_n(test5_fields + 32, sizeof(test5_fields) - 33, 0, UINT128_PARSE_OK, 4);
+	expect_uint128("uint128_parse_n", test5_value, 0, 2);
+	test5_value = expect_parse_n(test5_fields + 37, sizeof(test5_fields) - 38, 0, UINT128_PARSE_INVALID_DIGIT, 0);
+	expect_uint128("uint128_parse_n", test5_value, 0, 0xdead);
+	// the end of the range has to be respected even if there are more digits after it
+	test5_value = expect_parse_n(test5_fields, 5, 10, UINT128_PARSE_OK, 5);
+	expect_uint128("uint128_parse_n", test5_value, 0, 12345);
+	test5_value = expect_parse_n(test5_fields, 0, 10, UINT128_PARSE_EMPTY, 0);
+	test5_value = expect_parse_n(test5_fields, 5, 37, UINT128_PARSE_INVALID_BASE, 0);
+
+	const char test5_max[] = "340282366920938463463374607431768211455 340282366920938463463374607431768211456";
+	test5_value = expect_parse_n(test5_max, 39, 10, UINT128_PARSE_OK, 39);
+	expect_uint128("uint128_parse_n", test5_value, 0xffffffffffffffffull, 0xffffffffffffffffull);
+	test5_value = expect_parse_n(test5_max + 40, 39, 10, UINT128_PARSE_OVERFLOW, 39);
+	expect_uint128("uint128_parse_n", test5_value, 0, 0xdead);
+
+	const char test5_bases[] = "f5lxx1zz5pnorynqglhzmsp33 F5LXX1ZZ5PNORYNQGLHZMSP34 3777777777777777777777777777777777777777777 "
+							   "4000000000000000000000000000000000000000000";
+	test5_value = expect_parse_n(test5_bases, 25, 36, UINT128_PARSE_OK, 25);
+	expect_uint128("uint128_parse_n", test5_value, 0xffffffffffffffffull, 0xffffffffffffffffull);
+	test5_value = expect_parse_n(test5_bases + 26, 25, 36, UINT128_PARSE_OVERFLOW, 25);
+	test5_value = expect_parse_n(test5_bases + 52, 43, 8, UINT128_PARSE_OK, 43);
+	expect_uint128("uint128_parse_n", test5_value, 0xffffffffffffffffull, 0xffffffffffffffffull);
+	test5_value = expect_parse_n(test5_bases + 96, 43, 8, UINT128_PARSE_OVERFLOW, 43);
+	test5_value = expect_parse_n(test5_bases, 25, 10, UINT128_PARSE_INVALID_DIGIT, 0);
+
+	puts("[\\5] Test block has been passed!");
+
+	puts("[6] Full multiplication tests");
+
+	uint128_multiply_full_result test6_product = uint128_multiply_full(test3_max, test3_max);
+	expect_uint128("uint128_multiply_full higher", test6_product.hi, 0xffffffffffffffffull, 0xfffffffffffffffeull);
+	expect_uint128("uint128_multiply_full lower", test6_product.lo, 0, 1);
+
+	const uint128_t test6_a = uint128_create(0x0123456789abcdefull, 0xfedcba9876543210ull);
+	const uint128_t test6_b = uint128_create(0xdeadbeefcafebabeull, 0xd00dfeedbaddad00ull);
+	test6_product = uint128_multiply_full(test6_a, test6_b);
+	expect_uint128("uint128_multiply_full higher", test6_product.hi, 0x00fd5bdeeeb2a01eull, 0x5d53a5567a06c525ull);
+	expect_uint128("uint128_multiply_full lower", test6_product.lo, 0xfb906af4d9a1cabbull, 0xa61e93d5bda4d000ull);
+	expect_uint128("uint128_multiply_high", uint128_multiply_high(test6_b, test6_a),
+		0x00fd5bdeeeb2a01eull, 0x5d53a5567a06c525ull);
+	expect_uint128("uint128_multiply_high", uint128_multiply_high(test6_a, uint128_value(1)), 0, 0);
+
+	puts("[\\6] Test block has been passed!");
+
+	puts("[7] Modular arithmetic tests");
+
+	// the largest prime below 2^128, so all of the products overflow 128 bits
+	const uint128_modulus_t test7_prime = uint128_modulus_init(uint128_create(0xffffffffffffffffull, 0xffffffffffffff61ull));
+	const uint128_t test7_minus_one = uint128_decrement(test7_prime.modulus);
+	expect_uint128("uint128_reduce", uint128_reduce(test3_max, &test7_prime), 0, 158);
+	expect_uint128("uint128_addmod", uint128_addmod(test7_minus_one, test7_minus_one, &test7_prime),
+		0xffffffffffffffffull, 0xffffffffffffff5full);
+	expect_uint128("uint128_submod", uint128_submod(test6_a, test6_b, &test7_prime),
+		0x22758677bead1331ull, 0x2ecebbaabb768471ull);
+	expect_uint128("uint128_mulmod", uint128_mulmod(test6_a, test6_b, &test7_prime),
+		0x98ec7a6b1a933d97ull, 0x9d12448b87d9429aull);
+	expect_uint128("uint128_mulmod", uint128_mulmod(test7_minus_one, test7_minus_one, &test7_prime), 0, 1);
+	expect_uint128("uint128_powmod", uint128_powmod(test6_b, test6_a, &test7_prime),
+		0x07ac51a55bb7aa20ull, 0xaaf564bc63ea9b49ull);
+	expect_uint128("uint128_powmod", uint128_powmod(uint128_value(3), test7_minus_one, &test7_prime), 0, 1);
+	expect_uint128("uint128_powmod", uint128_powmod(test6_a, uint128_value(0), &test7_prime), 0, 1);
+
+	const uint128_t test7_montgomery_a = uint128_to_montgomery(test6_a, &test7_prime);
+	expect_uint128("uint128_to_montgomery", test7_montgomery_a, 0xb4e81b4e81b4e80full, 0x4b17e4b17e4b17f0ull);
+	expect_uint128("uint128_from_montgomery", uint128_from_montgomery(test7_montgomery_a, &test7_prime),
+		0x0123456789abcdefull, 0xfedcba9876543210ull);
+	expect_uint128("uint128_montgomery_multiply", uint128_from_montgomery(uint128_montgomery_multiply(
+		test7_montgomery_a, uint128_to_montgomery(test6_b, &test7_prime), &test7_prime), &test7_prime),
+		0x98ec7a6b1a933d97ull, 0x9d12448b87d9429aull);
+
+	// even moduli are reduced by reciprocal only
+	const uint128_modulus_t test7_even = uint128_modulus_init(uint128_create(0xffffffffffffffffull, 0xfffffffffffffffeull));
+	expect_uint128("uint128_mulmod", uint128_mulmod(test6_a, test6_b, &test7_even),
+		0xfd8b22b2b7070af8ull, 0x60c5de82b1b25a4aull);
+	expect_uint128("uint128_powmod", uint128_powmod(test6_b, test6_a, &test7_even),
+		0xea16c7bfc3ed646full, 0x454d2b580464215aull);
+
+	const uint128_modulus_t test7_small = uint128_modulus_init(uint128_value(1000000007));
+	expect_uint128("uint128_powmod", uint128_powmod(test6_b, test6_a, &test7_small), 0, 0x263101a7ull);
+	const uint128_modulus_t test7_one = uint128_modulus_init(uint128_value(1));
+	expect_uint128("uint128_powmod", uint128_powmod(test6_b, uint128_value(0), &test7_one), 0, 0);
+
+	// primes, strong pseudoprimes to the first 12 and 13 prime bases, and squares of primes
+	const char *test7_primes[] = {"2", "41", "18446744073709551557", "170141183460469231731687303715884105727",
+		"340282366920938463463374607431768211297", "3317044064679887385962123"};
+	const char *test7_composites[] = {"0", "1", "1681", "3215031751", "318665857834031151167461",
+		"3317044064679887385961981", "5316911983139663487003542222693990401", "340282366920938463463374607431768211455"};
+	for (unsigned i = 0; i < sizeof(test7_primes) / sizeof(*test7_primes); i++) {
+		if (!uint128_is_prime(uint128_parse(test7_primes[i]))) {
+			printf("!ERROR! Problem with uint128_is_prime:\n\t%s is a prime\n", test7_primes[i]);
+			exit(-1);
+		}
+	}
+	for (unsigned i = 0; i < sizeof(test7_composites) / sizeof(*test7_composites); i++) {
+		if (uint128_is_prime(uint128_parse(test7_composites[i]))) {
+			printf("!ERROR! Problem with uint128_is_prime:\n\t%s is not a prime\n", test7_composites[i]);
+			exit(-1);
+		}
+	}
+
+	puts("[\\7] Test block has been passed!");
+
+	puts("[8] 256-bit and 512-bit integer tests");
+
+	char test8_buffer[UINT512_STRING_SIZE];
+	const uint256_t test8_a = uint256_parse("0x0123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210");
+	const uint256_t test8_b = uint256_from_uint128(test6_b);
+	expect_formatted("uint256_parse", uint256_to_string(test8_a, test8_buffer, 10),
+		"514631507721405312519378913364952599439317176483405283752361400573829067280");
+	expect_uint128("uint256_to_uint128", uint256_to_uint128(test8_a), 0x0123456789abcdefull, 0xfedcba9876543210ull);
+	expect_formatted("uint256_multiply", uint256_to_string(uint256_multiply(test8_a, test8_b), test8_buffer, 16),
+		"fc8dc6d3c8546ada0372392c37ab9525fb906af4d9a1cabba61e93d5bda4d000");
+	const uint256_divrem_result test8_divided = uint256_divrem(test8_a, test8_b);
+	expect_formatted("uint256_divrem quotient", uint256_to_string(test8_divided.quotient, test8_buffer, 16),
+		"14edb42704c8c421874bcf747ce6881");
+	expect_formatted("uint256_divrem remainder", uint256_to_string(test8_divided.remainder, test8_buffer, 16),
+		"1f60f537fc7b4707eb30ec8708580510");
+	expect_formatted("uint256_add", uint256_to_string(uint256_add(uint256_multiply(test8_divided.quotient, test8_b),
+		test8_divided.remainder), test8_buffer, 16), "123456789abcdeffedcba98765432100123456789abcdeffedcba9876543210");
+
+	// everything wraps around modulo 2^256
+	const uint256_t test8_max = uint256_subtract(uint256_value(0), uint256_value(1));
+	expect_formatted("uint256_subtract", uint256_to_string(test8_max, test8_buffer, 16),
+		"ffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+	expect_formatted("uint256_multiply", uint256_to_string(uint256_multiply(test8_max, test8_max), test8_buffer, 10), "1");
+	expect_formatted("uint256_add", uint256_to_string(uint256_add(test8_max, uint256_value(1)), test8_buffer, 2), "0");
+	expect_formatted("uint256_shift_left", uint256_to_string(uint256_shift_left(uint256_value(1), 255), test8_buffer, 16),
+		"8000000000000000000000000000000000000000000000000000000000000000");
+	expect_formatted("uint256_shift_right", uint256_to_string(uint256_shift_right(test8_max, 200), test8_buffer, 16),
+		"ffffffffffffff");
+	expect_formatted("uint256_shift_left", uint256_to_string(uint256_shift_left(test8_max, 256), test8_buffer, 10), "0");
+	if (!(uint256_lt(test8_b, test8_a) && uint256_gt(test8_max, test8_a) && uint256_cmp(test8_a, test8_a) == 0 &&
+		  uint256_lte(test8_a, test8_a) && uint256_gte(test8_a, test8_b) && !uint256_equ(test8_a, test8_b))) {
+		puts("!ERROR! Problem with the uint256 comparisons");
+		exit(-1);
+	}
+
+	const uint512_t test8_c = uint512_parse("136891479058588375991326027382088315966463695625337436471480190078368997177499"
+		"076593800206155688941388250484440597994042813512732765695774566001");
+	expect_formatted("uint512_parse", uint512_to_string(test8_c, test8_buffer, 16),
+		"b39cfff485a5dbf4d6aae030b91bfb0ec6bba389cd8d7f85bba3985c19c5e24e40c543a123c6e028a873e9e3874e1b4623a44be39b34e67dc5c2671");
+	const uint512_t test8_d = uint512_parse("3234476509624757991344647769100216810857203198904625400933895331391691459636928060001");
+	expect_formatted("uint512_divide", uint512_to_string(uint512_divide(test8_c, test8_d), test8_buffer, 16),
+		"6be0ca32a3bac2416243b06d5127d23cdfae4b97b5b6c0b41");
+	expect_formatted("uint512_mod", uint512_to_string(uint512_mod(test8_c, test8_d), test8_buffer, 16),
+		"23491d410337aff91efc15830510a50136bf5230b62ca990f9020e5907552f358d48d0");
+
+	const char test8_max_decimal[] = "13407807929942597099574024998205846127479365820592393377723561443721764030073546976801"
+		"874298166903427690031858186486050853753882811946569946433649006084095";
+	uint512_t test8_parsed;
+	const char *test8_stop;
+	if (uint512_parse_n(test8_max_decimal, test8_max_decimal + sizeof(test8_max_decimal) - 1, 10, &test8_parsed,
+						&test8_stop) != UINT128_PARSE_OK ||
+		!uint512_equ(test8_parsed, uint512_subtract(uint512_value(0), uint512_value(1)))) {
+		puts("!ERROR! Problem with uint512_parse_n:\n\tThe maximum value hasn't been parsed");
+		exit(-1);
+	}
+	// one more than the maximum
+	const char test8_overflow[] = "13407807929942597099574024998205846127479365820592393377723561443721764030073546976801"
+		"874298166903427690031858186486050853753882811946569946433649006084096!";
+	if (uint512_parse_n(test8_overflow, test8_overflow + sizeof(test8_overflow) - 1, 0, &test8_parsed, &test8_stop) !=
+		UINT128_PARSE_OVERFLOW || *test8_stop != '!') {
+		puts("!ERROR! Problem with uint512_parse_n:\n\tThe value one more than the maximum hasn't overflowed");
+		exit(-1);
+	}
+	expect_formatted("uint512_to_string", uint512_to_string(uint512_from_uint128(test3_max), test8_buffer, 36),
+		"f5lxx1zz5pnorynqglhzmsp33");
+
+	puts("[\\8] Test block has been passed!");
+
+	puts("[9] Natural number tests");
+
+	// the carries have to propagate through all of the limbs
+	uint64_t test9_sum[3] = {UINT64_MAX, UINT64_MAX, 7};
+	const uint64_t test9_one[3] = {1, 0, 0};
+	if (natural_add_n(test9_sum, test9_sum, test9_one, 3) != 0 || test9_sum[0] != 0 || test9_sum[1] != 0 ||
+		test9_sum[2] != 8 || natural_sub_1(test9_sum, test9_sum, 3, 1) != 0 || test9_sum[0] != UINT64_MAX ||
+		test9_sum[2] != 7 || natural_sub_n(test9_sum, test9_one, test9_sum, 3) != 1 || test9_sum[0] != 2) {
+		puts("!ERROR! Problem with natural_add_n and natural_sub_n");
+		exit(-1);
+	}
+
+	// 2^128 / 3
+	const uint64_t test9_power[3] = {0, 0, 1};
+	uint64_t test9_third[3];
+	const uint128_divisor_t test9_three = uint128_divisor_init(uint128_value(3));
+	if (natural_divrem_1(test9_third, test9_power, 3, &test9_three) != 1 || test9_third[0] != 0x5555555555555555ull ||
+		test9_third[1] != 0x5555555555555555ull || test9_third[2] != 0) {
+		puts("!ERROR! Problem with natural_divrem_1");
+		exit(-1);
+	}
+
+	// operands long enough for Karatsuba's algorithm, both balanced and not, filled using a simple LCG
+	enum { test9_an = 3 * NATURAL_KARATSUBA_THRESHOLD + 5, test9_bn = 2 * NATURAL_KARATSUBA_THRESHOLD + 3 };
+	static uint64_t test9_a[test9_an], test9_b[test9_bn], test9_product[2 * test9_an],
+		test9_expected[2 * test9_an], test9_quotient[test9_an + 1], test9_remainder[test9_bn];
+	uint64_t test9_state = 0x0123456789abcdefull;
+	for (size_t i = 0; i < test9_an; i++) {
+		test9_state = test9_state * 6364136223846793005ull + 1442695040888963407ull;
+		// runs of all-ones limbs make the carries longer
+		test9_a[i] = i % 7 == 3 ? UINT64_MAX : test9_state;
+		if (i < test9_bn)
+			test9_b[i] = i % 5 == 1 ? UINT64_MAX : test9_state ^ (test9_state >> 29);
+	}
+	static uint64_t test9_scratch[8 * test9_an];
+	for (size_t bn = test9_bn; bn <= test9_an; bn += test9_an - test9_bn) {
+		const uint64_t * const b = bn == test9_an ? test9_a : test9_b;
+		if (natural_mul_scratch_size(test9_an, bn) > sizeof(test9_scratch) / sizeof(uint64_t)) {
+			puts("!ERROR! Problem with natural_mul_scratch_size:\n\tThe scratch space is too large");
+			exit(-1);
+		}
+		natural_mul_basecase(test9_expected, test9_a, test9_an, b, bn);
+		natural_mul(test9_product, test9_a, test9_an, b, bn, test9_scratch);
+		if (natural_cmp(test9_product, test9_expected, test9_an + bn) != 0) {
+			puts("!ERROR! Problem with natural_mul:\n\tThe Karatsuba product differs from the schoolbook one");
+			exit(-1);
+		}
+	}
+
+	// (a * b + b - 1) / b has to give back a with the remainder b - 1
+	natural_mul(test9_product, test9_a, test9_an, test9_b, test9_bn, test9_scratch);
+	uint64_t test9_b_minus_1[test9_bn];
+	natural_sub_1(test9_b_minus_1, test9_b, test9_bn, 1);
+	natural_add_1(test9_product + test9_bn, test9_product + test9_bn, test9_an,
+		natural_add_n(test9_product, test9_product, test9_b_minus_1, test9_bn));
+	if (natural_divrem_scratch_size(test9_an + test9_bn, test9_bn) > sizeof(test9_scratch) / sizeof(uint64_t)) {
+		puts("!ERROR! Problem with natural_divrem_scratch_size:\n\tThe scratch space is too large");
+		exit(-1);
+	}
+	natural_divrem(test9_quotient, test9_remainder, test9_product, test9_an + test9_bn, test9_b, test9_bn,
+		test9_scratch);
+	if (natural_cmp(test9_quotient, test9_a, test9_an) != 0 || test9_quotient[test9_an] != 0 ||
+		natural_cmp(test9_remainder, test9_b_minus_1, test9_bn) != 0) {
+		puts("!ERROR! Problem with natural_divrem");
+		exit(-1);
+	}
+
+	// the same with a single-limb divisor, multiplying back with natural_mul_1
+	const uint128_divisor_t test9_chunk = uint128_divisor_init(uint128_value(10000000000000000000ull));
+	const uint64_t test9_chunk_remainder = natural_divrem_1(test9_quotient, test9_a, test9_an, &test9_chunk);
+	if (natural_mul_1(test9_quotient, test9_quotient, test9_an, 10000000000000000000ull) != 0 ||
+		natural_add_1(test9_quotient, test9_quotient, test9_an, test9_chunk_remainder) != 0 ||
+		natural_cmp(test9_quotient, test9_a, test9_an) != 0 || test9_chunk_remainder >= 10000000000000000000ull) {
+		puts("!ERROR! Problem with natural_divrem_1");
+		exit(-1);
+	}
+
+	puts("[\\9] Test block has been passed!");
+
+	puts("[10] Atomic tests");
+
+	static atomic_uint128_t test10_atomic;
+	atomic_uint128_init(&test10_atomic, uint128_create(0x0123456789abcdefull, UINT64_MAX));
+	uint128_t test10_expected = uint128_value(5);
+	if (atomic_uint128_compare_exchange(&test10_atomic, &test10_expected, uint128_value(0))) {
+		puts("!ERROR! Problem with atomic_uint128_compare_exchange:\n\tThe value has been replaced even though it differs");
+		exit(-1);
+	}
+	expect_uint128("atomic_uint128_compare_exchange", test10_expected, 0x0123456789abcdefull, UINT64_MAX);
+	if (!atomic_uint128_compare_exchange(&test10_atomic, &test10_expected, uint128_create(1, 2))) {
+		puts("!ERROR! Problem with atomic_uint128_compare_exchange:\n\tThe value hasn't been replaced");
+		exit(-1);
+	}
+	expect_uint128("atomic_uint128_load", atomic_uint128_load(&test10_atomic), 1, 2);
+	expect_uint128("atomic_uint128_fetch_add", atomic_uint128_fetch_add(&test10_atomic, uint128_value(UINT64_MAX)), 1, 2);
+	expect_uint128("atomic_uint128_fetch_or", atomic_uint128_fetch_or(&test10_atomic, uint128_create(0x10, 0)), 2, 1);
+	expect_uint128("atomic_uint128_exchange", atomic_uint128_exchange(&test10_atomic, uint128_value(7)), 0x12, 1);
+	atomic_uint128_store(&test10_atomic, uint128_value(0));
+	expect_uint128("atomic_uint128_store", atomic_uint128_load(&test10_atomic), 0, 0);
+	printf("Atomic uint128 is %slock-free\n", atomic_uint128_is_lock_free(&test10_atomic) ? "" : "not ");
+
+	pthread_t test10_threads[ATOMIC_TEST_THREADS];
+	for (int i = 0; i < ATOMIC_TEST_THREADS; i++)
+		pthread_create(&test10_threads[i], NULL, atomic_test_thread, &test10_atomic);
+	for (int i = 0; i < ATOMIC_TEST_THREADS; i++)
+		pthread_join(test10_threads[i], NULL);
+	expect_uint128("atomic_uint128_fetch_add from many threads", atomic_uint128_load(&test10_atomic),
+		ATOMIC_TEST_THREADS * ATOMIC_TEST_INCREMENTS, ATOMIC_TEST_THREADS * ATOMIC_TEST_INCREMENTS);
+
+	puts("[\\10] Test block has been passed!");
+
+	puts("[11] Hash map tests");
+
+	// keys which only differ in one half, so that both halves have to be hashed and compared
+	#define MAP_TEST_KEYS 5000
+	static uint128_t test11_keys[MAP_TEST_KEYS];
+	static uint64_t test11_values[MAP_TEST_KEYS];
+	for (uint64_t i = 0; i < MAP_TEST_KEYS; i++) {
+		test11_keys[i] = (i & 1) ? uint128_create(i, 0) : uint128_create(0, i);
+		test11_values[i] = i * 3;
+	}
+	uint128_map_t test11_map;
+	uint128_map_init(&test11_map);
+	if (uint128_map_find(&test11_map, test11_keys[0]) != NULL || uint128_map_erase(&test11_map, test11_keys[0])) {
+		puts("!ERROR! Problem with uint128_map_find:\n\tAn empty map has a key");
+		exit(-1);
+	}
+	for (size_t i = 0; i < MAP_TEST_KEYS; i++) {
+		if (uint128_map_insert(&test11_map, test11_keys[i], test11_values[i]) != UINT128_MAP_INSERTED) {
+			puts("!ERROR! Problem with uint128_map_insert:\n\tA new key hasn't been inserted");
+			exit(-1);
+		}
+	}
+	if (uint128_map_insert(&test11_map, test11_keys[7], 1) != UINT128_MAP_UPDATED ||
+		*uint128_map_find(&test11_map, test11_keys[7]) != 1) {
+		puts("!ERROR! Problem with uint128_map_insert:\n\tThe value of an existing key hasn't been replaced");
+		exit(-1);
+	}
+	test11_values[7] = 1;
+
+	// erase every third key, then insert them back, which reuses the deleted slots
+	for (size_t i = 0; i < MAP_TEST_KEYS; i += 3) {
+		if (!uint128_map_erase(&test11_map, test11_keys[i]) || uint128_map_erase(&test11_map, test11_keys[i])) {
+			puts("!ERROR! Problem with uint128_map_erase");
+			exit(-1);
+		}
+	}
+	for (size_t i = 0; i < MAP_TEST_KEYS; i++) {
+		const uint64_t * const found = uint128_map_find(&test11_map, test11_keys[i]);
+		if ((i % 3 == 0) != (found == NULL) || (found != NULL && *found != test11_values[i])) {
+			puts("!ERROR! Problem with uint128_map_find after uint128_map_erase");
+			exit(-1);
+		}
+	}
+	for (size_t i = 0; i < MAP_TEST_KEYS; i += 3)
+		uint128_map_insert(&test11_map, test11_keys[i], test11_values[i]);
+	// besides the slots, the map only allocates the copies of the first group of control bytes
+	if (test11_map.size != MAP_TEST_KEYS ||
+		uint128_map_memory_size(MAP_TEST_KEYS) / UINT128_MAP_SLOT_SIZE != test11_map.capacity) {
+		puts("!ERROR! Problem with uint128_map_insert:\n\tWrong size of the map");
+		exit(-1);
+	}
+
+	// every key is visited exactly once by the iteration
+	size_t test11_position = 0, test11_visited = 0;
+	uint128_t test11_key;
+	uint64_t test11_value;
+	while (uint128_map_next(&test11_map, &test11_position, &test11_key, &test11_value)) {
+		const uint64_t index = uint128_get_higher(test11_key) | uint128_get_lower(test11_key);
+		if (index >= MAP_TEST_KEYS || !uint128_equ(test11_key, test11_keys[index]) ||
+			test11_value != test11_values[index]) {
+			puts("!ERROR! Problem with uint128_map_next:\n\tWrong entry");
+			exit(-1);
+		}
+		test11_visited++;
+	}
+	if (test11_visited != MAP_TEST_KEYS) {
+		puts("!ERROR! Problem with uint128_map_next:\n\tWrong number of entries");
+		exit(-1);
+	}
+	uint128_map_free(&test11_map);
+
+	// inserting all of the keys at once gives the same map, and doesn't grow after reserving
+	if (!uint128_map_reserve(&test11_map, MAP_TEST_KEYS) ||
+		uint128_map_insert_many(&test11_map, test11_keys, test11_values, MAP_TEST_KEYS) != UINT128_MAP_INSERTED ||
+		test11_map.size != MAP_TEST_KEYS ||
+		uint128_map_memory_size(MAP_TEST_KEYS) / UINT128_MAP_SLOT_SIZE != test11_map.capacity) {
+		puts("!ERROR! Problem with uint128_map_insert_many");
+		exit(-1);
+	}
+	for (size_t i = 0; i < MAP_TEST_KEYS; i++) {
+		const uint64_t * const found = uint128_map_find(&test11_map, test11_keys[i]);
+		if (found == NULL || *found != test11_values[i]) {
+			puts("!ERROR! Problem with uint128_map_find after uint128_map_insert_many");
+			exit(-1);
+		}
+	}
+	if (uint128_map_find(&test11_map, uint128_create(1, 1)) != NULL ||
+		uint128_map_reserve(&test11_map, SIZE_MAX) || test11_map.size != MAP_TEST_KEYS) {
+		puts("!ERROR! Problem with uint128_map_reserve");
+		exit(-1);
+	}
+	uint128_map_free(&test11_map);
+	#undef MAP_TEST_KEYS
+
+	puts("[\\11] Test block has been passed!");
+
+	puts("[12] Sort tests");
+
+	// enough keys for two threads, with the higher halves mostly zero, so that some of the digits are skipped,
+	// and many duplicates
+	#define SORT_TEST_KEYS 140000
+	static uint128_t test12_keys[SORT_TEST_KEYS], test12_sorted[SORT_TEST_KEYS];
+	uint64_t test12_state = 1;
+	for (size_t i = 0; i < SORT_TEST_KEYS; i++) {
+		test12_state = test12_state * 6364136223846793005ull + 1442695040888963407ull;
+		test12_keys[i] = uint128_create((test12_state >> 60) & 3, test12_state >> (i & 32));
+	}
+	for (unsigned variant = 0; variant < 3; variant++) {
+		const size_t n = variant == 0 ? 40 : SORT_TEST_KEYS;
+		memcpy(test12_sorted, test12_keys, n * sizeof(uint128_t));
+		if (variant == 2)
+			uint128_sort_in_place(test12_sorted, n);
+		else
+			uint128_sort(test12_sorted, n, 2);
+		// the keys are in order, and they are the same keys, since their sum hasn't changed
+		uint128_t sum = uint128_value(0), sorted_sum = uint128_value(0);
+		for (size_t i = 0; i < n; i++) {
+			sum = uint128_add(sum, uint128_multiply(test12_keys[i], test12_keys[i]));
+			sorted_sum = uint128_add(sorted_sum, uint128_multiply(test12_sorted[i], test12_sorted[i]));
+			if (i > 0 && uint128_lt(test12_sorted[i], test12_sorted[i - 1])) {
+				printf("!ERROR! Problem with %s:\n\tThe keys aren't sorted\n",
+					   variant == 2 ? "uint128_sort_in_place" : "uint128_sort");
+				exit(-1);
+			}
+		}
+		if (!uint128_equ(sum, sorted_sum)) {
+			printf("!ERROR! Problem with %s:\n\tThe keys have changed\n",
+				   variant == 2 ? "uint128_sort_in_place" : "uint128_sort");
+			exit(-1);
+		}
+	}
+	#undef SORT_TEST_KEYS
+
+	puts("[\\12] Test block has been passed!");
+
+	puts("[13] Array tests");
+
+	// an odd number of elements, so that the vectorized loops leave some to the scalar ones, with the carries
+	// and borrows between the halves in every possible combination
+	#define ARRAY_TEST_SIZE 19
+	static uint128_t test13_a[ARRAY_TEST_SIZE], test13_b[ARRAY_TEST_SIZE], test13_result[ARRAY_TEST_SIZE];
+	static uint64_t test13_a_higher[ARRAY_TEST_SIZE], test13_a_lower[ARRAY_TEST_SIZE];
+	static uint64_t test13_b_higher[ARRAY_TEST_SIZE], test13_b_lower[ARRAY_TEST_SIZE];
+	static uint64_t test13_result_higher[ARRAY_TEST_SIZE], test13_result_lower[ARRAY_TEST_SIZE];
+	static uint64_t test13_multipliers[ARRAY_TEST_SIZE];
+	static int8_t test13_comparisons[ARRAY_TEST_SIZE], test13_soa_comparisons[ARRAY_TEST_SIZE];
+	const uint64_t test13_halves[4] = {0, 1, UINT64_MAX - 1, UINT64_MAX};
+	for (size_t i = 0; i < ARRAY_TEST_SIZE; i++) {
+		test13_a_higher[i] = test13_halves[i & 3];
+		test13_a_lower[i] = test13_halves[(i >> 2) & 3];
+		test13_b_higher[i] = test13_halves[(i * 7) & 3];
+		test13_b_lower[i] = test13_halves[(i * 3 + 1) & 3];
+		test13_a[i] = uint128_create(test13_a_higher[i], test13_a_lower[i]);
+		test13_b[i] = uint128_create(test13_b_higher[i], test13_b_lower[i]);
+		test13_multipliers[i] = UINT64_MAX - i;
+	}
+	const uint128_soa_t test13_soa_a = {test13_a_higher, test13_a_lower};
+	const uint128_soa_t test13_soa_b = {test13_b_higher, test13_b_lower};
+	const uint128_soa_t test13_soa_result = {test13_result_higher, test13_result_lower};
+	for (unsigned operation = 0; operation < 3; operation++) {
+		static const char * const names[3] = {"uint128_add_array", "uint128_sub_array", "uint128_mul_uint64_array"};
+		if (operation == 0) {
+			uint128_add_array(test13_result, test13_a, test13_b, ARRAY_TEST_SIZE);
+			uint128_add_array_soa(test13_soa_result, test13_soa_a, test13_soa_b, ARRAY_TEST_SIZE);
+		} else if (operation == 1) {
+			uint128_sub_array(test13_result, test13_a, test13_b, ARRAY_TEST_SIZE);
+			uint128_sub_array_soa(test13_soa_result, test13_soa_a, test13_soa_b, ARRAY_TEST_SIZE);
+		} else {
+			uint128_mul_uint64_array(test13_result, test13_a, test13_multipliers, ARRAY_TEST_SIZE);
+			uint128_mul_uint64_array_soa(test13_soa_result, test13_soa_a, test13_multipliers, ARRAY_TEST_SIZE);
+		}
+		for (size_t i = 0; i < ARRAY_TEST_SIZE; i++) {
+			const uint128_t expected = operation == 0 ? uint128_add(test13_a[i], test13_b[i]) :
+				operation == 1 ? uint128_subtract(test13_a[i], test13_b[i]) :
+				uint128_multiply_uint64(test13_a[i], test13_multipliers[i]);
+			expect_uint128(names[operation], test13_result[i], uint128_get_higher(expected),
+				uint128_get_lower(expected));
+			expect_uint128(names[operation], uint128_create(test13_result_higher[i], test13_result_lower[i]),
+				uint128_get_higher(expected), uint128_get_lower(expected));
+		}
+	}
+
+	uint128_cmp_array(test13_comparisons, test13_a, test13_b, ARRAY_TEST_SIZE);
+	uint128_cmp_array_soa(test13_soa_comparisons, test13_soa_a, test13_soa_b, ARRAY_TEST_SIZE);
+	uint128_t test13_sum = uint128_value(0);
+	for (size_t i = 0; i < ARRAY_TEST_SIZE; i++) {
+		const int expected = uint128_lt(test13_b[i], test13_a[i]) - uint128_lt(test13_a[i], test13_b[i]);
+		if (test13_comparisons[i] != expected || test13_soa_comparisons[i] != expected) {
+			puts("!ERROR! Problem with uint128_cmp_array");
+			exit(-1);
+		}
+		test13_sum = uint128_add(test13_sum, test13_a[i]);
+	}
+	expect_uint128("uint128_sum", uint128_sum(test13_a, ARRAY_TEST_SIZE), uint128_get_higher(test13_sum),
+		uint128_get_lower(test13_sum));
+	expect_uint128("uint128_sum_soa", uint128_sum_soa(test13_soa_a, ARRAY_TEST_SIZE), uint128_get_higher(test13_sum),
+		uint128_get_lower(test13_sum));
+	#undef ARRAY_TEST_SIZE
+
+	puts("[\\13] Test block has been passed!");
+
+	puts("[14] Out-parameter tests");
+
+	const uint128_t test14_a = uint128_create(0xfedcba9876543210ull, 0x0123456789abcdefull);
+	const uint128_t test14_b = uint128_create(0x1234, 0xffffffffffffffffull);
+	uint128_t test14_quotient, test14_remainder, test14_value;
+	const uint128_divrem_result test14_expected = uint128_divrem(test14_a, test14_b);
+	uint128_divrem_to(&test14_quotient, &test14_remainder, test14_a, test14_b);
+	expect_uint128("uint128_divrem_to", test14_quotient, uint128_get_higher(test14_expected.quotient),
+		uint128_get_lower(test14_expected.quotient));
+	expect_uint128("uint128_divrem_to", test14_remainder, uint128_get_higher(test14_expected.remainder),
+		uint128_get_lower(test14_expected.remainder));
+	const uint128_divisor_t test14_divisor = uint128_divisor_init(test14_b);
+	uint128_divrem_by_to(&test14_quotient, &test14_remainder, test14_a, &test14_divisor);
+	expect_uint128("uint128_divrem_by_to", test14_quotient, uint128_get_higher(test14_expected.quotient),
+		uint128_get_lower(test14_expected.quotient));
+	expect_uint128("uint128_divrem_by_to", test14_remainder, uint128_get_higher(test14_expected.remainder),
+		uint128_get_lower(test14_expected.remainder));
+
+	// a chain of operations on the same accumulator, checked against the by-value functions
+	uint128_t test14_expected_value = test14_a;
+	test14_value = test14_a;
+	uint128_add_assign(&test14_value, test14_b);
+	uint128_multiply_uint64_assign(&test14_value, 0x9e3779b97f4a7c15ull);
+	uint128_subtract_uint64_assign(&test14_value, 12345);
+	uint128_shift_right_assign(&test14_value, 3);
+	uint128_mod_assign(&test14_value, test14_a);
+	uint128_divide_uint64_assign(&test14_value, 1000);
+	uint128_multiply_assign(&test14_value, test14_b);
+	uint128_div_by_assign(&test14_value, &test14_divisor);
+	test14_expected_value = uint128_add(test14_expected_value, test14_b);
+	test14_expected_value = uint128_multiply_uint64(test14_expected_value, 0x9e3779b97f4a7c15ull);
+	test14_expected_value = uint128_subtract_uint64(test14_expected_value, 12345);
+	test14_expected_value = uint128_shift_right(test14_expected_value, 3);
+	test14_expected_value = uint128_mod(test14_expected_value, test14_a);
+	test14_expected_value = uint128_divide_uint64(test14_expected_value, 1000);
+	test14_expected_value = uint128_multiply(test14_expected_value, test14_b);
+	test14_expected_value = uint128_div_by(test14_expected_value, &test14_divisor);
+	expect_uint128("uint128_*_assign", test14_value, uint128_get_higher(test14_expected_value),
+		uint128_get_lower(test14_expected_value));
+	uint128_shift_left_to(&test14_value, test14_a, 68);
+	expect_uint128("uint128_shift_left_to", test14_value, 0x123456789abcdef0ull, 0);
+	uint128_mod_by_to(&test14_value, test14_a, &test14_divisor);
+	expect_uint128("uint128_mod_by_to", test14_value, uint128_get_higher(test14_expected.remainder),
+		uint128_get_lower(test14_expected.remainder));
+
+	puts("[\\14] Test block has been passed!");
+
+	puts("[15] Text to binary conversion tests");
+
+	// the text is large enough to be split between several threads, every 7th line ends with "\r\n", every 1000th
+	// one can't be parsed and the last one doesn't end with a newline
+	#define CONVERT_TEST_LINES 20000
+	static char test15_text[CONVERT_TEST_LINES * 40];
+	static unsigned char test15_output[CONVERT_TEST_LINES * UINT128_CONVERT_VALUE_SIZE];
+	size_t test15_length = 0;
+	for (size_t i = 0; i < CONVERT_TEST_LINES; i++) {
+		const uint64_t higher = i % 3 == 0 ? i * 0x9e3779b97f4a7c15ull : 0, lower = ~i * 0xc2b2ae3d27d4eb4full;
+		const char * const newline = i == CONVERT_TEST_LINES - 1 ? "" : i % 7 == 0 ? "\r\n" : "\n";
+		if (i % 1000 == 999)
+			test15_length += sprintf(test15_text + test15_length, "%llu?%s", (unsigned long long)lower, newline);
+		else if (higher != 0)
+			test15_length += sprintf(test15_text + test15_length, "0x%016llx%016llx%s", (unsigned long long)higher,
+									 (unsigned long long)lower, newline);
+		else
+			test15_length += sprintf(test15_text + test15_length, "%llu%s", (unsigned long long)lower, newline);
+	}
+	const size_t test15_lines = uint128_convert_count(test15_text, test15_length, 4);
+	if (test15_lines != CONVERT_TEST_LINES) {
+		printf(
+			"!ERROR! Problem with uint128_convert_count:\n"
+			"\tCounted %zu lines instead of %d\n",
+			test15_lines, CONVERT_TEST_LINES);
+		exit(-1);
+	}
+	for (unsigned threads = 1; threads <= 4; threads += 3) {
+		memset(test15_output, 0xff, sizeof(test15_output));
+		uint128_convert_chunk test15_chunks[4];
+		const uint128_convert_result test15_result = uint128_convert_chunks(test15_text, test15_length, 0,
+																			test15_output, threads, test15_chunks);
+		if (test15_result.values != CONVERT_TEST_LINES || test15_result.errors != CONVERT_TEST_LINES / 1000 ||
+			test15_result.first_error_line != 999 || test15_result.first_error_status != UINT128_PARSE_INVALID_DIGIT ||
+			test15_result.chunks != threads) {
+			printf(
+				"!ERROR! Problem with uint128_convert_chunks:\n"
+				"\tWith %u threads returned %zu values and %zu errors in %u chunks, the first one at line %zu\n",
+				threads, test15_result.values, test15_result.errors, test15_result.chunks,
+				test15_result.first_error_line);
+			exit(-1);
+		}
+		// the chunks follow each other, and every one of them has the errors of its own lines
+		size_t test15_next_line = 0;
+		for (unsigned chunk = 0; chunk < test15_result.chunks; chunk++) {
+			const uint128_convert_chunk * const current = &test15_chunks[chunk];
+			const size_t end = current->first_line + current->lines;
+			const size_t expected_errors = (end + 1) / 1000 - (current->first_line + 1) / 1000;
+			if (current->first_line != test15_next_line || current->errors != expected_errors ||
+				(current->errors != 0 && current->first_error_line % 1000 != 999)) {
+				printf(
+					"!ERROR! Problem with uint128_convert_chunks:\n"
+					"\tWith %u threads the chunk %u has %zu lines from %zu and %zu errors\n",
+					threads, chunk, current->lines, current->first_line, current->errors);
+				exit(-1);
+			}
+			test15_next_line = end;
+		}
+		for (size_t i = 0; i < CONVERT_TEST_LINES; i++) {
+			uint64_t higher = 0, lower = 0;
+			for (unsigned byte = 0; byte < 8; byte++) {
+				lower |= (uint64_t)test15_output[i * UINT128_CONVERT_VALUE_SIZE + byte] << (8 * byte);
+				higher |= (uint64_t)test15_output[i * UINT128_CONVERT_VALUE_SIZE + 8 + byte] << (8 * byte);
+			}
+			const uint64_t expected_higher = i % 1000 == 999 || i % 3 != 0 ? 0 : i * 0x9e3779b97f4a7c15ull;
+			const uint64_t expected_lower = i % 1000 == 999 ? 0 : ~i * 0xc2b2ae3d27d4eb4full;
+			if (higher != expected_higher || lower != expected_lower) {
+				printf(
+					"!ERROR! Problem with uint128_convert_chunks:\n"
+					"\tWith %u threads the line %zu was converted into 0x%016llx%016llx\n",
+					threads, i, (unsigned long long)higher, (unsigned long long)lower);
+				exit(-1);
+			}
+		}
+	}
+
+	// empty lines and a forced base
+	const char test15_small[] = "ff\n\nFF\r\n0x10\n";
+	const uint128_convert_result test15_small_result = uint128_convert(test15_small, sizeof(test15_small) - 1, 16,
+																	   test15_output, 2);
+	if (test15_small_result.values != 4 || test15_small_result.errors != 2 ||
+		test15_small_result.first_error_line != 1 || test15_small_result.first_error_status != UINT128_PARSE_EMPTY ||
+		test15_output[0] != 0xff || test15_output[UINT128_CONVERT_VALUE_SIZE * 2] != 0xff) {
+		printf(
+			"!ERROR! Problem with uint128_convert:\n"
+			"\tThe small text was converted into %zu values with %zu errors\n",
+			test15_small_result.values, test15_small_result.errors);
+		exit(-1);
+	}
+	#undef CONVERT_TEST_LINES
+
+	puts("[\\15] Test block has been passed!");
+
+	puts("[16] Array formatting tests");
+
+	const uint128_t test16_values[] = {
+		uint128_create(0, 0), uint128_create(0, 9), uint128_create(0, 10), uint128_create(0, 9999999999999999999ull),
+		uint128_create(0, 10000000000000000000ull), uint128_create(0x4b3b4ca85a86c47aull, 0x098a224000000000ull),
+		uint128_create(0xffffffffffffffffull, 0xffffffffffffffffull)
+	};
+	const size_t test16_count = sizeof(test16_values) / sizeof(test16_values[0]);
+	const char test16_decimal[] = "0, 9, 10, 9999999999999999999, 10000000000000000000, "
+								  "100000000000000000000000000000000000000, 340282366920938463463374607431768211455";
+	char test16_string[512];
+	if (uint128_format_array_size(test16_values, test16_count, 10, ", ") != sizeof(test16_decimal) - 1 ||
+		uint128_format_array(test16_values, test16_count, 10, ", ", test16_string, sizeof(test16_string)) !=
+		sizeof(test16_decimal) - 1 || strcmp(test16_string, test16_decimal) != 0) {
+		printf(
+			"!ERROR! Problem with uint128_format_array:\n"
+			"\tThe values were formatted as \"%s\" instead of \"%s\"\n",
+			test16_string, test16_decimal);
+		exit(-1);
+	}
+	// every value in other bases is the same as the one written by uint128_format
+	for (unsigned base = 2; base <= 36; base += 7) {
+		char test16_expected[512], *position = test16_expected;
+		for (size_t i = 0; i < test16_count; i++) {
+			position += uint128_format(test16_values[i], position, base);
+			*position++ = '\n';
+		}
+		position[-1] = '\0';
+		const size_t length = (size_t)(position - test16_expected - 1);
+		if (uint128_format_array_size(test16_values, test16_count, base, "\n") != length ||
+			uint128_format_array(test16_values, test16_count, base, "\n", test16_string, sizeof(test16_string)) !=
+			length || strcmp(test16_string, test16_expected) != 0) {
+			printf(
+				"!ERROR! Problem with uint128_format_array:\n"
+				"\tThe values in base %u were formatted as \"%s\" instead of \"%s\"\n",
+				base, test16_string, test16_expected);
+			exit(-1);
+		}
+	}
+	// nothing is written if the string doesn't fit, including the terminating zero
+	strcpy(test16_string, "unchanged");
+	if (uint128_format_array(test16_values, test16_count, 10, ", ", test16_string, sizeof(test16_decimal) - 1) != 0 ||
+		strcmp(test16_string, "unchanged") != 0 ||
+		uint128_format_array(test16_values, 3, 10, NULL, test16_string, sizeof(test16_string)) != 4 ||
+		strcmp(test16_string, "0910") != 0 ||
+		uint128_format_array(test16_values, test16_count, 37, ", ", test16_string, sizeof(test16_string)) != 0) {
+		puts("!ERROR! Problem with uint128_format_array:\n"
+			 "\tA small capacity, no separator or an invalid base weren't handled");
+		exit(-1);
+	}
+
+	puts("[\\16] Test block has been passed!");
+
+	puts("[17] Byte order tests");
+
+	const unsigned char test17_be[17] = {0, 0x01, 0x23, 0x45, 0x67, 0x89, 0xab, 0xcd, 0xef,
+										 0xfe, 0xdc, 0xba, 0x98, 0x76, 0x54, 0x32, 0x10};
+	unsigned char test17_bytes[17];
+	// the loads and stores don't need to be aligned
+	const uint128_t test17_value = uint128_load_be(test17_be + 1);
+	expect_uint128("uint128_load_be", test17_value, 0x0123456789abcdefull, 0xfedcba9876543210ull);
+	expect_uint128("uint128_load_le", uint128_load_le(test17_be + 1), 0x1032547698badcfeull, 0xefcdab8967452301ull);
+	uint128_store_le(test17_bytes + 1, test17_value);
+	for (unsigned i = 0; i < 16; i++) {
+		if (test17_bytes[1 + i] != test17_be[16 - i]) {
+			printf(
+				"!ERROR! Problem with uint128_store_le:\n"
+				"\tByte %u was supposed to be %02x, but is actually %02x\n",
+				i, test17_be[16 - i], test17_bytes[1 + i]);
+			exit(-1);
+		}
+	}
+	uint128_store_be(test17_bytes + 1, test17_value);
+	if (memcmp(test17_bytes + 1, test17_be + 1, 16) != 0) {
+		puts("!ERROR! Problem with uint128_store_be:\n\tThe loaded value wasn't stored back");
+		exit(-1);
+	}
+
+	// the arrays are long enough for the vectorized loops, with elements left over for the scalar ones
+	#define BYTE_ORDER_TEST_SIZE 37
+	uint128_t test17_values[BYTE_ORDER_TEST_SIZE], test17_loaded[BYTE_ORDER_TEST_SIZE];
+	unsigned char test17_array[BYTE_ORDER_TEST_SIZE * 16 + 1], test17_swapped[BYTE_ORDER_TEST_SIZE * 16];
+	for (size_t i = 0; i < BYTE_ORDER_TEST_SIZE; i++)
+		test17_values[i] = uint128_create(0x9e3779b97f4a7c15ull * (i + 1), 0xc2b2ae3d27d4eb4full * ~i);
+	uint128_store_be_array(test17_array + 1, test17_values, BYTE_ORDER_TEST_SIZE);
+	uint128_byte_swap_array(test17_swapped, test17_array + 1, BYTE_ORDER_TEST_SIZE);
+	for (size_t i = 0; i < BYTE_ORDER_TEST_SIZE; i++) {
+		if (!uint128_equ(uint128_load_be(test17_array + 1 + 16 * i), test17_values[i]) ||
+			!uint128_equ(uint128_load_le(test17_swapped + 16 * i), test17_values[i])) {
+			printf(
+				"!ERROR! Problem with uint128_store_be_array or uint128_byte_swap_array:\n"
+				"\tElement %zu was stored incorrectly\n",
+				i);
+			exit(-1);
+		}
+	}
+	uint128_load_be_array(test17_loaded, test17_array + 1, BYTE_ORDER_TEST_SIZE);
+	if (memcmp(test17_loaded, test17_values, sizeof(test17_values)) != 0) {
+		puts("!ERROR! Problem with uint128_load_be_array:\n\tThe stored values weren't loaded back");
+		exit(-1);
+	}
+	// swapping in place turns the big-endian array into a little-endian one
+	uint128_byte_swap_array(test17_array + 1, test17_array + 1, BYTE_ORDER_TEST_SIZE);
+	uint128_load_le_array(test17_loaded, test17_array + 1, BYTE_ORDER_TEST_SIZE);
+	uint128_store_le_array(test17_swapped, test17_values, BYTE_ORDER_TEST_SIZE);
+	if (memcmp(test17_loaded, test17_values, sizeof(test17_values)) != 0 ||
+		memcmp(test17_swapped, test17_array + 1, sizeof(test17_swapped)) != 0) {
+		puts("!ERROR! Problem with uint128_byte_swap_array or the little-endian arrays:\n"
+			 "\tThe values swapped in place don't match the little-endian ones");
+		exit(-1);
+	}
+	#undef BYTE_ORDER_TEST_SIZE
+
+	puts("[\\17] Test block has been passed!");
+
+	puts("[18] Varint tests");
+
+	unsigned char test18_bytes[UINT128_LEB128_MAX_SIZE + 8];
+	uint128_t test18_value;
+	// 624485 is the example from the LEB128 specification
+	if (uint128_leb128_encode(uint128_value(624485), test18_bytes) != 3 || test18_bytes[0] != 0xe5 ||
+		test18_bytes[1] != 0x8e || test18_bytes[2] != 0x26 ||
+		uint128_leb128_decode(test18_bytes, 3, &test18_value) != 3) {
+		puts("!ERROR! Problem with uint128_leb128_encode:\n\t624485 wasn't encoded as e5 8e 26");
+		exit(-1);
+	}
+	expect_uint128("uint128_leb128_decode", test18_value, 0, 624485);
+	const uint128_t test18_max = uint128_create(0xffffffffffffffffull, 0xffffffffffffffffull);
+	if (uint128_leb128_encode(test18_max, test18_bytes) != UINT128_LEB128_MAX_SIZE ||
+		test18_bytes[UINT128_LEB128_MAX_SIZE - 1] != 0x03 || uint128_leb128_size(uint128_value(0)) != 1 ||
+		uint128_leb128_decode(test18_bytes, UINT128_LEB128_MAX_SIZE, &test18_value) != UINT128_LEB128_MAX_SIZE) {
+		puts("!ERROR! Problem with uint128_leb128_encode:\n\tThe max value wasn't encoded in 19 bytes");
+		exit(-1);
+	}
+	expect_uint128("uint128_leb128_decode", test18_value, 0xffffffffffffffffull, 0xffffffffffffffffull);
+	// truncated values, values which don't fit into 128 bits and ones longer than the maximum size are rejected
+	test18_bytes[UINT128_LEB128_MAX_SIZE - 1] = 0x04;
+	memset(test18_bytes + UINT128_LEB128_MAX_SIZE, 0x80, 8);
+	const size_t test18_overflow = uint128_leb128_decode(test18_bytes, sizeof(test18_bytes), &test18_value);
+	test18_bytes[UINT128_LEB128_MAX_SIZE - 1] = 0x80;
+	if (uint128_leb128_decode(test18_bytes, UINT128_LEB128_MAX_SIZE - 1, &test18_value) != 0 || test18_overflow != 0 ||
+		uint128_leb128_decode(test18_bytes, sizeof(test18_bytes), &test18_value) != 0) {
+		puts("!ERROR! Problem with uint128_leb128_decode:\n\tAn invalid value was decoded");
+		exit(-1);
+	}
+
+	if (uint128_prefix_varint_encode(uint128_value(0x1234), test18_bytes) != 3 || test18_bytes[0] != 2 ||
+		test18_bytes[1] != 0x34 || test18_bytes[2] != 0x12 || uint128_prefix_varint_size(uint128_value(0)) != 1 ||
+		uint128_prefix_varint_decode(test18_bytes, 3, &test18_value) != 3 ||
+		uint128_prefix_varint_decode(test18_bytes, 2, &test18_value) != 0) {
+		puts("!ERROR! Problem with uint128_prefix_varint_encode:\n\t0x1234 wasn't encoded as 02 34 12");
+		exit(-1);
+	}
+	expect_uint128("uint128_prefix_varint_decode", test18_value, 0, 0x1234);
+
+	// arrays of values of all lengths, the decoding reads up to the exact end of the encoded bytes
+	#define VARINT_TEST_SIZE 129
+	uint128_t test18_values[VARINT_TEST_SIZE], test18_decoded[VARINT_TEST_SIZE];
+	static unsigned char test18_array[VARINT_TEST_SIZE * UINT128_LEB128_MAX_SIZE];
+	for (size_t i = 0; i < VARINT_TEST_SIZE; i++) {
+		test18_values[i] = i == 0 ? uint128_value(0) :
+			uint128_shift_right(uint128_create(0x9e3779b97f4a7c15ull * i, 0xc2b2ae3d27d4eb4full * i), 128 - i);
+	}
+	for (int prefix = 0; prefix < 2; prefix++) {
+		const size_t size = prefix ? uint128_prefix_varint_encode_array(test18_values, VARINT_TEST_SIZE, test18_array) :
+			uint128_leb128_encode_array(test18_values, VARINT_TEST_SIZE, test18_array);
+		memset(test18_decoded, 0, sizeof(test18_decoded));
+		const size_t decoded = prefix ?
+			uint128_prefix_varint_decode_array(test18_array, size, test18_decoded, VARINT_TEST_SIZE) :
+			uint128_leb128_decode_array(test18_array, size, test18_decoded, VARINT_TEST_SIZE);
+		const size_t truncated = prefix ?
+			uint128_prefix_varint_decode_array(test18_array, size - 1, test18_decoded, VARINT_TEST_SIZE) :
+			uint128_leb128_decode_array(test18_array, size - 1, test18_decoded, VARINT_TEST_SIZE);
+		if (decoded != size || truncated != 0 ||
+			memcmp(test18_decoded, test18_values, sizeof(test18_values)) != 0) {
+			printf(
+				"!ERROR! Problem with %s:\n"
+				"\tThe array of %zu bytes was decoded as %zu bytes\n",
+				prefix ? "uint128_prefix_varint_decode_array" : "uint128_leb128_decode_array", size, decoded);
+			exit(-1);
+		}
+	}
+	#undef VARINT_TEST_SIZE
+
+	puts("[\\18] Test block has been passed!");
+
+	puts("[19] Bit packing tests");
+
+	// a sorted column with 20-bit gaps, the last of the 3 blocks isn't full and has differences wider than 64 bits
+	#define PACKING_TEST_SIZE 300
+	static uint128_t test19_values[PACKING_TEST_SIZE], test19_unpacked[PACKING_TEST_SIZE];
+	static unsigned char test19_bytes[PACKING_TEST_SIZE / UINT128_PACKING_BLOCK_VALUES * UINT128_PACKING_MAX_BLOCK_SIZE +
+									  UINT128_PACKING_MAX_BLOCK_SIZE];
+	uint128_t test19_value = uint128_create(0x0123456789abcdefull, 0xfffffffffff00000ull);
+	for (size_t i = 0; i < PACKING_TEST_SIZE; i++) {
+		test19_value = uint128_add(test19_value, uint128_value((0x9e3779b97f4a7c15ull * i) >> 44));
+		test19_values[i] = i < 2 * UINT128_PACKING_BLOCK_VALUES ? test19_value :
+			uint128_add(test19_value, uint128_create(i, 0));
+	}
+	const unsigned test19_width = uint128_pack_width(test19_values, UINT128_PACKING_BLOCK_VALUES);
+	const size_t test19_size = uint128_pack_array(test19_values, PACKING_TEST_SIZE, test19_bytes);
+	if (test19_width != 26 || uint128_pack_size(test19_values, PACKING_TEST_SIZE) != test19_size ||
+		uint128_pack_block(test19_values, UINT128_PACKING_BLOCK_VALUES, test19_bytes) !=
+		uint128_pack_block_size(test19_width)) {
+		printf(
+			"!ERROR! Problem with uint128_pack_array:\n"
+			"\tThe values were packed into %zu bytes with the width %u\n",
+			test19_size, test19_width);
+		exit(-1);
+	}
+	memset(test19_unpacked, 0, sizeof(test19_unpacked));
+	if (uint128_unpack_array(test19_bytes, test19_size, test19_unpacked, PACKING_TEST_SIZE) != test19_size ||
+		memcmp(test19_unpacked, test19_values, sizeof(test19_values)) != 0 ||
+		uint128_unpack_array(test19_bytes, test19_size - 1, test19_unpacked, PACKING_TEST_SIZE) != 0) {
+		puts("!ERROR! Problem with uint128_unpack_array:\n\tThe packed values weren't unpacked back");
+		exit(-1);
+	}
+
+	// the blocks are found by their headers and unpacked without the others
+	size_t test19_offsets[3];
+	if (uint128_pack_index(test19_bytes, test19_size, test19_offsets, 3) != test19_size || test19_offsets[0] != 0 ||
+		test19_offsets[1] != uint128_pack_block_size(test19_width) ||
+		uint128_unpack_block(test19_bytes + test19_offsets[2], test19_size - test19_offsets[2], test19_unpacked) !=
+		PACKING_TEST_SIZE - 2 * UINT128_PACKING_BLOCK_VALUES ||
+		memcmp(test19_unpacked, test19_values + 2 * UINT128_PACKING_BLOCK_VALUES,
+			   (PACKING_TEST_SIZE - 2 * UINT128_PACKING_BLOCK_VALUES) * sizeof(uint128_t)) != 0) {
+		puts("!ERROR! Problem with uint128_unpack_block:\n\tThe last block wasn't unpacked");
+		exit(-1);
+	}
+	for (size_t i = 0; i < PACKING_TEST_SIZE; i += 37) {
+		const uint128_t value = uint128_unpack_block_value(
+			test19_bytes + test19_offsets[i / UINT128_PACKING_BLOCK_VALUES], i % UINT128_PACKING_BLOCK_VALUES);
+		expect_uint128("uint128_unpack_block_value", value, uint128_get_higher(test19_values[i]),
+					   uint128_get_lower(test19_values[i]));
+	}
+	// blocks with an invalid number of bits aren't unpacked
+	test19_bytes[16] = 29;
+	if (uint128_unpack_block(test19_bytes, test19_size, test19_unpacked) != 0) {
+		puts("!ERROR! Problem with uint128_unpack_block:\n\tA block with an invalid width was unpacked");
+		exit(-1);
+	}
+	#undef PACKING_TEST_SIZE
+
+	puts("[\\19] Test block has been passed!");
+
+	puts("[20] Column file tests");
+
+	// a sorted column of the values 3 * i with the higher halves set, in 4 blocks (the last one isn't full)
+	#define COLUMN_TEST_SIZE 1000
+	#define COLUMN_TEST_PATH "uint128_column_test.bin"
+	static uint128_t test20_values[COLUMN_TEST_SIZE];
+	for (size_t i = 0; i < COLUMN_TEST_SIZE; i++)
+		test20_values[i] = uint128_create(7, 3 * i);
+	if (uint128_column_write(COLUMN_TEST_PATH, test20_values, COLUMN_TEST_SIZE, 100) != UINT128_COLUMN_INVALID ||
+		uint128_column_write(COLUMN_TEST_PATH, test20_values, COLUMN_TEST_SIZE, 256) != UINT128_COLUMN_OK) {
+		puts("!ERROR! Problem with uint128_column_write:\n\tThe column wasn't written");
+		exit(-1);
+	}
+	uint128_column_t test20_column;
+	const uint128_column_status test20_status = uint128_column_open(COLUMN_TEST_PATH, &test20_column);
+	if (test20_status != UINT128_COLUMN_UNSUPPORTED) {
+		if (test20_status != UINT128_COLUMN_OK || test20_column.values != COLUMN_TEST_SIZE ||
+			test20_column.blocks != 4) {
+			printf(
+				"!ERROR! Problem with uint128_column_open:\n"
+				"\tThe column was opened with the status %d\n",
+				(int)test20_status);
+			exit(-1);
+		}
+		expect_uint128("uint128_column_get", uint128_column_get(&test20_column, 999), 7, 2997);
+		expect_uint128("uint128_column_block_min", uint128_column_block_min(&test20_column, 3), 7, 768 * 3);
+		expect_uint128("uint128_column_block_max", uint128_column_block_max(&test20_column, 1), 7, 511 * 3);
+
+		// [7:300, 7:1500) has the values from 100 to 499, the block 1 is completely in it
+		static size_t test20_indices[COLUMN_TEST_SIZE];
+		const size_t test20_found = uint128_column_range(&test20_column, uint128_create(7, 300),
+														 uint128_create(7, 1500), test20_indices, COLUMN_TEST_SIZE);
+		int test20_correct = test20_found == 400;
+		for (size_t i = 0; test20_correct && i < test20_found; i++)
+			test20_correct = test20_indices[i] == 100 + i;
+		if (!test20_correct ||
+			uint128_column_range(&test20_column, uint128_create(7, 300), uint128_create(7, 1500), NULL, 0) != 400 ||
+			uint128_column_range(&test20_column, uint128_create(7, 300), uint128_create(7, 1500), test20_indices,
+								 200) != 400 || test20_indices[199] != 299 ||
+			uint128_column_range(&test20_column, uint128_create(7, 1), uint128_create(7, 3), NULL, 0) != 0 ||
+			uint128_column_range(&test20_column, uint128_create(8, 0), uint128_create(7, 0), NULL, 0) != 0 ||
+			uint128_column_range(&test20_column, uint128_value(0), uint128_create(8, 0), NULL, 0) !=
+			COLUMN_TEST_SIZE) {
+			printf(
+				"!ERROR! Problem with uint128_column_range:\n"
+				"\tThe range had %zu values instead of 400\n",
+				test20_found);
+			exit(-1);
+		}
+		uint128_column_close(&test20_column);
+
+		// files which aren't columns aren't opened
+		FILE * const test20_file = fopen(COLUMN_TEST_PATH, "wb");
+		fwrite(test20_values, sizeof(uint128_t), COLUMN_TEST_SIZE, test20_file);
+		fclose(test20_file);
+		if (uint128_column_open(COLUMN_TEST_PATH, &test20_column) != UINT128_COLUMN_INVALID) {
+			puts("!ERROR! Problem with uint128_column_open:\n\tAn invalid file was opened");
+			exit(-1);
+		}
+	}
+	remove(COLUMN_TEST_PATH);
+	#undef COLUMN_TEST_PATH
+	#undef COLUMN_TEST_SIZE
+
+	puts("[\\20] Test block has been passed!");
 
 	return 0;
 }
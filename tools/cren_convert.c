@@ -0,0 +1,88 @@
+// Text to binary converter for 128-bit uints
+// Copyright (C) 2020, Artem Mikheev <c@renbou.ru>.
+// Licensed under the Apache License, Version 2.0.
+
+/***** cren_convert.c *****
+ * Converts a text file with one 128-bit uint per line into a binary file of them, 16 bytes per value
+ * in little-endian, using uint128_convert_file. The lines which can't be parsed are written as 0, the number
+ * of them and the first one are printed to stderr, for the whole file and for every chunk converted by a thread.
+ *
+ * Usage: cren_convert [-b base] [-t threads] input output
+ * -b base - the base of the numbers from 2 to 36, by default it is determined from the prefix of every number
+ * -t threads - the number of threads, by default the number of online processors
+ * Exits with 0 if all of the lines have been converted, 1 if some of them couldn't be parsed, and 2 on errors.
+ **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "integers/uint128_convert.h"
+
+static const char * const parse_status_names[] = {
+	[UINT128_PARSE_OK] = "ok",
+	[UINT128_PARSE_EMPTY] = "empty line",
+	[UINT128_PARSE_INVALID_DIGIT] = "invalid digit",
+	[UINT128_PARSE_OVERFLOW] = "overflow",
+	[UINT128_PARSE_INVALID_BASE] = "invalid base"
+};
+
+static int usage(const char * const program) {
+	fprintf(stderr, "Usage: %s [-b base] [-t threads] input output\n", program);
+	return 2;
+}
+
+int main(int argc, char **argv) {
+	int base = 0;
+	long online = sysconf(_SC_NPROCESSORS_ONLN);
+	unsigned threads = online > 0 ? (unsigned)online : 1;
+
+	int argument = 1;
+	for (; argument + 1 < argc && argv[argument][0] == '-'; argument += 2) {
+		char *end;
+		const unsigned long value = strtoul(argv[argument + 1], &end, 10);
+		if (*end != '\0')
+			return usage(argv[0]);
+		if (strcmp(argv[argument], "-b") == 0 && value >= 2 && value <= 36)
+			base = (int)value;
+		else if (strcmp(argv[argument], "-t") == 0 && value >= 1)
+			threads = value > 64 ? 64 : (unsigned)value;
+		else
+			return usage(argv[0]);
+	}
+	if (argc - argument != 2)
+		return usage(argv[0]);
+
+	uint128_convert_result result;
+	uint128_convert_chunk chunks[UINT128_CONVERT_MAX_CHUNKS];
+	switch (uint128_convert_file(argv[argument], argv[argument + 1], base, threads, &result, chunks)) {
+		case UINT128_CONVERT_FILE_OK:
+			break;
+		case UINT128_CONVERT_FILE_INPUT_ERROR:
+			fprintf(stderr, "%s: %s\n", argv[argument], strerror(errno));
+			return 2;
+		case UINT128_CONVERT_FILE_OUTPUT_ERROR:
+			fprintf(stderr, "%s: %s\n", argv[argument + 1], strerror(errno));
+			return 2;
+		default:
+			fprintf(stderr, "Files can't be mapped into memory on this platform\n");
+			return 2;
+	}
+
+	fprintf(stderr, "%zu values converted", result.values);
+	if (result.errors != 0) {
+		fprintf(stderr, ", %zu lines couldn't be parsed, the first one is line %zu (%s)\n", result.errors,
+				result.first_error_line + 1, parse_status_names[result.first_error_status]);
+		for (unsigned i = 0; i < result.chunks; i++) {
+			if (chunks[i].errors != 0) {
+				fprintf(stderr, "lines %zu-%zu: %zu lines couldn't be parsed, the first one is line %zu (%s)\n",
+						chunks[i].first_line + 1, chunks[i].first_line + chunks[i].lines, chunks[i].errors,
+						chunks[i].first_error_line + 1, parse_status_names[chunks[i].first_error_status]);
+			}
+		}
+		return 1;
+	}
+	fprintf(stderr, "\n");
+	return 0;
+}